@@ -50,6 +50,11 @@ function core.run_callbacks(callbacks, mode, ...)
 	return ret
 end
 
+if core.set_run_callbacks then
+	core.set_run_callbacks(core.run_callbacks)
+	core.set_run_callbacks = nil
+end
+
 function builtin_shared.make_registration()
 	local t = {}
 	local registerfunc = function(func)
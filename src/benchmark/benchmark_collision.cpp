@@ -0,0 +1,105 @@
+// Luanti
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 Minetest Authors
+
+#include "catch.h"
+#include "collision.h"
+#include "dummygamedef.h"
+#include "dummymap.h"
+#include "environment.h"
+
+namespace {
+	class BenchEnvironment : public Environment {
+		DummyMap map;
+	public:
+		BenchEnvironment(IGameDef *gamedef, v3s16 bpmin, v3s16 bpmax)
+			: Environment(gamedef), map(gamedef, bpmin, bpmax)
+		{}
+
+		void step(f32 dtime) override {}
+
+		Map &getMap() override { return map; }
+
+		void getSelectedActiveObjects(const core::line3d<f32> &shootline_on_map,
+			std::vector<PointedThing> &objects,
+			const std::optional<Pointabilities> &pointabilities) override {}
+	};
+}
+
+TEST_CASE("benchmark_collision")
+{
+	DummyGameDef gamedef;
+	NodeDefManager *ndef = gamedef.getWritableNodeDefManager();
+
+	content_t content_stone;
+	{
+		ContentFeatures f;
+		f.name = "stone";
+		content_stone = ndef->set(f.name, f);
+	}
+
+	content_t content_slab;
+	{
+		ContentFeatures f;
+		f.name = "slab";
+		f.drawtype = NDT_NODEBOX;
+		f.node_box.type = NODEBOX_FIXED;
+		f.node_box.fixed.emplace_back(-BS/2, -BS/2, -BS/2, BS/2, 0, BS/2);
+		content_slab = ndef->set(f.name, f);
+	}
+
+	v3s16 bpmin(-1, -1, -1), bpmax(1, 1, 1);
+	BenchEnvironment env(&gamedef, bpmin, bpmax);
+	Map &map = env.getMap();
+
+	// Stone floor with some slabs and pillars to collide with.
+	for (s16 z = -16; z < 32; z++)
+	for (s16 x = -16; x < 32; x++) {
+		for (s16 y = -16; y < 32; y++)
+			map.setNode({x, y, z}, MapNode(CONTENT_AIR));
+		map.setNode({x, 0, z}, MapNode(content_stone));
+		if ((x + z) % 5 == 0)
+			map.setNode({x, 1, z}, MapNode(content_slab));
+		if (x % 4 == 0 && z % 4 == 0) {
+			for (s16 y = 1; y < 4; y++)
+				map.setNode({x, y, z}, MapNode(content_stone));
+		}
+	}
+
+	const aabb3f player_box(-0.3f * BS, 0, -0.3f * BS, 0.3f * BS, 1.7f * BS, 0.3f * BS);
+	const aabb3f mob_box(-0.7f * BS, 0, -0.7f * BS, 0.7f * BS, 1.4f * BS, 0.7f * BS);
+
+	auto walk = [&] (const aabb3f &box, f32 dtime) {
+		v3f pos(2.5f * BS, 1.5f * BS, 2.5f * BS);
+		v3f speed(4.0f * BS, 0, 3.0f * BS);
+		const v3f accel(0, -9.81f * BS, 0);
+		for (int i = 0; i < 50; i++) {
+			collisionMoveSimple(&env, &gamedef, box, 0.6f * BS, dtime,
+					&pos, &speed, accel, nullptr, false);
+		}
+		return pos;
+	};
+
+	BENCHMARK("collisionMoveSimple_walk_player") {
+		return walk(player_box, 0.05f);
+	};
+
+	BENCHMARK("collisionMoveSimple_walk_mob") {
+		return walk(mob_box, 0.05f);
+	};
+
+	BENCHMARK("collisionMoveSimple_walk_long_dtime") {
+		return walk(player_box, 0.2f);
+	};
+
+	BENCHMARK("collisionMoveSimple_fall") {
+		v3f pos(8.5f * BS, 20.0f * BS, 9.5f * BS);
+		v3f speed;
+		const v3f accel(0, -9.81f * BS, 0);
+		for (int i = 0; i < 50; i++) {
+			collisionMoveSimple(&env, &gamedef, player_box, 0, 0.05f,
+					&pos, &speed, accel, nullptr, false);
+		}
+		return pos;
+	};
+}
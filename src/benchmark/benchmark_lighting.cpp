@@ -6,6 +6,7 @@
 #include "voxelalgorithms.h"
 #include "dummygamedef.h"
 #include "dummymap.h"
+#include "voxel.h"
 
 TEST_CASE("benchmark_lighting")
 {
@@ -68,4 +69,30 @@ TEST_CASE("benchmark_lighting")
 			voxalgo::blit_back_with_light(&map, &vm, &modified_blocks);
 		});
 	};
+
+	// Same areas as the mapgens use for a default sized chunk
+	BENCHMARK_ADVANCED("voxalgo::mapgen_lighting")(Catch::Benchmark::Chronometer meter) {
+		const v3s16 nmin(-32, -32, -32), nmax(47, 47, 47);
+		const v3s16 full_nmin = nmin - MAP_BLOCKSIZE, full_nmax = nmax + MAP_BLOCKSIZE;
+		VoxelManipulator vm;
+		vm.addArea(VoxelArea(full_nmin, full_nmax));
+		// Hilly terrain with some caves and lights in them
+		for (s16 z = full_nmin.Z; z <= full_nmax.Z; z++)
+		for (s16 y = full_nmin.Y; y <= full_nmax.Y; y++)
+		for (s16 x = full_nmin.X; x <= full_nmax.X; x++) {
+			s16 ground = (x * 7 + z * 13) % 11;
+			bool cave = (x / 4 + y / 3 + z / 5) % 4 == 0;
+			content_t c = y > ground || cave ? CONTENT_AIR : content_wall;
+			if (cave && x % 9 == 0 && y % 9 == 0 && z % 9 == 0)
+				c = content_light;
+			vm.setNode(v3s16(x, y, z), MapNode(c));
+		}
+		const u32 volume = vm.m_area.getVolume();
+		meter.measure([&] {
+			for (u32 i = 0; i < volume; i++)
+				vm.m_data[i].param1 = 0;
+			voxalgo::propagate_sunlight(&vm, ndef, VoxelArea(nmin, nmax), false, false);
+			voxalgo::spread_light(&vm, ndef, VoxelArea(full_nmin, full_nmax));
+		});
+	};
 }
@@ -0,0 +1,283 @@
+// Luanti
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 Minetest Authors
+
+#include "catch.h"
+#include "dummygamedef.h"
+#include "client/content_mapblock.h"
+#include "client/mapblock_mesh.h"
+#include "client/meshgen/collector.h"
+#include "client/node_visuals.h"
+#include "client/shader.h"
+#include "client/texturesource.h"
+#include <cmath>
+#include <map>
+#include <string>
+
+namespace {
+	// Meshes are only built, never drawn, so no textures or shaders are needed
+	class BenchTextureSource : public ITextureSource {
+	public:
+		video::ITexture *getTexture(const std::string &name, u32 *id) override
+		{
+			if (id)
+				*id = 0;
+			return nullptr;
+		}
+		u32 getTextureId(const std::string &image) override { return 0; }
+		std::string getTextureName(u32 id) override { return ""; }
+		video::ITexture *getTexture(u32 id) override { return nullptr; }
+		video::ITexture *addArrayTexture(const std::vector<std::string> &images,
+			u32 *id) override
+		{
+			return getTexture("", id);
+		}
+		bool needFilterForMesh() const override { return false; }
+		Palette *getPalette(const std::string &image) override { return nullptr; }
+		bool isKnownSourceImage(const std::string &name) override { return false; }
+		core::dimension2du getTextureDimensions(const std::string &image) override { return {}; }
+		video::SColor getTextureAverageColor(const std::string &image) override { return {}; }
+	};
+
+	class BenchShaderSource : public IShaderSource {
+	public:
+		BenchShaderSource() { m_info.material = video::EMT_SOLID; }
+
+		const ShaderInfo &getShaderInfo(u32 id) override { return m_info; }
+		u32 getShader(const std::string &name, const ShaderConstants &input_const,
+			video::E_MATERIAL_TYPE base_mat, IShaderUniformSetterRC *setter_cb) override
+		{
+			return 0;
+		}
+		bool supportsSampler2DArray() const override { return false; }
+
+	private:
+		ShaderInfo m_info;
+	};
+
+	struct BenchNodes {
+		content_t stone, dirt, grass_block, tree, leaves, grass, water, slab;
+	};
+
+	class BenchGameDef : public DummyGameDef {
+	public:
+		BenchNodes registerNodes()
+		{
+			BenchNodes c;
+			c.stone = addNode("stone", NDT_NORMAL, 1, 1);
+			c.dirt = addNode("dirt", NDT_NORMAL, 2, 2);
+			c.grass_block = addNode("dirt_with_grass", NDT_NORMAL, 3, 4);
+			c.tree = addNode("tree", NDT_NORMAL, 5, 6);
+			c.leaves = addNode("leaves", NDT_ALLFACES, 7, 7);
+			c.grass = addNode("grass", NDT_PLANTLIKE, 8, 8);
+			c.water = addNode("water_source", NDT_LIQUID, 9, 9);
+			c.slab = addNode("slab", NDT_NODEBOX, 10, 10);
+
+			NodeDefManager *ndef = getWritableNodeDefManager();
+			ndef->resolveCrossrefs();
+
+			// The visuals must point to the features owned by the manager
+			ndef->applyFunction([this] (ContentFeatures &f) {
+				if (f.visuals)
+					return;
+				f.visuals = constructNodeVisuals(&f);
+				auto it = m_textures.find(f.name);
+				if (it == m_textures.end())
+					return;
+				for (int i = 0; i < 6; i++)
+					f.visuals->tiles[i].layers[0].texture_id = i == 0 ? it->second.first : it->second.second;
+				switch (f.drawtype) {
+				case NDT_NORMAL:
+					f.visuals->solidness = 2;
+					break;
+				case NDT_LIQUID:
+					f.visuals->solidness = 1;
+					for (TileSpec &tile : f.visuals->tiles)
+						tile.layers[0].material_type = TILE_MATERIAL_LIQUID_TRANSPARENT;
+					break;
+				case NDT_ALLFACES:
+					f.visuals->solidness = 0;
+					f.visuals->visual_solidness = 1;
+					break;
+				default:
+					f.visuals->solidness = 0;
+					break;
+				}
+			});
+			return c;
+		}
+
+	private:
+		content_t addNode(const std::string &name, NodeDrawType drawtype,
+			u32 texture_top, u32 texture_side)
+		{
+			ContentFeatures f;
+			f.name = name;
+			f.drawtype = drawtype;
+			if (drawtype != NDT_NORMAL) {
+				f.param_type = CPT_LIGHT;
+				f.light_propagates = true;
+			}
+			switch (drawtype) {
+			case NDT_NORMAL:
+				f.alpha = ALPHAMODE_OPAQUE;
+				break;
+			case NDT_LIQUID:
+				f.alpha = ALPHAMODE_BLEND;
+				f.walkable = false;
+				f.liquid_type = LIQUID_SOURCE;
+				f.liquid_alternative_source = name;
+				f.liquid_alternative_flowing = name;
+				break;
+			case NDT_PLANTLIKE:
+				f.sunlight_propagates = true;
+				f.walkable = false;
+				break;
+			case NDT_NODEBOX:
+				f.node_box.type = NODEBOX_FIXED;
+				f.node_box.fixed.emplace_back(-BS / 2, -BS / 2, -BS / 2, BS / 2, 0, BS / 2);
+				break;
+			default:
+				break;
+			}
+			m_textures[name] = {texture_top, texture_side};
+			return getWritableNodeDefManager()->set(name, f);
+		}
+
+		std::map<std::string, std::pair<u32, u32>> m_textures;
+	};
+
+	// Lit by the sun during the day, dark at night
+	constexpr u8 LIGHT_OUTSIDE = LIGHT_SUN;
+
+	using BlockFill = std::function<MapNode(v3s16)>;
+
+	void fill_block(MeshMakeData &data, const BlockFill &fill)
+	{
+		const v3s16 pmin(-1, -1, -1), pmax(MAP_BLOCKSIZE, MAP_BLOCKSIZE, MAP_BLOCKSIZE);
+		data.m_vmanip.clear();
+		data.m_vmanip.addArea(VoxelArea(pmin, pmax));
+		for (s16 z = pmin.Z; z <= pmax.Z; z++)
+		for (s16 y = pmin.Y; y <= pmax.Y; y++)
+		for (s16 x = pmin.X; x <= pmax.X; x++)
+			data.m_vmanip.setNode(v3s16(x, y, z), fill(v3s16(x, y, z)));
+	}
+
+	s16 terrain_height(s16 x, s16 z)
+	{
+		return 7 + std::lround(3 * std::sin(x * 0.4f) + 2 * std::cos(z * 0.3f));
+	}
+}
+
+TEST_CASE("benchmark_mapblock_mesh")
+{
+	BenchGameDef gamedef;
+	const BenchNodes c = gamedef.registerNodes();
+	const NodeDefManager *ndef = gamedef.getNodeDefManager();
+	BenchTextureSource tsrc;
+	BenchShaderSource ssrc;
+
+	const MapNode air(CONTENT_AIR, LIGHT_OUTSIDE, 0);
+
+	// Hills of dirt with grass on stone
+	BlockFill terrain = [&] (v3s16 p) {
+		s16 h = terrain_height(p.X, p.Z);
+		if (p.Y > h)
+			return air;
+		if (p.Y == h)
+			return MapNode(c.grass_block);
+		return MapNode(p.Y >= h - 3 ? c.dirt : c.stone);
+	};
+
+	// The same, with grass and a tree
+	BlockFill foliage = [&] (v3s16 p) {
+		s16 h = terrain_height(p.X, p.Z);
+		v3s16 d = p - v3s16(8, terrain_height(8, 8) + 5, 8);
+		if (p.X == 8 && p.Z == 8 && p.Y > h && d.Y < 0)
+			return MapNode(c.tree);
+		if (p.Y > h && d.X * d.X + d.Y * d.Y + d.Z * d.Z <= 9)
+			return MapNode(c.leaves, LIGHT_OUTSIDE, 0);
+		if (p.Y == h + 1 && (p.X * 7 + p.Z * 3) % 4 == 0)
+			return MapNode(c.grass, LIGHT_OUTSIDE, 0);
+		return terrain(p);
+	};
+
+	// Sea floor under water
+	BlockFill water = [&] (v3s16 p) {
+		if (p.Y <= 2 + (p.X + p.Z) % 3)
+			return MapNode(c.dirt);
+		if (p.Y <= 12)
+			return MapNode(c.water, LIGHT_OUTSIDE, 0);
+		return air;
+	};
+
+	// A building made of slabs and pillars
+	BlockFill build = [&] (v3s16 p) {
+		if (p.Y <= 0)
+			return MapNode(c.stone);
+		if (p.X % 5 == 0 && p.Z % 5 == 0 && p.Y < 10)
+			return MapNode(c.tree);
+		if ((p.Y == 4 || p.Y == 9) || (p.Y < 4 && (p.X + p.Z + p.Y) % 3 == 0))
+			return MapNode(c.slab, LIGHT_OUTSIDE, 0);
+		return air;
+	};
+
+	// Stone with dark caves
+	BlockFill caves = [&] (v3s16 p) {
+		v3s16 d1 = p - v3s16(4, 5, 6), d2 = p - v3s16(12, 10, 9);
+		if (d1.X * d1.X + d1.Y * d1.Y + d1.Z * d1.Z < 16 ||
+				d2.X * d2.X + d2.Y * d2.Y / 4 + d2.Z * d2.Z < 20)
+			return MapNode(CONTENT_AIR);
+		return MapNode(c.stone);
+	};
+
+	const std::pair<const char *, const BlockFill &> blocks[] = {
+		{"terrain", terrain}, {"foliage", foliage}, {"water", water},
+		{"build", build}, {"caves", caves},
+	};
+
+	// Full detail, with merged faces and as distant meshes
+	const struct {
+		const char *suffix;
+		bool merge_faces;
+		u8 lod;
+	} variants[] = {
+		{"", false, 1}, {"_merged", true, 1}, {"_lod2", false, 2}, {"_lod4", false, 4},
+	};
+
+	for (const auto &[name, fill] : blocks)
+	for (const auto &variant : variants) {
+		MeshMakeData data(ndef, MAP_BLOCKSIZE, MeshGrid{1});
+		data.m_blockpos = v3s16(0, 0, 0);
+		data.m_smooth_lighting = true;
+		data.m_merge_faces = variant.merge_faces;
+		data.m_lod = variant.lod;
+		fill_block(data, fill);
+
+		// What ends up on the GPU
+		MeshCollector collector{{}};
+		MapblockMeshGenerator(&data, &collector).generate();
+		size_t buffers = 0, vertices = 0, triangles = 0;
+		for (auto &prebuffers : collector.prebuffers) {
+			for (auto &p : prebuffers) {
+				buffers++;
+				vertices += p.vertices.size();
+				triangles += p.indices.size() / 3;
+			}
+		}
+		// Distant meshes may leave out everything, e.g. thin floors
+		if (variant.lod == 1)
+			CHECK(triangles > 0);
+
+		// The size of the result is part of the name, so that it can be
+		// compared along with the timings
+		const std::string bench_name = std::string("MapBlockMesh_") + name + variant.suffix +
+			" (" + std::to_string(buffers) + " buffers, " + std::to_string(vertices) +
+			" vertices, " + std::to_string(triangles) + " triangles)";
+
+		BENCHMARK(bench_name.c_str()) {
+			MapBlockMesh mesh(&tsrc, &ssrc, &data);
+			return mesh.getBoundingRadius();
+		};
+	}
+}
@@ -0,0 +1,239 @@
+// Luanti
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 Minetest Authors
+
+#include "catch.h"
+#include "dummymap.h"
+#include "emerge.h"
+#include "map_settings_manager.h"
+#include "mapgen/mapgen.h"
+#include "mapgen/mg_biome.h"
+#include "mapgen/mg_decoration.h"
+#include "mapgen/mg_ore.h"
+#include "nodedef.h"
+#include "profiler.h"
+#include "server.h"
+#include "irrlicht_changes/printing.h"
+#include "util/metricsbackend.h"
+#include "util/string.h"
+#include "util/numeric.h"
+#include <memory>
+#include <sstream>
+
+namespace {
+	struct BenchNodes {
+		content_t stone, water, river_water, dirt, dirt_with_grass, sand, coal, grass;
+	};
+
+	content_t add_solid(NodeDefManager *ndef, const std::string &name)
+	{
+		ContentFeatures f;
+		f.name = name;
+		f.is_ground_content = true;
+		return ndef->set(f.name, f);
+	}
+
+	content_t add_liquid(NodeDefManager *ndef, const std::string &name, u8 light_source = 0)
+	{
+		ContentFeatures f;
+		f.name = name;
+		f.drawtype = NDT_LIQUID;
+		f.param_type = CPT_LIGHT;
+		f.light_propagates = true;
+		f.light_source = light_source;
+		f.walkable = false;
+		f.buildable_to = true;
+		f.liquid_type = LIQUID_SOURCE;
+		return ndef->set(f.name, f);
+	}
+
+	// Roughly what a small game registers for the mapgen
+	BenchNodes register_nodes(NodeDefManager *ndef)
+	{
+		BenchNodes c;
+		c.stone = add_solid(ndef, "mapgen_stone");
+		c.water = add_liquid(ndef, "mapgen_water_source");
+		c.river_water = add_liquid(ndef, "mapgen_river_water_source");
+		add_liquid(ndef, "mapgen_lava_source", LIGHT_MAX);
+		add_solid(ndef, "mapgen_cobble");
+		c.dirt = add_solid(ndef, "dirt");
+		c.dirt_with_grass = add_solid(ndef, "dirt_with_grass");
+		c.sand = add_solid(ndef, "sand");
+		c.coal = add_solid(ndef, "stone_with_coal");
+		{
+			ContentFeatures f;
+			f.name = "grass";
+			f.drawtype = NDT_PLANTLIKE;
+			f.param_type = CPT_LIGHT;
+			f.light_propagates = true;
+			f.sunlight_propagates = true;
+			f.walkable = false;
+			f.buildable_to = true;
+			c.grass = ndef->set(f.name, f);
+		}
+		ndef->setNodeRegistrationStatus(true);
+		return c;
+	}
+
+	void register_objects(EmergeManager *emerge, const BenchNodes &c)
+	{
+		BiomeManager *bmgr = emerge->getWritableBiomeManager();
+		auto add_biome = [&] (const char *name, content_t top, float heat,
+				float humidity, s16 y_min) {
+			Biome *b = BiomeManager::create(BIOMETYPE_NORMAL);
+			b->name = name;
+			b->c_top = top;
+			b->depth_top = 1;
+			b->c_filler = c.dirt;
+			b->depth_filler = 3;
+			b->c_stone = c.stone;
+			b->c_water_top = c.water;
+			b->c_water = c.water;
+			b->c_river_water = c.river_water;
+			b->c_riverbed = c.sand;
+			b->depth_riverbed = 2;
+			b->min_pos.Y = y_min;
+			b->heat_point = heat;
+			b->humidity_point = humidity;
+			bmgr->add(b);
+			return (biome_t)b->index;
+		};
+		const biome_t grassland = add_biome("grassland", c.dirt_with_grass, 50, 35, 4);
+		add_biome("grassland_dunes", c.sand, 50, 35, 1);
+		add_biome("grassland_ocean", c.sand, 50, 35, -255);
+		add_biome("desert", c.sand, 92, 16, -255);
+		add_biome("tundra", c.dirt, 0, 40, -255);
+
+		OreManager *oremgr = emerge->getWritableOreManager();
+		Ore *ore = OreManager::create(ORE_SCATTER);
+		ore->name = "coal";
+		ore->c_ore = c.coal;
+		ore->c_wherein.push_back(c.stone);
+		ore->clust_scarcity = 8 * 8 * 8;
+		ore->clust_num_ores = 9;
+		ore->clust_size = 3;
+		ore->y_min = -MAX_MAP_GENERATION_LIMIT;
+		ore->y_max = MAX_MAP_GENERATION_LIMIT;
+		ore->ore_param2 = 0;
+		oremgr->add(ore);
+
+		DecorationManager *decomgr = emerge->getWritableDecorationManager();
+		auto *deco = static_cast<DecoSimple *>(DecorationManager::create(DECO_SIMPLE));
+		deco->name = "grass";
+		deco->c_place_on.push_back(c.dirt_with_grass);
+		deco->c_decos.push_back(c.grass);
+		deco->sidelen = 16;
+		deco->fill_ratio = 0.1f;
+		deco->y_min = 1;
+		deco->y_max = MAX_MAP_GENERATION_LIMIT;
+		deco->nspawnby = -1;
+		deco->deco_height = 1;
+		deco->deco_height_max = 0;
+		deco->deco_param2 = 0;
+		deco->deco_param2_max = 0;
+		deco->biomes.insert(grassland);
+		decomgr->add(deco);
+	}
+
+	// Generates the chunk at bpmin into a fresh voxel manipulator, like
+	// ServerMap::initBlockMake does for new parts of the map.
+	u64 generate_chunk(Mapgen *mg, Map *map, const NodeDefManager *ndef,
+		u64 seed, v3s16 bpmin, v3s16 csize)
+	{
+		BlockMakeData data;
+		data.seed = seed;
+		data.blockpos_min = bpmin;
+		data.blockpos_max = bpmin + csize - 1;
+		data.nodedef = ndef;
+		data.vmanip = new MMVManip(map);
+		data.vmanip->initialEmerge(data.blockpos_min - 1, data.blockpos_max + 1, false);
+
+		mg->makeChunk(&data);
+
+		const MMVManip *vm = data.vmanip;
+		return murmur_hash_64_ua(vm->m_data, vm->m_area.getVolume() * sizeof(MapNode), 0);
+	}
+}
+
+TEST_CASE("benchmark_mapgen")
+{
+	Server server("fakepath", SubgameSpec("fakespec", "fakespec"), true,
+		Address(), true, nullptr);
+	const NodeDefManager *ndef = server.getNodeDefManager();
+	const BenchNodes nodes = register_nodes(server.getWritableNodeDefManager());
+
+	// Nothing is loaded from the map, all chunks are generated from scratch
+	DummyMap map(&server, v3s16(0), v3s16(-1));
+
+	// Surface, underground and mountains, as seen when exploring.
+	// In units of chunks.
+	const v3s16 chunks[] = {
+		v3s16(-2, -2, -2), v3s16(3, -2, -2), v3s16(-2, -2, 3), v3s16(8, -2, 8),
+		v3s16(-2, -7, -2), v3s16(3, -7, 3), v3s16(-2, 3, -2), v3s16(13, 3, -7),
+	};
+
+	const MapgenType mgtypes[] = {
+		MAPGEN_V5, MAPGEN_V7, MAPGEN_VALLEYS, MAPGEN_CARPATHIAN, MAPGEN_FRACTAL, MAPGEN_FLAT,
+	};
+
+	for (MapgenType mgtype : mgtypes) {
+		const std::string mgname = Mapgen::getMapgenName(mgtype);
+
+		MapSettingsManager settings("");
+		settings.setMapSetting("mg_name", mgname);
+		settings.setMapSetting("seed", "7355608");
+		std::unique_ptr<MapgenParams> params(settings.makeMapgenParamsCopy());
+		const v3s16 csize = params->chunksize;
+		auto chunk_pos = [&] (v3s16 chunk) {
+			return EmergeManager::getContainingChunk(chunk * csize, csize);
+		};
+
+		MetricsBackend metrics;
+		EmergeManager emerge(&server, &metrics);
+		register_objects(&emerge, nodes);
+		emerge.initMapgens(params.get());
+
+		// Generating the same chunks again must give the same result.
+		// The hashes are reported, so that changes that should not affect
+		// the generated map can be checked against the previous ones.
+		std::vector<u64> hashes;
+		{
+			std::unique_ptr<Mapgen> mg(emerge.createMapgen());
+			for (v3s16 chunk : chunks)
+				hashes.push_back(generate_chunk(mg.get(), &map, ndef, params->seed, chunk_pos(chunk), csize));
+		}
+		{
+			std::unique_ptr<Mapgen> mg(emerge.createMapgen());
+			for (size_t i = 0; i < ARRLEN(chunks); i++) {
+				u64 hash = generate_chunk(mg.get(), &map, ndef, params->seed, chunk_pos(chunks[i]), csize);
+				CHECK(hash == hashes[i]);
+			}
+		}
+
+		std::unique_ptr<Mapgen> mg(emerge.createMapgen());
+
+		// Time spent in the individual stages, per chunk
+		g_profiler->clear();
+		for (v3s16 chunk : chunks)
+			generate_chunk(mg.get(), &map, ndef, params->seed, chunk_pos(chunk), csize);
+		Profiler::GraphValues values;
+		g_profiler->getPage(values, 1, 1);
+		std::ostringstream os;
+		os << "mapgen " << mgname << ", " << ARRLEN(chunks) << " chunks:";
+		for (const auto &it : values) {
+			if (!str_starts_with(it.first, "EmergeThread: "))
+				continue;
+			float total = it.second * std::max(g_profiler->getAvgCount(it.first), 1);
+			os << "\n  " << it.first << ": " << total / ARRLEN(chunks);
+		}
+		for (size_t i = 0; i < ARRLEN(chunks); i++)
+			os << "\n  hash of chunk " << chunks[i] << ": " << std::hex << hashes[i] << std::dec;
+		WARN(os.str());
+
+		u32 i = 0;
+		BENCHMARK("makeChunk_" + mgname) {
+			v3s16 chunk = chunks[i++ % ARRLEN(chunks)];
+			return generate_chunk(mg.get(), &map, ndef, params->seed, chunk_pos(chunk), csize);
+		};
+	}
+}
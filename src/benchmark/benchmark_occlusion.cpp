@@ -0,0 +1,148 @@
+// Luanti
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 Minetest Authors
+
+#include "catch.h"
+#include "dummygamedef.h"
+#include "dummymap.h"
+#include "nodedef.h"
+#include <cmath>
+#include <string>
+
+namespace {
+	class BenchMap : public DummyMap {
+	public:
+		using DummyMap::DummyMap;
+		using Map::isOccluded;
+
+		// Map::isOccluded as it was before it kept the block of the
+		// previous step, with a lookup of every node through getNode
+		bool isOccludedReference(v3s16 pos_camera, v3s16 pos_target,
+			float step, float stepfac, float offset, float end_offset, u32 needed_count)
+		{
+			v3f direction = intToFloat(pos_target - pos_camera, BS);
+			float distance = direction.getLength();
+			if (distance > 0.0f)
+				direction /= distance;
+
+			v3f pos_origin_f = intToFloat(pos_camera, BS);
+			u32 count = 0;
+			bool is_valid_position;
+			for (; offset < distance + end_offset; offset += step) {
+				v3s16 pos_node = floatToInt(pos_origin_f + direction * offset, BS);
+				MapNode node = getNode(pos_node, &is_valid_position);
+				if (is_valid_position &&
+						!m_nodedef->getLightingFlags(node).light_propagates) {
+					count++;
+					if (count >= needed_count)
+						return true;
+				}
+				step *= stepfac;
+			}
+			return false;
+		}
+	};
+
+	// Checks every block in range from every point of the path, like the
+	// client does when it updates its draw list.
+	u32 cull_along_path(Map &map, const std::vector<v3s16> &path, s16 range)
+	{
+		u32 occluded = 0;
+		for (v3s16 cam_pos_nodes : path) {
+			const v3s16 cam_block = getNodeBlockPos(cam_pos_nodes);
+			for (s16 z = -range; z <= range; z++)
+			for (s16 y = -range; y <= range; y++)
+			for (s16 x = -range; x <= range; x++) {
+				MapBlock *block = map.getBlockNoCreateNoEx(cam_block + v3s16(x, y, z));
+				if (block && map.isBlockOccluded(block, cam_pos_nodes))
+					occluded++;
+			}
+		}
+		return occluded;
+	}
+}
+
+TEST_CASE("benchmark_occlusion")
+{
+	DummyGameDef gamedef;
+	NodeDefManager *ndef = gamedef.getWritableNodeDefManager();
+	content_t c_stone;
+	{
+		ContentFeatures f;
+		f.name = "stone";
+		c_stone = ndef->set(f.name, f);
+	}
+	ndef->setNodeRegistrationStatus(true);
+
+	// Hilly terrain with a tunnel through it
+	const v3s16 bpmin(-10, -4, -10), bpmax(9, 3, 9);
+	BenchMap map(&gamedef, bpmin, bpmax);
+	for (s16 bz = bpmin.Z; bz <= bpmax.Z; bz++)
+	for (s16 by = bpmin.Y; by <= bpmax.Y; by++)
+	for (s16 bx = bpmin.X; bx <= bpmax.X; bx++) {
+		MapBlock *block = map.getBlockNoCreateNoEx(v3s16(bx, by, bz));
+		const v3s16 base = block->getPosRelative();
+		for (s16 z = 0; z < MAP_BLOCKSIZE; z++)
+		for (s16 x = 0; x < MAP_BLOCKSIZE; x++) {
+			const v3s16 p = base + v3s16(x, 0, z);
+			const s16 h = std::lround(12 * std::sin(p.X * 0.05f) + 8 * std::cos(p.Z * 0.07f));
+			for (s16 y = 0; y < MAP_BLOCKSIZE; y++) {
+				const s16 py = p.Y + y;
+				bool tunnel = std::abs(p.Z) <= 2 && py >= -20 && py <= -17;
+				block->setNodeNoCheck(x, y, z, MapNode(py <= h && !tunnel ? c_stone : CONTENT_AIR));
+			}
+		}
+		block->expireIsAirCache();
+	}
+
+	// Flying over the hills, walking on them and going through the tunnel
+	std::vector<v3s16> flying, walking, tunnel;
+	for (s16 x = -64; x < 64; x += 8) {
+		flying.emplace_back(x, 40, x / 2);
+		const s16 h = std::lround(12 * std::sin(x * 0.05f) + 8 * std::cos(20 * 0.07f));
+		walking.emplace_back(x, h + 2, 20);
+		tunnel.emplace_back(x, -19, 0);
+	}
+
+	const std::pair<const char *, const std::vector<v3s16> &> paths[] = {
+		{"flying", flying}, {"walking", walking}, {"tunnel", tunnel},
+	};
+
+	// As used by the client for the rays on other threads
+	const SectorSnapshot snapshot = map.getSectorSnapshot(
+		v2s16(bpmin.X, bpmin.Z), v2s16(bpmax.X, bpmax.Z));
+
+	for (const auto &[name, path] : paths) {
+		// Every ray must give the same result as looking up each node,
+		// with the parameters used by Map::isBlockOccluded
+		u32 rays = 0, mismatches = 0;
+		for (v3s16 cam_pos_nodes : path) {
+			const v3s16 cam_block = getNodeBlockPos(cam_pos_nodes);
+			for (s16 z = -6; z <= 6; z++)
+			for (s16 y = -6; y <= 6; y++)
+			for (s16 x = -6; x <= 6; x++) {
+				const v3s16 target = (cam_block + v3s16(x, y, z)) * MAP_BLOCKSIZE +
+					v3s16(MAP_BLOCKSIZE / 2 + 1);
+				const float end_offset = -BS * MAP_BLOCKSIZE * 1.732f;
+				bool occluded = map.isOccluded(cam_pos_nodes, target,
+					BS * 1.2f, 1.05f, BS, end_offset, 2);
+				bool expected = map.isOccludedReference(cam_pos_nodes, target,
+					BS * 1.2f, 1.05f, BS, end_offset, 2);
+				bool occluded_snapshot = map.isOccluded(cam_pos_nodes, target,
+					BS * 1.2f, 1.05f, BS, end_offset, 2, &snapshot);
+				rays++;
+				if (occluded != expected || occluded_snapshot != expected)
+					mismatches++;
+			}
+		}
+		INFO("occlusion " << name << ": " << rays << " rays");
+		CHECK(mismatches == 0);
+
+		const u32 occluded = cull_along_path(map, path, 6);
+
+		BENCHMARK("isBlockOccluded_" + std::string(name) + " (" +
+				std::to_string(occluded) + " blocks occluded)") {
+			return cull_along_path(map, path, 6);
+		};
+	}
+}
@@ -0,0 +1,142 @@
+// Luanti
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 Minetest Authors
+
+#include "catch.h"
+#include "dummygamedef.h"
+#include "dummymap.h"
+#include "environment.h"
+#include "client/particles.h"
+#include "util/numeric.h"
+#include <memory>
+#include <string>
+
+namespace {
+	class BenchEnvironment : public Environment {
+		DummyMap map;
+	public:
+		BenchEnvironment(IGameDef *gamedef, v3s16 bpmin, v3s16 bpmax)
+			: Environment(gamedef), map(gamedef, bpmin, bpmax)
+		{}
+
+		void step(f32 dtime) override {}
+
+		Map &getMap() override { return map; }
+
+		void getSelectedActiveObjects(const core::line3d<f32> &shootline_on_map,
+			std::vector<PointedThing> &objects,
+			const std::optional<Pointabilities> &pointabilities) override {}
+	};
+
+	// Particles are only stepped, never drawn, so the buffer is not
+	// part of any scene
+	struct BenchParticles {
+		irr_ptr<ParticleBuffer> buffer = make_irr<ParticleBuffer>(nullptr, nullptr,
+			video::SMaterial());
+		std::vector<std::unique_ptr<Particle>> particles;
+
+		void add(const ParticleParameters &p)
+		{
+			auto particle = std::make_unique<Particle>(p, ClientParticleTexRef(),
+				v2f(0, 0), v2f(1, 1), video::SColor(0xFFFFFFFF));
+			REQUIRE(particle->attachToBuffer(buffer.get()));
+			particles.push_back(std::move(particle));
+		}
+
+		// Like one client step with the camera at the given position
+		void step(Environment *env, v3f player_pos, float dtime)
+		{
+			ParticleStepContext ctx(env, player_pos, -20, 135, v3s16(0, 0, 0));
+			for (auto &particle : particles)
+				particle->step(dtime, ctx);
+		}
+	};
+}
+
+TEST_CASE("benchmark_particles")
+{
+	DummyGameDef gamedef;
+	NodeDefManager *ndef = gamedef.getWritableNodeDefManager();
+	content_t c_stone;
+	{
+		ContentFeatures f;
+		f.name = "stone";
+		c_stone = ndef->set(f.name, f);
+	}
+
+	// Sunlit stone floor at y = -1
+	const v3s16 bpmin(-2, -2, -2), bpmax(1, 1, 1);
+	BenchEnvironment env(&gamedef, bpmin, bpmax);
+	DummyMap &map = static_cast<DummyMap &>(env.getMap());
+	map.fill(bpmin, bpmax, MapNode(CONTENT_AIR, LIGHT_SUN, 0));
+	for (s16 z = -32; z < 32; z++)
+	for (s16 x = -32; x < 32; x++)
+		map.setNode({x, -1, z}, MapNode(c_stone));
+
+	const v3f player_pos(0.5f, 0, 0.5f);
+
+	// Rain around the player, as mods spawn it
+	BenchParticles rain;
+	for (int i = 0; i < 10000; i++) {
+		ParticleParameters p;
+		p.pos = v3f(myrand_range(-24.f, 24.f), myrand_range(0.f, 30.f), myrand_range(-24.f, 24.f));
+		p.vel = v3f(0, -10, 0);
+		p.size = 2;
+		p.expirationtime = 1000;
+		p.vertical = true;
+		rain.add(p);
+	}
+
+	// An explosion next to the player
+	BenchParticles explosion;
+	for (int i = 0; i < 2000; i++) {
+		ParticleParameters p;
+		p.pos = v3f(5, 1, 5);
+		p.vel = v3f(myrand_range(-5.f, 5.f), myrand_range(0.f, 8.f), myrand_range(-5.f, 5.f));
+		p.acc = v3f(0, -9.81f, 0);
+		p.drag = v3f(0.5f, 0.5f, 0.5f);
+		p.size = myrand_range(1.f, 4.f);
+		p.expirationtime = 1000;
+		explosion.add(p);
+	}
+
+	// Dust that collides with the floor
+	BenchParticles dust;
+	for (int i = 0; i < 1000; i++) {
+		ParticleParameters p;
+		p.pos = v3f(myrand_range(-8.f, 8.f), myrand_range(0.f, 3.f), myrand_range(-8.f, 8.f));
+		p.vel = v3f(myrand_range(-1.f, 1.f), 0, myrand_range(-1.f, 1.f));
+		p.acc = v3f(0, -9.81f, 0);
+		p.size = 0.5f;
+		p.expirationtime = 1000;
+		p.collisiondetection = true;
+		p.bounce = ParticleParamTypes::f32Range(0.3f);
+		dust.add(p);
+	}
+
+	// A resting particle must be drawn around its position
+	{
+		BenchParticles single;
+		ParticleParameters p;
+		p.pos = v3f(3, 2, 1);
+		single.add(p);
+		single.step(&env, player_pos, 0.05f);
+		const video::S3DVertex *vertices = single.buffer->getVertices(0);
+		v3f center;
+		for (int i = 0; i < 4; i++)
+			center += vertices[i].Pos / 4;
+		CHECK(center.getDistanceFrom(p.pos * BS) < 0.001f);
+	}
+
+	const std::pair<const char *, BenchParticles &> effects[] = {
+		{"rain", rain}, {"explosion", explosion}, {"dust", dust},
+	};
+
+	for (auto &[name, effect] : effects) {
+		BENCHMARK("Particle_step_" + std::string(name) + " (" +
+				std::to_string(effect.particles.size()) + " particles)") {
+			effect.step(&env, player_pos, 0.05f);
+			return effect.particles.size();
+		};
+	}
+}
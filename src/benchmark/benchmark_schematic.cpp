@@ -0,0 +1,86 @@
+// Luanti
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 Minetest Authors
+
+#include "catch.h"
+#include "dummygamedef.h"
+#include "dummymap.h"
+#include "mapgen/mg_schematic.h"
+#include "nodedef.h"
+
+TEST_CASE("benchmark_schematic")
+{
+	DummyGameDef gamedef;
+	NodeDefManager *ndef = gamedef.getWritableNodeDefManager();
+
+	{
+		ContentFeatures f;
+		f.name = "stone";
+		ndef->set(f.name, f);
+	}
+	{
+		ContentFeatures f;
+		f.name = "leaves";
+		ndef->set(f.name, f);
+	}
+	ndef->setNodeRegistrationStatus(true);
+
+	// A hollow 16x16x16 house with a roof of leaves, shaped like the
+	// structures mods place: walls always, air inside, some random nodes
+	// and nothing around the corners.
+	const v3s16 size(16, 16, 16);
+	const u32 volume = size.X * size.Y * size.Z;
+	Schematic schem;
+	schem.m_nodenames = {"air", "stone", "leaves"};
+	schem.m_nnlistsizes.push_back(schem.m_nodenames.size());
+	schem.size = size;
+	schem.schemdata = new MapNode[volume];
+	schem.slice_probs = new u8[size.Y];
+	for (s16 y = 0; y < size.Y; y++)
+		schem.slice_probs[y] = MTSCHEM_PROB_ALWAYS;
+	u32 i = 0;
+	for (s16 z = 0; z < size.Z; z++)
+	for (s16 y = 0; y < size.Y; y++)
+	for (s16 x = 0; x < size.X; x++, i++) {
+		bool wall = x == 0 || x == size.X - 1 || z == 0 || z == size.Z - 1 || y == 0;
+		bool corner = (x < 2 || x >= size.X - 2) && (z < 2 || z >= size.Z - 2);
+		if (corner && y > 0)
+			schem.schemdata[i] = MapNode(0, MTSCHEM_PROB_NEVER, 0);
+		else if (y >= 12)
+			schem.schemdata[i] = MapNode(2, 64, 0);
+		else if (wall)
+			schem.schemdata[i] = MapNode(1, MTSCHEM_PROB_ALWAYS, 0);
+		else
+			schem.schemdata[i] = MapNode(0, MTSCHEM_PROB_ALWAYS | MTSCHEM_FORCE_PLACE, 0);
+	}
+	ndef->pendNodeResolve(&schem);
+
+	// 4x4 schematics, some of them cut off at the edges of the area
+	const v3s16 pmin(-32, -16, -32), pmax(31, 15, 31);
+	DummyMap map(&gamedef, getNodeBlockPos(pmin), getNodeBlockPos(pmax));
+	MMVManip vm(&map);
+	vm.addArea(VoxelArea(pmin, pmax));
+	const u32 vm_volume = vm.m_area.getVolume();
+
+	auto place_all = [&] (Rotation rot, bool force_place) {
+		for (u32 vi = 0; vi < vm_volume; vi++)
+			vm.m_data[vi] = MapNode(CONTENT_AIR);
+		for (s16 z = 0; z < 4; z++)
+		for (s16 x = 0; x < 4; x++)
+			schem.blitToVManip(&vm, v3s16(x * 18 - 40, -8, z * 18 - 36), rot, force_place);
+		return vm.m_data[vm_volume / 2];
+	};
+
+	// 16 placements of 4096 nodes each
+	BENCHMARK("place_schematic_65536_nodes") {
+		return place_all(ROTATE_0, false);
+	};
+
+	BENCHMARK("place_schematic_65536_nodes_rotated") {
+		return place_all(ROTATE_90, false);
+	};
+
+	BENCHMARK("place_schematic_65536_nodes_forced") {
+		return place_all(ROTATE_0, true);
+	};
+}
@@ -0,0 +1,118 @@
+// Luanti
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 Minetest Authors
+
+#include "catch.h"
+#include "script/cpp_api/s_base.h"
+#include "script/lua_api/l_util.h"
+#include "script/lua_api/l_settings.h"
+#include "filesys.h"
+#include "server.h"
+
+namespace {
+	class BenchScriptApi : virtual public ScriptApiBase {
+	public:
+		BenchScriptApi() : ScriptApiBase(ScriptingType::Async) {};
+		void init();
+		using ScriptApiBase::getStack; // make public
+	};
+
+	void BenchScriptApi::init()
+	{
+		lua_State *L = getStack();
+
+		lua_getglobal(L, "core");
+		int top = lua_gettop(L);
+
+		lua_pushstring(L, "async");
+		lua_setglobal(L, "INIT");
+
+		LuaSettings::Register(L);
+		ModApiUtil::InitializeAsync(L, top);
+
+		lua_pop(L, 1);
+
+		loadMod(Server::getBuiltinLuaPath() + DIR_DELIM + "init.lua", BUILTIN_MOD_NAME);
+		checkSetByBuiltin();
+
+		// The async environment doesn't include core.run_callbacks
+		const std::string path = Server::getBuiltinLuaPath() + DIR_DELIM +
+			"common" + DIR_DELIM + "register.lua";
+		if (luaL_loadfile(L, path.c_str()) != 0)
+			throw LuaError(lua_tostring(L, -1));
+		lua_newtable(L); // builtin_shared
+		if (lua_pcall(L, 1, 0, 0) != 0)
+			throw LuaError(lua_tostring(L, -1));
+	}
+
+	void run(lua_State *L, const char *code)
+	{
+		if (luaL_loadstring(L, code) != 0 || lua_pcall(L, 0, 0, 0) != 0)
+			throw LuaError(lua_tostring(L, -1));
+	}
+}
+
+TEST_CASE("benchmark_scriptapi")
+{
+	BenchScriptApi script;
+	script.init();
+	lua_State *L = script.getStack();
+
+	run(L, R"(
+		bench_fn = function(a, b) return a end
+		bench_def = {mod_origin = "benchmark_mod"}
+		bench_callbacks = {}
+		for i = 1, 4 do
+			bench_callbacks[i] = function(x) end
+		end
+	)");
+
+	lua_getglobal(L, "bench_fn");
+	const int fn_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+
+	const int top = lua_gettop(L);
+	constexpr int N = 100;
+
+	BENCHMARK("call_global_by_name") {
+		for (int i = 0; i < N; i++) {
+			lua_getglobal(L, "bench_fn");
+			lua_pushinteger(L, i);
+			lua_pushinteger(L, i);
+			lua_pcall(L, 2, 1, 0);
+			lua_pop(L, 1);
+		}
+		return lua_gettop(L);
+	};
+
+	BENCHMARK("call_registry_ref") {
+		for (int i = 0; i < N; i++) {
+			lua_rawgeti(L, LUA_REGISTRYINDEX, fn_ref);
+			lua_pushinteger(L, i);
+			lua_pushinteger(L, i);
+			lua_pcall(L, 2, 1, 0);
+			lua_pop(L, 1);
+		}
+		return lua_gettop(L);
+	};
+
+	BENCHMARK("setOriginFromTable") {
+		lua_getglobal(L, "bench_def");
+		for (int i = 0; i < N; i++)
+			script.setOriginFromTableRaw(-1, "benchmark");
+		lua_pop(L, 1);
+		return lua_gettop(L);
+	};
+
+	BENCHMARK("runCallbacks") {
+		for (int i = 0; i < N; i++) {
+			lua_getglobal(L, "bench_callbacks");
+			lua_pushinteger(L, i);
+			script.runCallbacksRaw(1, RUN_CALLBACKS_MODE_FIRST, "benchmark");
+			lua_pop(L, 1);
+		}
+		return lua_gettop(L);
+	};
+
+	REQUIRE(lua_gettop(L) == top);
+	luaL_unref(L, LUA_REGISTRYINDEX, fn_ref);
+}
@@ -0,0 +1,338 @@
+// Luanti
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 Minetest Authors
+
+#include "blockcache.h"
+
+#include "exceptions.h"
+#include "filesys.h"
+#include "log.h"
+#include "porting.h"
+#include "threading/mutex_auto_lock.h"
+#include "util/numeric.h"
+#include "util/serialize.h"
+#include "util/thread.h"
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+#define INDEX_FILE "index"
+#define INDEX_VERSION 1
+
+// Blocks are removed until this part of the size limit is used, so that
+// pruning doesn't happen again on the next block
+#define PRUNE_TARGET 0.9
+
+class BlockCacheThread : public UpdateThread
+{
+public:
+	BlockCacheThread(ClientBlockCache *cache) :
+		UpdateThread("BlockCache"),
+		m_cache(cache)
+	{}
+
+protected:
+	void doUpdate() override
+	{
+		m_cache->runJobs();
+	}
+
+private:
+	ClientBlockCache *m_cache;
+};
+
+ClientBlockCache::ClientBlockCache(const std::string &dir, u64 max_size) :
+	m_dir(dir),
+	m_max_size(max_size),
+	m_files(dir)
+{
+	m_thread = std::make_unique<BlockCacheThread>(this);
+
+	if (!readIndex())
+		rebuildIndex();
+
+	// Only a cache that was closed properly has an up to date index
+	fs::DeleteSingleFileOrEmptyDirectory(m_dir + DIR_DELIM INDEX_FILE);
+
+	infostream << "ClientBlockCache: " << m_index.size() << " blocks, "
+		<< m_size << " bytes in \"" << dir << "\"" << std::endl;
+	prune();
+
+	m_thread->start();
+}
+
+ClientBlockCache::~ClientBlockCache()
+{
+	m_thread->stop();
+	m_thread->wait();
+
+	// Finish writing
+	runJobs();
+	writeIndex();
+}
+
+u64 ClientBlockCache::getHash(std::string_view data)
+{
+	return murmur_hash_64_ua(data.data(), data.size(), 0);
+}
+
+std::string ClientBlockCache::getShardName(v3s16 pos)
+{
+	const v3s16 shard = getContainerPos(pos, 16);
+	char buf[32];
+	porting::mt_snprintf(buf, sizeof(buf), "%d_%d_%d", shard.X, shard.Y, shard.Z);
+	return buf;
+}
+
+std::string ClientBlockCache::getFileName(v3s16 pos, u64 hash)
+{
+	char buf[64];
+	porting::mt_snprintf(buf, sizeof(buf), "%d_%d_%d_%016llx", pos.X, pos.Y, pos.Z,
+		(unsigned long long)hash);
+	return getShardName(pos) + DIR_DELIM + buf;
+}
+
+bool ClientBlockCache::readIndex()
+{
+	std::string data;
+	if (!fs::ReadFile(m_dir + DIR_DELIM INDEX_FILE, data))
+		return false;
+
+	std::istringstream is(data, std::ios_base::binary);
+	try {
+		if (readU8(is) != INDEX_VERSION)
+			return false;
+		m_use_counter = readU64(is);
+		m_last_pos = readV3S16(is);
+		u32 count = readU32(is);
+		m_index.reserve(count);
+		for (u32 i = 0; i < count; i++) {
+			v3s16 pos = readV3S16(is);
+			Entry entry;
+			entry.hash = readU64(is);
+			entry.size = readU32(is);
+			entry.last_used = readU64(is);
+			m_index[pos] = entry;
+			m_size += entry.size;
+		}
+	} catch (SerializationError &e) {
+		warningstream << "ClientBlockCache: damaged index in \"" << m_dir
+			<< "\": " << e.what() << std::endl;
+		m_index.clear();
+		m_size = 0;
+		return false;
+	}
+	return true;
+}
+
+void ClientBlockCache::rebuildIndex()
+{
+	m_use_counter = 0;
+	m_last_pos = v3s16(0, 0, 0);
+
+	for (const fs::DirListNode &shard : fs::GetDirListing(m_dir)) {
+		const std::string shard_path = m_dir + DIR_DELIM + shard.name;
+		if (!shard.dir) {
+			// Left over from an older layout
+			fs::DeleteSingleFileOrEmptyDirectory(shard_path);
+			continue;
+		}
+
+		for (const fs::DirListNode &node : fs::GetDirListing(shard_path)) {
+			int x, y, z;
+			unsigned long long hash;
+			char end;
+			if (node.dir || std::sscanf(node.name.c_str(), "%d_%d_%d_%llx%c",
+					&x, &y, &z, &hash, &end) != 4)
+				continue;
+			uint64_t size, mtime;
+			if (!fs::GetFileInfo(shard_path + DIR_DELIM + node.name, &size, &mtime))
+				continue;
+			// When the blocks were used is not known, so they go first
+			m_index[v3s16(x, y, z)] = Entry{(u64)hash, (u32)size, 0};
+			m_size += size;
+		}
+	}
+}
+
+void ClientBlockCache::writeIndex()
+{
+	std::ostringstream os(std::ios_base::binary);
+	writeU8(os, INDEX_VERSION);
+	writeU64(os, m_use_counter);
+	writeV3S16(os, m_last_pos);
+	writeU32(os, m_index.size());
+	for (const auto &[pos, entry] : m_index) {
+		writeV3S16(os, pos);
+		writeU64(os, entry.hash);
+		writeU32(os, entry.size);
+		writeU64(os, entry.last_used);
+	}
+
+	if (!fs::CreateAllDirs(m_dir) ||
+			!fs::safeWriteToFile(m_dir + DIR_DELIM INDEX_FILE, os.str())) {
+		errorstream << "ClientBlockCache: failed to write index in \""
+			<< m_dir << "\"" << std::endl;
+	}
+}
+
+void ClientBlockCache::remove(std::unordered_map<v3s16, Entry>::iterator it)
+{
+	queueJob(Job{Job::REMOVE, it->first, it->second.hash});
+	m_size -= it->second.size;
+	m_index.erase(it);
+}
+
+void ClientBlockCache::prune()
+{
+	if (m_size <= m_max_size)
+		return;
+
+	std::vector<std::pair<u64, v3s16>> by_use;
+	by_use.reserve(m_index.size());
+	for (const auto &[pos, entry] : m_index)
+		by_use.emplace_back(entry.last_used, pos);
+	std::sort(by_use.begin(), by_use.end(), [] (const auto &a, const auto &b) {
+		return a.first < b.first;
+	});
+
+	const size_t count = m_index.size();
+	for (const auto &it : by_use) {
+		if (m_size <= m_max_size * PRUNE_TARGET)
+			break;
+		remove(m_index.find(it.second));
+	}
+	infostream << "ClientBlockCache: removed " << (count - m_index.size())
+		<< " blocks to keep the size limit" << std::endl;
+}
+
+void ClientBlockCache::store(v3s16 pos, std::string_view data)
+{
+	// The data of the load would be older
+	m_pending_loads.erase(pos);
+
+	const u64 hash = getHash(data);
+	auto it = m_index.find(pos);
+	if (it != m_index.end()) {
+		// Blocks are sent again unchanged all the time
+		if (it->second.hash == hash) {
+			it->second.last_used = ++m_use_counter;
+			return;
+		}
+		remove(it);
+	}
+
+	m_index[pos] = Entry{hash, (u32)data.size(), ++m_use_counter};
+	m_size += data.size();
+	queueJob(Job{Job::WRITE, pos, hash, 0, std::string(data)});
+	prune();
+}
+
+bool ClientBlockCache::requestLoad(v3s16 pos)
+{
+	auto it = m_index.find(pos);
+	if (it == m_index.end())
+		return false;
+
+	it->second.last_used = ++m_use_counter;
+	const u32 load_id = ++m_next_load_id;
+	m_pending_loads[pos] = load_id;
+	m_loads_queued++;
+	queueJob(Job{Job::LOAD, pos, it->second.hash, load_id});
+	return true;
+}
+
+void ClientBlockCache::waitLoads()
+{
+	while (m_loads_done < m_loads_queued)
+		m_load_event.wait();
+}
+
+bool ClientBlockCache::getNextLoaded(LoadResult &result)
+{
+	for (;;) {
+		std::pair<u32, LoadResult> loaded;
+		{
+			MutexAutoLock lock(m_queue_mutex);
+			if (m_loaded.empty())
+				return false;
+			loaded = std::move(m_loaded.front());
+			m_loaded.pop_front();
+		}
+
+		const v3s16 pos = loaded.second.pos;
+		auto it = m_pending_loads.find(pos);
+		if (it == m_pending_loads.end() || it->second != loaded.first)
+			continue;
+		m_pending_loads.erase(it);
+
+		if (!loaded.second.ok) {
+			warningstream << "ClientBlockCache: block " << pos.X << "," << pos.Y
+				<< "," << pos.Z << " is missing or damaged" << std::endl;
+			auto entry = m_index.find(pos);
+			if (entry != m_index.end())
+				remove(entry);
+		}
+		result = std::move(loaded.second);
+		return true;
+	}
+}
+
+void ClientBlockCache::queueJob(Job &&job)
+{
+	{
+		MutexAutoLock lock(m_queue_mutex);
+		m_jobs.push_back(std::move(job));
+	}
+	m_thread->deferUpdate();
+}
+
+void ClientBlockCache::runJobs()
+{
+	for (;;) {
+		Job job;
+		{
+			MutexAutoLock lock(m_queue_mutex);
+			if (m_jobs.empty())
+				return;
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+		runJob(job);
+	}
+}
+
+void ClientBlockCache::runJob(Job &job)
+{
+	const std::string name = getFileName(job.pos, job.hash);
+
+	switch (job.type) {
+	case Job::WRITE:
+		fs::CreateAllDirs(m_dir + DIR_DELIM + getShardName(job.pos));
+		if (!m_files.update(name, job.data)) {
+			// Loading it will fail, so that the server sends it again
+			errorstream << "ClientBlockCache: failed to write \"" << name
+				<< "\"" << std::endl;
+		}
+		break;
+	case Job::REMOVE:
+		m_files.remove(name);
+		break;
+	case Job::LOAD: {
+		LoadResult result{job.pos, false, ""};
+		std::ostringstream os(std::ios_base::binary);
+		if (m_files.load(name, os)) {
+			result.data = os.str();
+			result.ok = getHash(result.data) == job.hash;
+		}
+		{
+			MutexAutoLock lock(m_queue_mutex);
+			m_loaded.emplace_back(job.load_id, std::move(result));
+		}
+		m_loads_done++;
+		m_load_event.signal();
+		break;
+	}
+	}
+}
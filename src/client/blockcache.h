@@ -0,0 +1,139 @@
+// Luanti
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 Minetest Authors
+
+#pragma once
+
+#include "filecache.h"
+#include "irr_v3d.h"
+#include "threading/event.h"
+#include "util/basic_macros.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+class BlockCacheThread;
+
+/*
+	Keeps the blocks received from one server on disk, so that the server
+	does not have to send them again in later sessions.
+	See TOSERVER_HAVE_BLOCKS and TOCLIENT_BLOCKDATA_CACHED.
+
+	Every block is one file named after its position and the hash of its
+	data. The files are spread over one directory per 16x16x16 blocks.
+	The list of files is kept in an index file that is written when the
+	cache is closed. Without it, e.g. after a crash, the list is rebuilt
+	from the directories.
+
+	When the files take up more than the size limit, the blocks that were
+	used least recently are removed.
+
+	The index is only used by the thread that created the cache. Files are
+	written, read and removed by a thread of their own, in the order in
+	which that was requested.
+*/
+class ClientBlockCache
+{
+public:
+	struct Entry {
+		// Hash of the data, see getHash()
+		u64 hash;
+		u32 size;
+		// Value of the use counter when the block was last stored or loaded
+		u64 last_used;
+	};
+
+	struct LoadResult {
+		v3s16 pos;
+		// False if the file was missing or damaged
+		bool ok;
+		std::string data;
+	};
+
+	// max_size is in bytes
+	ClientBlockCache(const std::string &dir, u64 max_size);
+	~ClientBlockCache();
+
+	DISABLE_CLASS_COPY(ClientBlockCache)
+
+	// Hash of serialized block data, must match the one of the server
+	static u64 getHash(std::string_view data);
+
+	const std::unordered_map<v3s16, Entry> &getIndex() const { return m_index; }
+	// Total size of the cached blocks, in bytes
+	u64 getSize() const { return m_size; }
+
+	// Where the player was when the cache was closed, in blocks
+	v3s16 getLastPos() const { return m_last_pos; }
+	void setLastPos(v3s16 pos) { m_last_pos = pos; }
+
+	// Discards a load of the same block that is not done yet
+	void store(v3s16 pos, std::string_view data);
+
+	// Fails if the block is not cached. Otherwise the block is read and
+	// checked in the background, and passed to getNextLoaded() after that.
+	bool requestLoad(v3s16 pos);
+	bool hasPendingLoads() const { return !m_pending_loads.empty(); }
+	// Waits until getNextLoaded() has all requested blocks
+	void waitLoads();
+	bool getNextLoaded(LoadResult &result);
+
+private:
+	friend class BlockCacheThread;
+
+	struct Job {
+		enum Type : u8 { WRITE, REMOVE, LOAD };
+
+		Type type;
+		v3s16 pos;
+		u64 hash;
+		// Of a load, to tell whether it is still wanted
+		u32 load_id = 0;
+		std::string data;
+	};
+
+	static std::string getShardName(v3s16 pos);
+	// Relative to the cache directory
+	static std::string getFileName(v3s16 pos, u64 hash);
+
+	bool readIndex();
+	void rebuildIndex();
+	void writeIndex();
+
+	void remove(std::unordered_map<v3s16, Entry>::iterator it);
+	// Removes the least recently used blocks until the size limit is kept
+	void prune();
+
+	void queueJob(Job &&job);
+	// Called by the thread, and by the destructor once the thread stopped
+	void runJobs();
+	void runJob(Job &job);
+
+	const std::string m_dir;
+	const u64 m_max_size;
+	FileCache m_files;
+
+	std::unordered_map<v3s16, Entry> m_index;
+	u64 m_size = 0;
+	u64 m_use_counter = 0;
+	v3s16 m_last_pos;
+
+	// Blocks with a load that is not done yet, and the id of the load
+	std::unordered_map<v3s16, u32> m_pending_loads;
+	u32 m_next_load_id = 0;
+	u32 m_loads_queued = 0;
+	std::atomic<u32> m_loads_done{0};
+	Event m_load_event;
+
+	std::mutex m_queue_mutex;
+	std::deque<Job> m_jobs;
+	// Finished loads and their ids
+	std::deque<std::pair<u32, LoadResult>> m_loaded;
+
+	std::unique_ptr<BlockCacheThread> m_thread;
+};
@@ -5,6 +5,7 @@
 #include "client.h"
 
 #include "chatmessage.h"
+#include "client/blockcache.h"
 #include "client/clientevent.h"
 #include "clientdynamicinfo.h"
 #include "client/fontengine.h"
@@ -381,6 +382,13 @@ void Client::Stop()
 		m_localdb->endSave();
 		m_localdb.reset();
 	}
+	// Close the block cache, which writes its index
+	if (m_block_cache) {
+		if (LocalPlayer *player = m_env.getLocalPlayer())
+			m_block_cache->setLastPos(getNodeBlockPos(
+				floatToInt(player->getPosition(), BS)));
+		m_block_cache.reset();
+	}
 
 	if (m_mods_loaded)
 		delete m_script;
@@ -458,6 +466,7 @@ void Client::connect(const Address &address, const std::string &address_name)
 	m_con->Connect(address);
 
 	initLocalMapSaving(address, m_address_name);
+	initBlockCache(address, m_address_name);
 }
 
 void Client::step(float dtime)
@@ -469,6 +478,7 @@ void Client::step(float dtime)
 	m_animation_time = fmodf(m_animation_time + dtime, 60.0f);
 
 	ReceiveAll();
+	receiveCachedBlocks(false);
 
 	/*
 		Packet counter
@@ -649,6 +659,10 @@ void Client::step(float dtime)
 		Replace updated meshes
 	*/
 	{
+		// Must match what ClientMap::updateDrawList() expects
+		m_mesh_update_manager->setCameraPos(
+				floatToInt(m_env.getClientMap().getCameraPosition(), BS));
+
 		int num_processed_meshes = 0;
 		std::vector<v3s16> blocks_to_ack;
 		bool force_update_shadows = false;
@@ -678,13 +692,17 @@ void Client::step(float dtime)
 				delete block->mesh;
 				block->mesh = nullptr;
 				block->solid_sides = r.solid_sides;
+				// Let ClientMap check the level of detail of the new mesh
+				block->mesh_lod_requested = 0;
 
 				if (r.mesh) {
 					minimap_mapblocks = r.mesh->moveMinimapMapblocks();
 					if (minimap_mapblocks.empty())
 						do_mapper_update = false;
 
-					if (r.mesh->isEmpty()) {
+					// Distant meshes are kept to be made again when
+					// the camera gets closer
+					if (r.mesh->isEmpty() && r.mesh->getLod() == 1) {
 						delete r.mesh;
 					} else {
 						// Replace with the new mesh
@@ -852,40 +870,55 @@ void Client::step(float dtime)
 	}
 }
 
-bool Client::loadMedia(const std::string &data, const std::string &filename,
-	bool from_media_push)
+bool Client::isMediaImage(const std::string &filename)
 {
-	std::string name;
-
 	const char *image_ext[] = {
 		".png", ".jpg", ".tga",
 		NULL
 	};
-	name = removeStringEnd(filename, image_ext);
-	if (!name.empty()) {
-		TRACESTREAM(<< "Client: Attempting to load image "
-			<< "file \"" << filename << "\"" << std::endl);
+	return !removeStringEnd(filename, image_ext).empty();
+}
 
-		io::IFileSystem *irrfs = m_rendering_engine->get_filesystem();
-		video::IVideoDriver *vdrv = m_rendering_engine->get_video_driver();
+video::IImage *Client::decodeMediaImage(const std::string &data,
+	const std::string &filename) const
+{
+	io::IFileSystem *irrfs = m_rendering_engine->get_filesystem();
+	video::IVideoDriver *vdrv = m_rendering_engine->get_video_driver();
+
+	io::IReadFile *rfile = irrfs->createMemoryReadFile(
+			data.c_str(), data.size(), filename.c_str());
+
+	FATAL_ERROR_IF(!rfile, "Could not create irrlicht memory file.");
+
+	// Read image
+	video::IImage *img = vdrv->createImageFromFile(rfile);
+	rfile->drop();
+	return img;
+}
+
+void Client::loadMediaImage(video::IImage *img, const std::string &filename)
+{
+	m_tsrc->insertSourceImage(filename, img);
+}
 
-		io::IReadFile *rfile = irrfs->createMemoryReadFile(
-				data.c_str(), data.size(), filename.c_str());
+bool Client::loadMedia(const std::string &data, const std::string &filename,
+	bool from_media_push)
+{
+	std::string name;
 
-		FATAL_ERROR_IF(!rfile, "Could not create irrlicht memory file.");
+	if (isMediaImage(filename)) {
+		TRACESTREAM(<< "Client: Attempting to load image "
+			<< "file \"" << filename << "\"" << std::endl);
 
-		// Read image
-		video::IImage *img = vdrv->createImageFromFile(rfile);
+		video::IImage *img = decodeMediaImage(data, filename);
 		if (!img) {
 			errorstream<<"Client: Cannot create image from data of "
 					<<"file \""<<filename<<"\""<<std::endl;
-			rfile->drop();
 			return false;
 		}
 
-		m_tsrc->insertSourceImage(filename, img);
+		loadMediaImage(img, filename);
 		img->drop();
-		rfile->drop();
 		return true;
 	}
 
@@ -1017,6 +1050,19 @@ void Client::initLocalMapSaving(const Address &address, const std::string &hostn
 	actionstream << "Local map saving started, map will be saved at '" << world_path << "'" << std::endl;
 }
 
+void Client::initBlockCache(const Address &address, const std::string &hostname)
+{
+	if (!g_settings->getBool("client_block_cache") || m_internal_server)
+		return;
+	if (m_block_cache)
+		return;
+
+	std::string dir = porting::path_cache + DIR_DELIM + "blocks" + DIR_DELIM +
+		sanitizeDirName(hostname + "_" + std::to_string(address.getPort()), "server_");
+	const u64 max_size = (u64)g_settings->getU32("client_block_cache_size") * 1024 * 1024;
+	m_block_cache = std::make_unique<ClientBlockCache>(dir, max_size);
+}
+
 void Client::ReceiveAll()
 {
 	NetworkPacket pkt;
@@ -1305,6 +1351,39 @@ void Client::sendGotBlocks(const std::vector<v3s16> &blocks)
 	Send(&pkt);
 }
 
+void Client::sendHaveBlocks()
+{
+	if (!m_block_cache || m_proto_ver < 52)
+		return;
+
+	// The server only keeps so many, so send the ones closest to where
+	// the player was last time. Players usually join at that position.
+	const auto &index = m_block_cache->getIndex();
+	const v3s32 last_pos = v3s32::from(m_block_cache->getLastPos());
+	std::vector<std::pair<v3s16, u64>> blocks;
+	blocks.reserve(index.size());
+	for (const auto &[pos, entry] : index)
+		blocks.emplace_back(pos, entry.hash);
+	const size_t count = std::min<size_t>(blocks.size(), MAX_ADVERTISED_BLOCKS);
+	std::partial_sort(blocks.begin(), blocks.begin() + count, blocks.end(),
+		[last_pos] (const auto &a, const auto &b) {
+			return (v3s32::from(a.first) - last_pos).getLengthSQ() <
+				(v3s32::from(b.first) - last_pos).getLengthSQ();
+		});
+
+	// An empty list still tells the server that new blocks are cached
+	size_t sent = 0;
+	do {
+		const u16 n = std::min<size_t>(count - sent, 1024);
+		NetworkPacket pkt(TOSERVER_HAVE_BLOCKS, 2 + n * (6 + 8));
+		pkt << n;
+		for (u16 i = 0; i < n; i++)
+			pkt << blocks[sent + i].first << blocks[sent + i].second;
+		Send(&pkt);
+		sent += n;
+	} while (sent < count);
+}
+
 void Client::sendRemovedSounds(const std::vector<s32> &soundList)
 {
 	size_t server_ids = soundList.size();
@@ -1958,6 +2037,7 @@ void Client::afterContentReceived()
 	m_mesh_update_manager->start();
 
 	m_state = LC_Ready;
+	sendHaveBlocks();
 	sendReady();
 
 	if (m_mods_loaded)
@@ -29,6 +29,7 @@
 #define CLIENT_CHAT_MESSAGE_LIMIT_PER_10S 10.0f
 
 class Camera;
+class ClientBlockCache;
 class ClientMediaDownloader;
 class ISoundManager;
 class IWritableItemDefManager;
@@ -61,6 +62,10 @@ namespace scene {
 class IAnimatedMesh;
 }
 
+namespace video {
+class IImage;
+}
+
 namespace con {
 class IConnection;
 }
@@ -163,6 +168,7 @@ class Client : public con::PeerHandler, public InventoryManager, public IGameDef
 	void handleCommand_AddNode(NetworkPacket* pkt);
 	void handleCommand_NodemetaChanged(NetworkPacket *pkt);
 	void handleCommand_BlockData(NetworkPacket* pkt);
+	void handleCommand_BlockDataCached(NetworkPacket *pkt);
 	void handleCommand_Inventory(NetworkPacket* pkt);
 	void handleCommand_TimeOfDay(NetworkPacket* pkt);
 	void handleCommand_ChatMessage(NetworkPacket *pkt);
@@ -388,6 +394,11 @@ class Client : public con::PeerHandler, public InventoryManager, public IGameDef
 	// Insert a media file appropriately into the appropriate manager
 	bool loadMedia(const std::string &data, const std::string &filename,
 		bool from_media_push = false);
+	// Images can be decoded ahead of time, from any thread
+	static bool isMediaImage(const std::string &filename);
+	video::IImage *decodeMediaImage(const std::string &data,
+		const std::string &filename) const;
+	void loadMediaImage(video::IImage *img, const std::string &filename);
 
 	// Send a request for conventional media transfer
 	void request_media(const std::vector<std::string> &file_requests);
@@ -448,6 +459,7 @@ class Client : public con::PeerHandler, public InventoryManager, public IGameDef
 	void deletingPeer(con::IPeer *peer, bool timeout) override;
 
 	void initLocalMapSaving(const Address &address, const std::string &hostname);
+	void initBlockCache(const Address &address, const std::string &hostname);
 
 	void ReceiveAll();
 
@@ -461,6 +473,11 @@ class Client : public con::PeerHandler, public InventoryManager, public IGameDef
 	void startAuth(AuthMechanism chosen_auth_mechanism);
 	void sendDeletedBlocks(std::vector<v3s16> &blocks);
 	void sendGotBlocks(const std::vector<v3s16> &blocks);
+	void sendHaveBlocks();
+	void receiveBlock(v3s16 p, const std::string &data);
+	// Passes on the blocks loaded from the block cache. If wait is true,
+	// also the ones that are still being loaded.
+	void receiveCachedBlocks(bool wait);
 	void sendRemovedSounds(const std::vector<s32> &soundList);
 
 	bool canSendChatMessage() const;
@@ -573,6 +590,9 @@ class Client : public con::PeerHandler, public InventoryManager, public IGameDef
 	IntervalLimiter m_localdb_save_interval;
 	u16 m_cache_save_interval;
 
+	// Blocks received in earlier sessions, see TOSERVER_HAVE_BLOCKS
+	std::unique_ptr<ClientBlockCache> m_block_cache;
+
 	// Client modding
 	ClientScripting *m_script = nullptr;
 	ModStorageDatabase *m_mod_storage_database = nullptr;
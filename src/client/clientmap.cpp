@@ -22,6 +22,9 @@
 #include "util/tracy_wrapper.h"
 #include "client/renderingengine.h"
 
+#include "threading/semaphore.h"
+#include "threading/thread.h"
+#include <atomic>
 #include <queue>
 
 namespace {
@@ -137,6 +140,95 @@ void CachedMeshBuffer::drop()
 	buf.clear();
 }
 
+/*
+	OcclusionCheckThreads
+*/
+
+class OcclusionCheckThreads
+{
+public:
+	OcclusionCheckThreads(u32 count)
+	{
+		for (u32 i = 0; i < count; i++) {
+			m_threads.emplace_back(std::make_unique<Worker>(this));
+			m_threads.back()->start();
+		}
+	}
+
+	~OcclusionCheckThreads()
+	{
+		for (auto &thread : m_threads)
+			thread->stop();
+		for (size_t i = 0; i < m_threads.size(); i++)
+			m_start.post();
+		for (auto &thread : m_threads)
+			thread->wait();
+	}
+
+	DISABLE_CLASS_COPY(OcclusionCheckThreads)
+
+	// Calls fn(i) for every i < count, on the threads and the calling one.
+	// Returns once all calls are done.
+	void run(size_t count, const std::function<void(size_t)> &fn)
+	{
+		// Waking up the threads costs more than a few checks
+		if (m_threads.empty() || count < 16) {
+			for (size_t i = 0; i < count; i++)
+				fn(i);
+			return;
+		}
+
+		m_fn = &fn;
+		m_count = count;
+		m_next = 0;
+		for (size_t i = 0; i < m_threads.size(); i++)
+			m_start.post();
+		work();
+		for (size_t i = 0; i < m_threads.size(); i++)
+			m_done.wait();
+		m_fn = nullptr;
+	}
+
+private:
+	class Worker : public Thread
+	{
+	public:
+		Worker(OcclusionCheckThreads *threads) :
+			Thread("OcclusionCheck"), m_threads(threads)
+		{}
+
+	private:
+		void *run() override
+		{
+			for (;;) {
+				m_threads->m_start.wait();
+				if (stopRequested())
+					return nullptr;
+				m_threads->work();
+				m_threads->m_done.post();
+			}
+		}
+
+		OcclusionCheckThreads *m_threads;
+	};
+
+	void work()
+	{
+		size_t i;
+		while ((i = m_next++) < m_count)
+			(*m_fn)(i);
+	}
+
+	std::vector<std::unique_ptr<Worker>> m_threads;
+	// Posted once per thread for every run, and when stopping
+	Semaphore m_start;
+	Semaphore m_done;
+
+	const std::function<void(size_t)> *m_fn = nullptr;
+	size_t m_count = 0;
+	std::atomic<size_t> m_next{0};
+};
+
 /*
 	ClientMap
 */
@@ -182,6 +274,13 @@ ClientMap::ClientMap(
 		g_settings->registerChangedCallback(name, on_settings_changed, this);
 	// load all settings at once
 	onSettingChanged("", true);
+
+	// Only read once, like the mesh update queue does
+	m_cache_mesh_lod_distance = g_settings->getU16("mesh_lod_distance");
+
+	// Leave some room for the main thread and the mesh generation
+	m_occlusion_threads = std::make_unique<OcclusionCheckThreads>(
+		std::min(4U, Thread::getNumberOfProcessors() / 2));
 }
 
 void ClientMap::onSettingChanged(std::string_view name, bool all)
@@ -417,11 +516,34 @@ void ClientMap::updateDrawList()
 	// if (occlusion_culling_enabled && m_control.show_wireframe)
 	// 	occlusion_culling_enabled = porting::getTimeS() & 1;
 
-	const auto &add_to_drawlist = [this] (MapBlock *block) {
+	// Raytraced occlusion culling sends rays from the camera to the corners
+	// of the blocks. The rays are spread over several threads, so they only
+	// look up blocks in a snapshot.
+	const bool check_occlusion = occlusion_culling_enabled &&
+			m_enable_raytraced_culling && !m_control.range_all;
+	const v2s16 snapshot_margin(mesh_grid.cell_size, mesh_grid.cell_size);
+	const SectorSnapshot snapshot = check_occlusion ?
+			getSectorSnapshot(v2s16(p_blocks_min.X, p_blocks_min.Z) - snapshot_margin,
+				v2s16(p_blocks_max.X, p_blocks_max.Z) + snapshot_margin) :
+			SectorSnapshot(v2s16(0, 0), v2s16(-1, -1));
+
+	const auto &add_to_drawlist = [&] (MapBlock *block) {
 		block->refGrab();
 		auto res = m_drawlist.emplace(block->getPos(), block);
 		(void)res;
 		assert(res.second); // must not already exist
+
+		// Make the mesh again if the camera got closer or went away,
+		// unless that level was already asked for
+		const u8 mesh_lod = block->mesh->getLod();
+		const u8 lod = getMeshLod(block->getPos(), mesh_grid,
+				cam_pos_nodes, m_cache_mesh_lod_distance, mesh_lod);
+		if (lod == mesh_lod) {
+			block->mesh_lod_requested = 0;
+		} else if (lod != block->mesh_lod_requested) {
+			block->mesh_lod_requested = lod;
+			m_client->addUpdateMeshTask(block->getPos());
+		}
 	};
 
 	// Set of mesh holding blocks, will be transferred to m_drawlist
@@ -438,7 +560,8 @@ void ClientMap::updateDrawList()
 		u32 blocks_in_range = 0;
 		assert(m_keeplist.empty());
 
-		MapBlockVect sectorblocks;
+		// Blocks that are left after frustum culling
+		std::vector<MapBlock *> in_frustum;
 
 		for (auto &sector_it : m_sectors) {
 			const MapSector *sector = sector_it.second;
@@ -460,7 +583,6 @@ void ClientMap::updateDrawList()
 				v3f mesh_sphere_center;
 				f32 mesh_sphere_radius;
 
-				v3s16 block_pos = block->getPos();
 				v3s16 block_pos_nodes = block->getPosRelative();
 
 				if (mesh) {
@@ -493,32 +615,46 @@ void ClientMap::updateDrawList()
 					continue;
 				}
 
-				// Raytraced occlusion culling - send rays from the camera to the block's corners
-				if (!m_control.range_all && occlusion_culling_enabled && m_enable_raytraced_culling &&
-						block &&
-						isMeshOccluded(block, mesh_grid.cell_size, cam_pos_nodes)) {
-					blocks_occlusion_culled++;
-					continue;
-				}
+				in_frustum.push_back(block);
+			}
+		}
 
-				if (mesh_grid.cell_size > 1) {
-					// Block meshes are stored in the corner block of a chunk
-					// (where all coordinate are divisible by the chunk size)
-					// Deduplicate and add them later
-					shortlist.emplace(mesh_grid.getMeshPos(block_pos));
-					// All other blocks we can add to m_keeplist right away
-					if (!mesh_grid.isMeshPos(block_pos) || !mesh) {
-						m_keeplist.push_back(block);
-						block->refGrab();
-					}
-				} else {
-					if (mesh) {
-						// add directly to the drawlist
-						add_to_drawlist(block);
-					} else { // ...or to m_keeplist
-						m_keeplist.push_back(block);
-						block->refGrab();
-					}
+		// One per block, vector<bool> can't be written from several threads
+		std::vector<u8> occluded(in_frustum.size(), 0);
+		if (check_occlusion) {
+			m_occlusion_threads->run(in_frustum.size(), [&] (size_t i) {
+				occluded[i] = isMeshOccluded(in_frustum[i], mesh_grid.cell_size,
+						cam_pos_nodes, snapshot);
+			});
+		}
+
+		for (size_t i = 0; i < in_frustum.size(); i++) {
+			if (occluded[i]) {
+				blocks_occlusion_culled++;
+				continue;
+			}
+
+			MapBlock *block = in_frustum[i];
+			MapBlockMesh *mesh = block->mesh;
+			v3s16 block_pos = block->getPos();
+
+			if (mesh_grid.cell_size > 1) {
+				// Block meshes are stored in the corner block of a chunk
+				// (where all coordinate are divisible by the chunk size)
+				// Deduplicate and add them later
+				shortlist.emplace(mesh_grid.getMeshPos(block_pos));
+				// All other blocks we can add to m_keeplist right away
+				if (!mesh_grid.isMeshPos(block_pos) || !mesh) {
+					m_keeplist.push_back(block);
+					block->refGrab();
+				}
+			} else {
+				if (mesh) {
+					// add directly to the drawlist
+					add_to_drawlist(block);
+				} else { // ...or to m_keeplist
+					m_keeplist.push_back(block);
+					block->refGrab();
 				}
 			}
 		}
@@ -544,56 +680,104 @@ void ClientMap::updateDrawList()
 		blocks_to_consider.push(camera_mesh);
 		meshes_seen.getChunk(camera_cell).getBits(camera_cell) = 0x07; // mark all sides as visible
 
-		// Recursively walk the space and pick mapblocks for drawing
-		while (!blocks_to_consider.empty()) {
-			v3s16 block_coord = blocks_to_consider.front();
-			blocks_to_consider.pop();
-			// We only iterate along the grid
-			assert(mesh_grid.isMeshPos(block_coord));
+		// Recursively walk the space and pick mapblocks for drawing.
+		// This goes one step away from the camera at a time. The occlusion
+		// checks of a step don't depend on each other, so they are made in
+		// parallel before the step is walked.
+		struct StepMesh {
+			v3s16 coord;
+			MapBlock *block;
+			// Only checked if not all near sides are visible yet
+			bool occluded;
+		};
+		std::vector<StepMesh> step;
+		std::vector<size_t> step_checks;
+		size_t step_next = 0;
+
+		auto start_step = [&] () {
+			step.clear();
+			step_checks.clear();
+			step_next = 0;
+
+			while (!blocks_to_consider.empty()) {
+				v3s16 block_coord = blocks_to_consider.front();
+				blocks_to_consider.pop();
+				// We only iterate along the grid
+				assert(mesh_grid.isMeshPos(block_coord));
+
+				v3s16 cell_coord = mesh_grid.getCellPos(block_coord);
+				auto &flags = meshes_seen.getChunk(cell_coord).getBits(cell_coord);
+
+				// Only visit each cell once (it may have been queued up to three times)
+				if ((flags & 0x80) == 0x80)
+					continue;
+				flags |= 0x80;
 
-			v3s16 cell_coord = mesh_grid.getCellPos(block_coord);
-			auto &flags = meshes_seen.getChunk(cell_coord).getBits(cell_coord);
+				blocks_visited++;
 
-			// Only visit each cell once (it may have been queued up to three times)
-			if ((flags & 0x80) == 0x80)
-				continue;
-			flags |= 0x80;
+				MapBlock *block = getBlockNoCreateNoEx(block_coord);
+				MapBlockMesh *mesh = block ? block->mesh : nullptr;
 
-			blocks_visited++;
+				// Calculate the coordinates for range and frustum culling
+				v3f mesh_sphere_center;
+				f32 mesh_sphere_radius;
 
-			MapBlock *block = getBlockNoCreateNoEx(block_coord);
-			MapBlockMesh *mesh = block ? block->mesh : nullptr;
+				v3s16 block_pos_nodes = block_coord * MAP_BLOCKSIZE;
 
-			// Calculate the coordinates for range and frustum culling
-			v3f mesh_sphere_center;
-			f32 mesh_sphere_radius;
+				if (mesh) {
+					mesh_sphere_center = intToFloat(block_pos_nodes, BS)
+							+ mesh->getBoundingSphereCenter();
+					mesh_sphere_radius = mesh->getBoundingRadius();
+				} else {
+					mesh_sphere_center = intToFloat(block_pos_nodes, BS) +
+						v3f((mesh_grid.cell_size * MAP_BLOCKSIZE * 0.5f - 0.5f) * BS);
+					mesh_sphere_radius = 0.87f * mesh_grid.cell_size * MAP_BLOCKSIZE * BS;
+				}
 
-			v3s16 block_pos_nodes = block_coord * MAP_BLOCKSIZE;
+				// First, perform a simple distance check.
+				if (mesh_sphere_center.getDistanceFrom(intToFloat(cam_pos_nodes, BS)) >
+						m_control.wanted_range * BS + mesh_sphere_radius)
+					continue; // Out of range, skip.
 
-			if (mesh) {
-				mesh_sphere_center = intToFloat(block_pos_nodes, BS)
-						+ mesh->getBoundingSphereCenter();
-				mesh_sphere_radius = mesh->getBoundingRadius();
-			} else {
-				mesh_sphere_center = intToFloat(block_pos_nodes, BS) +
-					v3f((mesh_grid.cell_size * MAP_BLOCKSIZE * 0.5f - 0.5f) * BS);
-				mesh_sphere_radius = 0.87f * mesh_grid.cell_size * MAP_BLOCKSIZE * BS;
+				// Frustum culling
+				// Only do coarse culling here, to account for fast camera movement.
+				// This is needed because this function is not called every frame.
+				float frustum_cull_extra_radius = 30.0f * BS;
+				if (is_frustum_culled(mesh_sphere_center,
+						mesh_sphere_radius + frustum_cull_extra_radius)) {
+					blocks_frustum_culled++;
+					continue;
+				}
+
+				// The walk of this step can only make more sides visible
+				if (check_occlusion && block && (flags & 0x07) != 0x07)
+					step_checks.push_back(step.size());
+				step.push_back(StepMesh{block_coord, block, false});
 			}
 
-			// First, perform a simple distance check.
-			if (mesh_sphere_center.getDistanceFrom(intToFloat(cam_pos_nodes, BS)) >
-					m_control.wanted_range * BS + mesh_sphere_radius)
-				continue; // Out of range, skip.
+			m_occlusion_threads->run(step_checks.size(), [&] (size_t i) {
+				StepMesh &step_mesh = step[step_checks[i]];
+				step_mesh.occluded = isMeshOccluded(step_mesh.block,
+						mesh_grid.cell_size, cam_pos_nodes, snapshot);
+			});
+		};
 
-			// Frustum culling
-			// Only do coarse culling here, to account for fast camera movement.
-			// This is needed because this function is not called every frame.
-			float frustum_cull_extra_radius = 30.0f * BS;
-			if (is_frustum_culled(mesh_sphere_center,
-					mesh_sphere_radius + frustum_cull_extra_radius)) {
-				blocks_frustum_culled++;
+		for (;;) {
+			if (step_next == step.size()) {
+				if (blocks_to_consider.empty())
+					break;
+				start_step();
 				continue;
 			}
+			const StepMesh &step_mesh = step[step_next++];
+
+			v3s16 block_coord = step_mesh.coord;
+			MapBlock *block = step_mesh.block;
+			MapBlockMesh *mesh = block ? block->mesh : nullptr;
+			v3s16 block_pos_nodes = block_coord * MAP_BLOCKSIZE;
+
+			v3s16 cell_coord = mesh_grid.getCellPos(block_coord);
+			u8 flags = meshes_seen.getChunk(cell_coord).getBits(cell_coord);
 
 			// Calculate the vector from the camera block to the current block
 			// We use it to determine through which sides of the current block we can continue the search
@@ -603,9 +787,7 @@ void ClientMap::updateDrawList()
 			u8 visible_outer_sides = flags & 0x07;
 
 			// Raytraced occlusion culling - send rays from the camera to the block's corners
-			if (occlusion_culling_enabled && m_enable_raytraced_culling &&
-					block && visible_outer_sides != 0x07 &&
-					isMeshOccluded(block, mesh_grid.cell_size, cam_pos_nodes)) {
+			if (visible_outer_sides != 0x07 && step_mesh.occluded) {
 				blocks_occlusion_culled++;
 				continue;
 			}
@@ -1661,10 +1843,11 @@ u32 DrawDescriptor::draw(video::IVideoDriver* driver)
 	}
 }
 
-bool ClientMap::isMeshOccluded(MapBlock *mesh_block, u16 mesh_size, v3s16 cam_pos_nodes)
+bool ClientMap::isMeshOccluded(MapBlock *mesh_block, u16 mesh_size, v3s16 cam_pos_nodes,
+		const SectorSnapshot &snapshot)
 {
 	if (mesh_size == 1)
-		return isBlockOccluded(mesh_block, cam_pos_nodes);
+		return isBlockOccluded(mesh_block, cam_pos_nodes, &snapshot);
 
 	v3s16 min_edge = mesh_block->getPosRelative();
 	v3s16 max_edge = min_edge + mesh_size * MAP_BLOCKSIZE -1;
@@ -1701,9 +1884,9 @@ bool ClientMap::isMeshOccluded(MapBlock *mesh_block, u16 mesh_size, v3s16 cam_po
 				if (mesh_block->getPos() == block_pos)
 					block = mesh_block;
 				else
-					block = getBlockNoCreateNoEx(block_pos);
+					block = snapshot.getBlock(block_pos);
 
-				if (block && !isBlockOccluded(block, cam_pos_nodes))
+				if (block && !isBlockOccluded(block, cam_pos_nodes, &snapshot))
 					return false;
 			}
 		}
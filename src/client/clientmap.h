@@ -8,6 +8,7 @@
 #include "map.h"
 #include <ISceneNode.h>
 #include <map>
+#include <memory>
 #include <functional>
 
 struct MapDrawControl
@@ -24,6 +25,7 @@ struct MapDrawControl
 
 class Client;
 class RenderingEngine;
+class OcclusionCheckThreads;
 
 enum CameraMode : int;
 
@@ -123,6 +125,7 @@ class ClientMap : public Map, public scene::ISceneNode
 	const MapDrawControl & getControl() const { return m_control; }
 	f32 getWantedRange() const { return m_control.wanted_range; }
 	f32 getCameraFov() const { return m_camera_fov; }
+	v3f getCameraPosition() const { return m_camera_position; }
 
 	void onSettingChanged(std::string_view name, bool all);
 
@@ -132,7 +135,9 @@ class ClientMap : public Map, public scene::ISceneNode
 
 	void reportMetrics(u64 save_time_us, u32 saved_blocks, u32 all_blocks) override;
 private:
-	bool isMeshOccluded(MapBlock *mesh_block, u16 mesh_size, v3s16 cam_pos_nodes);
+	// Safe to call from other threads, see SectorSnapshot
+	bool isMeshOccluded(MapBlock *mesh_block, u16 mesh_size, v3s16 cam_pos_nodes,
+			const SectorSnapshot &snapshot);
 
 	// update the vertex order in transparent mesh buffers
 	void updateTransparentMeshBuffers();
@@ -185,4 +190,8 @@ class ClientMap : public Map, public scene::ISceneNode
 
 	bool m_loops_occlusion_culler;
 	bool m_enable_raytraced_culling;
+	u16 m_cache_mesh_lod_distance;
+
+	// Help with the occlusion checks of updateDrawList()
+	std::unique_ptr<OcclusionCheckThreads> m_occlusion_threads;
 };
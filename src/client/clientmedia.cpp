@@ -11,10 +11,17 @@
 #include "log.h"
 #include "porting.h"
 #include "settings.h"
+#include "threading/mutex_auto_lock.h"
+#include "threading/semaphore.h"
+#include "threading/thread.h"
 #include "util/hex.h"
 #include "util/serialize.h"
 #include "util/hashing.h"
 #include "util/string.h"
+#include <IImage.h>
+#include <atomic>
+#include <deque>
+#include <functional>
 #include <sstream>
 
 static std::string getMediaCacheDir()
@@ -177,23 +184,98 @@ std::string ClientMediaDownloader::makeReferer(Client *client)
 		std::to_string(client->getServerAddress().getPort());
 }
 
-void ClientMediaDownloader::initialStep(Client *client)
+namespace {
+	class MediaCacheThread : public Thread {
+	public:
+		MediaCacheThread(const std::function<void()> &fn) :
+			Thread("MediaCache"), m_fn(fn)
+		{}
+
+	private:
+		void *run() override
+		{
+			m_fn();
+			return nullptr;
+		}
+
+		std::function<void()> m_fn;
+	};
+}
+
+void ClientMediaDownloader::readFromCache(Client *client,
+	const std::function<void(CachedFile &)> &on_file)
 {
+	std::vector<std::pair<const std::string *, FileStatus *>> files;
+	files.reserve(m_files.size());
+	for (auto &file_it : m_files)
+		files.emplace_back(&file_it.first, file_it.second);
+
+	const u32 num_threads = rangelim(Thread::getNumberOfProcessors(), 1, 16);
+	std::atomic<size_t> next_index{0};
+	// Files that were read but not handed over take up memory, so the
+	// workers only read so far ahead
+	Semaphore free_slots(num_threads * 4);
+	Semaphore ready_count;
+	std::mutex ready_mutex;
+	std::deque<CachedFile> ready;
+
+	// Runs in the worker threads, must not touch anything but its file
+	auto read_files = [&] () {
+		size_t i;
+		while ((i = next_index++) < files.size()) {
+			free_slots.wait();
+
+			CachedFile file;
+			file.name = files[i].first;
+			file.status = files[i].second;
+			const std::string &name = *file.name;
+			const std::string &sha1 = file.status->sha1;
+
+			std::ostringstream tmp_os(std::ios_base::binary);
+			if (m_media_cache.load(hex_encode(sha1), tmp_os)) {
+				file.data = tmp_os.str();
+				file.valid = hashing::sha1(file.data) == sha1;
+				if (!file.valid) {
+					infostream << "Client: Cached media file " << hex_encode(sha1)
+						<< " \"" << name << "\" mismatches actual checksum "
+						<< hex_encode(hashing::sha1(file.data)) << std::endl;
+					file.data.clear();
+				} else if (Client::isMediaImage(name)) {
+					file.image = client->decodeMediaImage(file.data, name);
+					if (file.image)
+						file.data.clear();
+				}
+			}
+
+			{
+				MutexAutoLock lock(ready_mutex);
+				ready.push_back(std::move(file));
+			}
+			ready_count.post();
+		}
+	};
+
+	std::vector<std::unique_ptr<MediaCacheThread>> threads;
+	for (u32 i = 0; i < num_threads; i++) {
+		threads.emplace_back(std::make_unique<MediaCacheThread>(read_files));
+		threads.back()->start();
+	}
+
 	std::wstring loading_text = wstrgettext("Media...");
 	// Tradeoff between responsiveness during media loading and media loading speed
 	const u64 chunk_time_ms = 33;
 	u64 last_time = porting::getTimeMs();
-
-	// Check media cache
-	m_uncached_count = m_files.size();
-	for (auto &file_it : m_files) {
-		const std::string &name = file_it.first;
-		FileStatus *filestatus = file_it.second;
-		const std::string &sha1 = filestatus->sha1;
-
-		if (tryLoadFromCache(name, sha1, client)) {
-			filestatus->received = true;
-			m_uncached_count--;
+	for (size_t done = 0; done < files.size();) {
+		if (ready_count.wait(chunk_time_ms)) {
+			CachedFile file;
+			{
+				MutexAutoLock lock(ready_mutex);
+				file = std::move(ready.front());
+				ready.pop_front();
+			}
+			free_slots.post();
+			on_file(file);
+			done++;
 		}
 
 		u64 cur_time = porting::getTimeMs();
@@ -203,6 +285,41 @@ void ClientMediaDownloader::initialStep(Client *client)
 			last_time = cur_time;
 		}
 	}
+	for (auto &thread : threads)
+		thread->wait();
+}
+
+void ClientMediaDownloader::initialStep(Client *client)
+{
+	// Check media cache. The files are read, checked and decoded in the
+	// background, and handed to the client as they are done.
+	m_uncached_count = m_files.size();
+	readFromCache(client, [&] (CachedFile &file) {
+		const std::string &name = *file.name;
+		FileStatus *filestatus = file.status;
+
+		bool loaded = false;
+		if (file.image) {
+			client->loadMediaImage(file.image, name);
+			file.image->drop();
+			loaded = true;
+		} else if (file.valid) {
+			loaded = loadMedia(client, file.data, name);
+			if (!loaded) {
+				infostream << "Client: Failed to load cached media: "
+					<< hex_encode(filestatus->sha1) << " \"" << name << "\""
+					<< std::endl;
+			}
+		}
+
+		if (loaded) {
+			verbosestream << "Client: Loaded cached media: "
+				<< hex_encode(filestatus->sha1) << " \"" << name << "\""
+				<< std::endl;
+			filestatus->received = true;
+			m_uncached_count--;
+		}
+	});
 
 	assert(m_uncached_received_count == 0);
 
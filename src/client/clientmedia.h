@@ -7,6 +7,7 @@
 #include "irrlichttypes.h"
 #include "filecache.h"
 #include "util/basic_macros.h"
+#include <functional>
 #include <map>
 #include <set>
 #include <vector>
@@ -15,6 +16,10 @@
 class Client;
 struct HTTPFetchResult;
 
+namespace video {
+	class IImage;
+}
+
 #define MTHASHSET_FILE_SIGNATURE 0x4d544853 // 'MTHS'
 #define MTHASHSET_FILE_NAME "index.mth"
 
@@ -134,7 +139,22 @@ class ClientMediaDownloader : public IClientMediaDownloader
 		s32 active_count;
 	};
 
+	// A file from the media cache, read and checked in the background
+	struct CachedFile {
+		const std::string *name = nullptr;
+		FileStatus *status = nullptr;
+		// Found and matches the announced hash
+		bool valid = false;
+		std::string data;
+		// Decoded already if it is an image, data is then left empty
+		video::IImage *image = nullptr;
+	};
+
 	void initialStep(Client *client);
+	// Reads, checks and decodes the cached files of m_files on all cores.
+	// Each file is passed to on_file in this thread as soon as it is done.
+	void readFromCache(Client *client,
+		const std::function<void(CachedFile &)> &on_file);
 	void remoteHashSetReceived(const HTTPFetchResult &fetch_result);
 	void remoteMediaReceived(const HTTPFetchResult &fetch_result,
 			Client *client);
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LGPL-2.1-or-later
 // Copyright (C) 2010-2013 celeron55, Perttu Ahola <celeron55@gmail.com>
 
+#include <algorithm>
 #include <cmath>
 #include "content_mapblock.h"
 #include "util/basic_macros.h"
@@ -476,6 +477,17 @@ void MapblockMeshGenerator::drawSolidNode()
 	auto box = aabb3f(v3f(-0.5 * BS), v3f(0.5 * BS));
 	box.MinEdge += cur_node.origin;
 	box.MaxEdge += cur_node.origin;
+
+	// Uniformly lit faces are handed over to drawMergedFaces()
+	const bool merge = data->m_merge_faces && cur_node.f->drawtype == NDT_NORMAL;
+	auto merge_face = [&] (int face, LightPair light) {
+		video::SColor color = encode_light(light, cur_node.f->light_source);
+		if (!cur_node.f->light_source)
+			applyFacesShading(color, v3f(tile_dirs[face].X, tile_dirs[face].Y, tile_dirs[face].Z));
+		if (addMergeableFace(face, tiles[face], color))
+			mask |= 1 << face;
+	};
+
 	if (data->m_smooth_lighting) {
 		LightPair lights[6][4];
 		for (int face = 0; face < 6; ++face) {
@@ -486,6 +498,10 @@ void MapblockMeshGenerator::drawSolidNode()
 				lights[face][k] = LightPair(getSmoothLightSolid(
 						blockpos_nodes + cur_node.p, tile_dirs[face], corner, data));
 			}
+			if (merge && (u16)lights[face][0] == lights[face][1] &&
+					(u16)lights[face][0] == lights[face][2] &&
+					(u16)lights[face][0] == lights[face][3])
+				merge_face(face, lights[face][0]);
 		}
 
 		drawCuboid(box, tiles, 6, nullptr, mask, [&] (int face, video::S3DVertex vertices[4]) {
@@ -501,6 +517,13 @@ void MapblockMeshGenerator::drawSolidNode()
 			return QuadDiagonal::Diag02;
 		});
 	} else {
+		if (merge) {
+			for (int face = 0; face < 6; ++face) {
+				if (!(mask & (1 << face)))
+					merge_face(face, LightPair(lights[face]));
+			}
+		}
+
 		drawCuboid(box, tiles, 6, nullptr, mask, [&] (int face, video::S3DVertex vertices[4]) {
 			video::SColor color = encode_light(lights[face], cur_node.f->light_source);
 			if (!cur_node.f->light_source)
@@ -514,6 +537,339 @@ void MapblockMeshGenerator::drawSolidNode()
 	}
 }
 
+// Node axes of the merged faces: the one along the normal, then the ones
+// along the U and V texture coordinates (see setupCuboidVertices)
+static const u8 merge_axes[6][3] = {
+	{1, 0, 2}, // up
+	{1, 0, 2}, // down
+	{0, 2, 1}, // right
+	{0, 2, 1}, // left
+	{2, 0, 1}, // back
+	{2, 0, 1}, // front
+};
+
+// Whether the texture can simply be repeated over a merged face
+static bool isMergeableTile(const TileSpec &tile)
+{
+	if (tile.world_aligned && tile.layers[0].scale != 1)
+		return false;
+	constexpr u8 tileable = MATERIAL_FLAG_TILEABLE_HORIZONTAL | MATERIAL_FLAG_TILEABLE_VERTICAL;
+	for (const TileLayer &layer : tile.layers) {
+		if (layer.empty())
+			continue;
+		// Transparent faces must stay separate for depth sorting
+		if ((layer.material_flags & tileable) != tileable ||
+				(layer.material_flags & (MATERIAL_FLAG_CRACK | MATERIAL_FLAG_ANIMATION)) ||
+				layer.isTransparent())
+			return false;
+	}
+	return true;
+}
+
+static bool isSameTile(const TileSpec &a, const TileSpec &b)
+{
+	if (a.world_aligned != b.world_aligned || a.rotation != b.rotation)
+		return false;
+	for (int layer = 0; layer < MAX_TILE_LAYERS; layer++) {
+		const TileLayer &la = a.layers[layer];
+		const TileLayer &lb = b.layers[layer];
+		if (la != lb || la.texture_layer_idx != lb.texture_layer_idx ||
+				la.scale != lb.scale)
+			return false;
+	}
+	return true;
+}
+
+bool MapblockMeshGenerator::addMergeableFace(int face, const TileSpec &tile,
+		video::SColor color)
+{
+	if (!isMergeableTile(tile))
+		return false;
+
+	// Neighboring faces mostly look the same, so search from the back
+	u16 id = 0;
+	for (size_t i = merge_faces.size(); i > 0; i--) {
+		const MergeableFace &mf = merge_faces[i - 1];
+		if (mf.color == color && isSameTile(mf.tile, tile)) {
+			id = i;
+			break;
+		}
+	}
+	if (id == 0) {
+		if (merge_faces.size() >= U16_MAX)
+			return false;
+		merge_faces.push_back({tile, color});
+		id = merge_faces.size();
+	}
+
+	const u32 side = data->m_side_length;
+	std::vector<u16> &grid = merge_grid[face];
+	if (grid.empty())
+		grid.resize(side * side * side, 0);
+	const u8 *axes = merge_axes[face];
+	const v3s16 &p = cur_node.p;
+	grid[(p[axes[0]] * side + p[axes[2]]) * side + p[axes[1]]] = id;
+	return true;
+}
+
+void MapblockMeshGenerator::drawMergedFaces()
+{
+	const s16 side = data->m_side_length;
+	for (int face = 0; face < 6; face++) {
+		std::vector<u16> &grid = merge_grid[face];
+		if (grid.empty())
+			continue;
+		const u8 *axes = merge_axes[face];
+
+		// Grow every rectangle along U first, then along V for as long as
+		// the whole row matches
+		for (s16 w = 0; w < side; w++)
+		for (s16 v0 = 0; v0 < side; v0++)
+		for (s16 u0 = 0; u0 < side; u0++) {
+			const u32 row0 = (w * side + v0) * side;
+			const u16 id = grid[row0 + u0];
+			if (id == 0)
+				continue;
+
+			s16 u1 = u0 + 1;
+			while (u1 < side && grid[row0 + u1] == id)
+				u1++;
+			s16 v1 = v0 + 1;
+			for (; v1 < side; v1++) {
+				const u32 row = (w * side + v1) * side;
+				if (!std::all_of(grid.begin() + row + u0, grid.begin() + row + u1,
+						[id] (u16 other) { return other == id; }))
+					break;
+			}
+			for (s16 v = v0; v < v1; v++) {
+				auto row = grid.begin() + (w * side + v) * side;
+				std::fill(row + u0, row + u1, 0);
+			}
+
+			v3s16 pmin, pmax;
+			pmin[axes[0]] = pmax[axes[0]] = w;
+			pmin[axes[1]] = u0;
+			pmax[axes[1]] = u1 - 1;
+			pmin[axes[2]] = v0;
+			pmax[axes[2]] = v1 - 1;
+
+			// The texture is repeated once per node
+			f32 txc[24] = {};
+			txc[face * 4 + 2] = u1 - u0;
+			txc[face * 4 + 3] = v1 - v0;
+
+			const MergeableFace &mf = merge_faces[id - 1];
+			aabb3f box(intToFloat(pmin, BS) - v3f(0.5f * BS),
+					intToFloat(pmax, BS) + v3f(0.5f * BS));
+			auto vertices = setupCuboidVertices(box, txc, &mf.tile, 1, pmin);
+			for (int j = 0; j < 4; j++)
+				vertices[face * 4 + j].Color = mf.color;
+			collector->append(mf.tile, &vertices[face * 4], 4, quad_indices_02, 6);
+		}
+	}
+}
+
+// Nodes that fill a cube of a distant mesh. Smaller things are left out.
+static bool isLodSolid(const ContentFeatures &f)
+{
+	switch (f.drawtype) {
+	case NDT_NORMAL:
+	case NDT_LIQUID:
+	case NDT_FLOWINGLIQUID:
+	case NDT_ALLFACES:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void MapblockMeshGenerator::drawLodMesh()
+{
+	static const v3s16 tile_dirs[6] = {
+		v3s16(0, 1, 0),
+		v3s16(0, -1, 0),
+		v3s16(1, 0, 0),
+		v3s16(-1, 0, 0),
+		v3s16(0, 0, 1),
+		v3s16(0, 0, -1)
+	};
+	struct LodCell {
+		content_t content;
+		bool filled;
+		bool liquid;
+	};
+
+	const s16 lod = data->m_lod;
+	const s16 side = data->m_side_length;
+	const s16 cells = side / lod;
+	assert(cells * lod == side);
+
+	auto get_node = [&] (v3s16 p) {
+		return data->m_vmanip.getNodeNoEx(blockpos_nodes + p);
+	};
+	auto is_liquid = [] (const ContentFeatures &f) {
+		return f.drawtype == NDT_LIQUID || f.drawtype == NDT_FLOWINGLIQUID;
+	};
+
+	// A cell looks like its topmost solid node and is filled if at least
+	// half of its nodes are solid
+	std::vector<LodCell> grid(cells * cells * cells);
+	auto cell_at = [&] (v3s16 c) -> LodCell & {
+		return grid[(c.Z * cells + c.Y) * cells + c.X];
+	};
+	v3s16 c;
+	for (c.Z = 0; c.Z < cells; c.Z++)
+	for (c.Y = 0; c.Y < cells; c.Y++)
+	for (c.X = 0; c.X < cells; c.X++) {
+		const v3s16 nmin = c * lod;
+		const v3s16 nmax = nmin + (lod - 1);
+		u32 known = 0, solid = 0;
+		LodCell cell{CONTENT_IGNORE, false, false};
+		v3s16 p;
+		for (p.Y = nmax.Y; p.Y >= nmin.Y; p.Y--)
+		for (p.Z = nmin.Z; p.Z <= nmax.Z; p.Z++)
+		for (p.X = nmin.X; p.X <= nmax.X; p.X++) {
+			MapNode n = get_node(p);
+			if (n.getContent() == CONTENT_IGNORE)
+				continue;
+			known++;
+			const ContentFeatures &f = nodedef->get(n);
+			if (!isLodSolid(f))
+				continue;
+			if (solid++ == 0) {
+				cell.content = n.getContent();
+				cell.liquid = is_liquid(f);
+			}
+		}
+		cell.filled = solid > 0 && solid * 2 >= known;
+		cell_at(c) = cell;
+	}
+
+	// Brightest light of the nodes from lmin to lmax, for a face of cur_node
+	auto get_color = [&] (v3s16 lmin, v3s16 lmax, v3s16 dir) {
+		u8 light_day = 0, light_night = 0;
+		v3s16 p;
+		for (p.Z = lmin.Z; p.Z <= lmax.Z; p.Z++)
+		for (p.Y = lmin.Y; p.Y <= lmax.Y; p.Y++)
+		for (p.X = lmin.X; p.X <= lmax.X; p.X++) {
+			LightPair light(getFaceLight(cur_node.n, get_node(p), nodedef));
+			light_day = std::max(light_day, light.lightDay);
+			light_night = std::max(light_night, light.lightNight);
+		}
+		video::SColor color = encode_light(LightPair(light_day, light_night),
+				cur_node.f->light_source);
+		if (!cur_node.f->light_source)
+			applyFacesShading(color, intToFloat(dir, 1.0f));
+		return color;
+	};
+
+	// Draws one face of the cube of nodes from pmin to pmax, for cur_node
+	auto draw_face = [&] (v3s16 pmin, v3s16 pmax, int face, video::SColor color,
+			bool backface_culling) {
+		TileSpec tile;
+		getTile(tile_dirs[face], &tile);
+		if (backface_culling) {
+			for (auto &layer : tile.layers)
+				layer.material_flags |= MATERIAL_FLAG_BACKFACE_CULLING;
+		}
+
+		// Repeat the texture once per node where possible
+		f32 txc[24] = {};
+		const f32 repeat = isMergeableTile(tile) ? pmax.X - pmin.X + 1 : 1;
+		txc[face * 4 + 2] = repeat;
+		txc[face * 4 + 3] = repeat;
+
+		const aabb3f box(intToFloat(pmin, BS) - v3f(0.5f * BS),
+				intToFloat(pmax, BS) + v3f(0.5f * BS));
+		auto vertices = setupCuboidVertices(box, txc, &tile, 1, pmin);
+		for (int j = 0; j < 4; j++)
+			vertices[face * 4 + j].Color = color;
+		collector->append(tile, &vertices[face * 4], 4, quad_indices_02, 6);
+	};
+
+	/*
+		The meshes around this one can have any level of detail, so at the
+		border faces are only culled against the actual nodes in front of
+		them. Unknown nodes still hide faces, the mesh is made again once
+		they are loaded.
+		The other meshes might have culled their faces against the solid
+		nodes of this one's border, which an empty cell leaves out. Those
+		nodes get a face on the border instead, facing into this mesh.
+	*/
+	auto hidden_by_nodes = [&] (v3s16 pmin, v3s16 pmax, bool liquid) {
+		v3s16 p;
+		for (p.Z = pmin.Z; p.Z <= pmax.Z; p.Z++)
+		for (p.Y = pmin.Y; p.Y <= pmax.Y; p.Y++)
+		for (p.X = pmin.X; p.X <= pmax.X; p.X++) {
+			MapNode n = get_node(p);
+			if (n.getContent() == CONTENT_IGNORE)
+				continue;
+			const ContentFeatures &f = nodedef->get(n);
+			if (!isLodSolid(f) || (is_liquid(f) && !liquid))
+				return false;
+		}
+		return true;
+	};
+
+	for (c.Z = 0; c.Z < cells; c.Z++)
+	for (c.Y = 0; c.Y < cells; c.Y++)
+	for (c.X = 0; c.X < cells; c.X++) {
+		const LodCell &cell = cell_at(c);
+		const v3s16 pmin = c * lod;
+		const v3s16 pmax = pmin + (lod - 1);
+
+		for (int face = 0; face < 6; face++) {
+			const v3s16 &dir = tile_dirs[face];
+			const v3s16 next_c = c + dir;
+			const bool border = next_c.X < 0 || next_c.Y < 0 || next_c.Z < 0 ||
+					next_c.X >= cells || next_c.Y >= cells || next_c.Z >= cells;
+
+			// The layer of nodes in front of the face
+			v3s16 fmin = pmin, fmax = pmax;
+			for (int axis = 0; axis < 3; axis++) {
+				if (dir[axis] > 0)
+					fmin[axis] = fmax[axis] = pmax[axis] + 1;
+				else if (dir[axis] < 0)
+					fmin[axis] = fmax[axis] = pmin[axis] - 1;
+			}
+
+			if (cell.filled) {
+				if (border) {
+					if (hidden_by_nodes(fmin, fmax, cell.liquid))
+						continue;
+				} else {
+					const LodCell &next = cell_at(next_c);
+					if (next.filled && !(next.liquid && !cell.liquid))
+						continue;
+				}
+				cur_node.p = pmin;
+				cur_node.n = MapNode(cell.content);
+				cur_node.f = &nodedef->get(cur_node.n);
+				draw_face(pmin, pmax, face, get_color(fmin, fmax, dir),
+						cur_node.f->drawtype == NDT_NORMAL);
+				continue;
+			}
+			if (!border)
+				continue;
+
+			// Skirt: the faces towards this mesh of the nodes in front of
+			// the solid ones
+			v3s16 p;
+			for (p.Z = fmin.Z; p.Z <= fmax.Z; p.Z++)
+			for (p.Y = fmin.Y; p.Y <= fmax.Y; p.Y++)
+			for (p.X = fmin.X; p.X <= fmax.X; p.X++) {
+				cur_node.p = p - dir;
+				cur_node.n = get_node(cur_node.p);
+				cur_node.f = &nodedef->get(cur_node.n);
+				if (!isLodSolid(*cur_node.f))
+					continue;
+				// Lit by the empty cell, only visible from inside of it
+				draw_face(p, p, face ^ 1, get_color(pmin, pmax, -dir), true);
+			}
+		}
+	}
+}
+
 u8 MapblockMeshGenerator::getNodeBoxMask(aabb3f box, u8 solid_neighbors, u8 sametype_neighbors) const
 {
 	const f32 NODE_BOUNDARY = 0.5 * BS;
@@ -1830,6 +2186,11 @@ void MapblockMeshGenerator::generate()
 {
 	ZoneScoped;
 
+	if (data->m_lod > 1) {
+		drawLodMesh();
+		return;
+	}
+
 	for (cur_node.p.Z = 0; cur_node.p.Z < data->m_side_length; cur_node.p.Z++)
 	for (cur_node.p.Y = 0; cur_node.p.Y < data->m_side_length; cur_node.p.Y++)
 	for (cur_node.p.X = 0; cur_node.p.X < data->m_side_length; cur_node.p.X++) {
@@ -1837,4 +2198,7 @@ void MapblockMeshGenerator::generate()
 		cur_node.f = &nodedef->get(cur_node.n);
 		drawNode();
 	}
+
+	if (data->m_merge_faces)
+		drawMergedFaces();
 }
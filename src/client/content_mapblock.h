@@ -166,6 +166,23 @@ class MapblockMeshGenerator
 	void drawNodeboxNode();
 	void drawMeshNode();
 
+// face merging
+	struct MergeableFace {
+		TileSpec tile;
+		video::SColor color;
+	};
+	// Distinct looks of the faces to merge
+	std::vector<MergeableFace> merge_faces;
+	// For every face direction and node, 0 if there is no face to merge,
+	// else the index in merge_faces plus one
+	std::vector<u16> merge_grid[6];
+
+	bool addMergeableFace(int face, const TileSpec &tile, video::SColor color);
+	void drawMergedFaces();
+
+// distant meshes
+	void drawLodMesh();
+
 // common
 	void errorUnknownDrawtype();
 	void drawNode();
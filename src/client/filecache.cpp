@@ -78,6 +78,12 @@ bool FileCache::exists(const std::string &name)
 	return fs::PathExists(path);
 }
 
+bool FileCache::remove(const std::string &name)
+{
+	std::string path = m_dir + DIR_DELIM + name;
+	return fs::DeleteSingleFileOrEmptyDirectory(path);
+}
+
 bool FileCache::updateCopyFile(const std::string &name, const std::string &src_path)
 {
 	std::string path = m_dir + DIR_DELIM + name;
@@ -20,6 +20,7 @@ class FileCache
 	bool update(const std::string &name, std::string_view data);
 	bool load(const std::string &name, std::ostream &os);
 	bool exists(const std::string &name);
+	bool remove(const std::string &name);
 
 	// Copy another file on disk into the cache
 	bool updateCopyFile(const std::string &name, const std::string &src_path);
@@ -15,6 +15,7 @@
 #include "util/base64.h"
 #include "util/numeric.h"
 #include "util/strfnd.h"
+#include <cstring>
 
 
 ////////////////////////////////
@@ -123,22 +124,6 @@ static inline void blit_with_alpha(video::IImage *src, video::IImage *dst,
 	blit_with_alpha2<overlay>(src, dst, v2s32(), dst_pos, size);
 }
 
-// Apply a color to an image.  Uses an int (0-255) to calculate the ratio.
-// If the ratio is 255 or -1 and keep_alpha is true, then it multiples the
-// color alpha with the destination alpha.
-// Otherwise, any pixels that are not fully transparent get the color alpha.
-static void apply_colorize(video::IImage *dst, v2u32 dst_pos, v2u32 size,
-		const video::SColor color, int ratio, bool keep_alpha);
-
-// paint a texture using the given color
-static void apply_multiplication(video::IImage *dst, v2u32 dst_pos, v2u32 size,
-		const video::SColor color);
-
-// Perform a Screen blend with the given color. The opposite effect of a
-// Multiply blend.
-static void apply_screen(video::IImage *dst, v2u32 dst_pos, v2u32 size,
-		const video::SColor color);
-
 // Adjust the hue, saturation, and lightness of destination. Like
 // "Hue-Saturation" in GIMP.
 // If colorize is true then the image will be converted to a grayscale
@@ -146,24 +131,6 @@ static void apply_screen(video::IImage *dst, v2u32 dst_pos, v2u32 size,
 static void apply_hue_saturation(video::IImage *dst, v2u32 dst_pos, v2u32 size,
 		s32 hue, s32 saturation, s32 lightness, bool colorize);
 
-// Apply an overlay blend to an images.
-// Overlay blend combines Multiply and Screen blend modes.The parts of the top
-// layer where the base layer is light become lighter, the parts where the base
-// layer is dark become darker.Areas where the base layer are mid grey are
-// unaffected.An overlay with the same picture looks like an S - curve.
-static void apply_overlay(video::IImage *overlay, video::IImage *dst,
-		v2s32 overlay_pos, v2s32 dst_pos, v2u32 size, bool hardlight);
-
-// Adjust the brightness and contrast of the base image. Conceptually like
-// "Brightness-Contrast" in GIMP but allowing brightness to be wound all the
-// way up to white or down to black.
-static void apply_brightness_contrast(video::IImage *dst, v2u32 dst_pos, v2u32 size,
-		s32 brightness, s32 contrast);
-
-// Apply a mask to an image
-static void apply_mask(video::IImage *mask, video::IImage *dst,
-		v2s32 mask_pos, v2s32 dst_pos, v2u32 size);
-
 // Draw or overlay a crack
 static void draw_crack(video::IImage *crack, video::IImage *dst,
 		bool use_overlay, s32 frame_count, s32 progression,
@@ -416,6 +383,79 @@ void blit_pixel(video::SColor src_col, video::SColor &dst_col)
 	dst_col.set(dst_a, dst.r, dst.g, dst.b);
 }
 
+/*
+	The pixels of an ECF_A8R8G8B8 image, if the area is inside of it.
+	Nearly all images generateImage() works on have this format.
+*/
+video::SColor *get_pixels(video::IImage *img, v2s32 pos, v2u32 size)
+{
+	const core::dimension2du dim = img->getDimension();
+	if (img->getColorFormat() != video::ECF_A8R8G8B8 || pos.X < 0 || pos.Y < 0 ||
+			pos.X + size.X > dim.Width || pos.Y + size.Y > dim.Height)
+		return nullptr;
+	return reinterpret_cast<video::SColor *>(img->getData());
+}
+
+/*
+	Calls f(video::SColor &) for every pixel in the area of the image.
+	The pixels are accessed directly if possible, instead of through the
+	virtual getPixel() and setPixel(), so that the loop can be vectorized.
+*/
+template <typename F>
+void for_each_pixel(video::IImage *img, v2u32 pos, v2u32 size, F &&f)
+{
+	if (video::SColor *pixels = get_pixels(img, v2s32::from(pos), size)) {
+		const u32 width = img->getDimension().Width;
+		for (u32 y = pos.Y; y < pos.Y + size.Y; y++) {
+			video::SColor *row = pixels + (size_t)y * width;
+			for (u32 x = pos.X; x < pos.X + size.X; x++)
+				f(row[x]);
+		}
+		return;
+	}
+
+	for (u32 y = pos.Y; y < pos.Y + size.Y; y++)
+	for (u32 x = pos.X; x < pos.X + size.X; x++) {
+		video::SColor c = img->getPixel(x, y);
+		f(c);
+		img->setPixel(x, y, c);
+	}
+}
+
+/*
+	Calls f(video::SColor src_c, video::SColor &dst_c) for every pixel in
+	the areas of both images, like for_each_pixel().
+*/
+template <typename F>
+void for_each_pixel_pair(video::IImage *src, video::IImage *dst,
+	v2s32 src_pos, v2s32 dst_pos, v2u32 size, F &&f)
+{
+	video::SColor *pixels_src = get_pixels(src, src_pos, size);
+	video::SColor *pixels_dst = get_pixels(dst, dst_pos, size);
+	if (pixels_src && pixels_dst) {
+		const u32 src_width = src->getDimension().Width;
+		const u32 dst_width = dst->getDimension().Width;
+		for (u32 y0 = 0; y0 < size.Y; y0++) {
+			const video::SColor *row_src = pixels_src +
+				(size_t)(src_pos.Y + y0) * src_width + src_pos.X;
+			video::SColor *row_dst = pixels_dst +
+				(size_t)(dst_pos.Y + y0) * dst_width + dst_pos.X;
+			for (u32 x0 = 0; x0 < size.X; x0++)
+				f(row_src[x0], row_dst[x0]);
+		}
+		return;
+	}
+
+	for (u32 y0 = 0; y0 < size.Y; y0++)
+	for (u32 x0 = 0; x0 < size.X; x0++) {
+		s32 dst_x = x0 + dst_pos.X;
+		s32 dst_y = y0 + dst_pos.Y;
+		video::SColor dst_c = dst->getPixel(dst_x, dst_y);
+		f(src->getPixel(x0 + src_pos.X, y0 + src_pos.Y), dst_c);
+		dst->setPixel(dst_x, dst_y, dst_c);
+	}
+}
+
 }  // namespace (anonymous)
 
 template<bool overlay>
@@ -482,81 +522,68 @@ static void blit_with_alpha2(video::IImage *src, video::IImage *dst,
 /*
 	Apply color to destination, using a weighted interpolation blend
 */
-static void apply_colorize(video::IImage *dst, v2u32 dst_pos, v2u32 size,
+void apply_colorize(video::IImage *dst, v2u32 dst_pos, v2u32 size,
 		const video::SColor color, int ratio, bool keep_alpha)
 {
 	u32 alpha = color.getAlpha();
-	video::SColor dst_c;
 	if ((ratio == -1 && alpha == 255) || ratio == 255) { // full replacement of color
 		if (keep_alpha) { // replace the color with alpha = dest alpha * color alpha
-			dst_c = color;
-			for (u32 y = dst_pos.Y; y < dst_pos.Y + size.Y; y++)
-			for (u32 x = dst_pos.X; x < dst_pos.X + size.X; x++) {
-				u32 dst_alpha = dst->getPixel(x, y).getAlpha();
+			for_each_pixel(dst, dst_pos, size, [&] (video::SColor &dst_c) {
+				u32 dst_alpha = dst_c.getAlpha();
 				if (dst_alpha > 0) {
+					dst_c = color;
 					dst_c.setAlpha(dst_alpha * alpha / 255);
-					dst->setPixel(x, y, dst_c);
 				}
-			}
+			});
 		} else { // replace the color including the alpha
-			for (u32 y = dst_pos.Y; y < dst_pos.Y + size.Y; y++)
-			for (u32 x = dst_pos.X; x < dst_pos.X + size.X; x++)
-				if (dst->getPixel(x, y).getAlpha() > 0)
-					dst->setPixel(x, y, color);
+			for_each_pixel(dst, dst_pos, size, [&] (video::SColor &dst_c) {
+				if (dst_c.getAlpha() > 0)
+					dst_c = color;
+			});
 		}
 	} else {  // interpolate between the color and destination
 		float interp = (ratio == -1 ? color.getAlpha() / 255.0f : ratio / 255.0f);
-		for (u32 y = dst_pos.Y; y < dst_pos.Y + size.Y; y++)
-		for (u32 x = dst_pos.X; x < dst_pos.X + size.X; x++) {
-			dst_c = dst->getPixel(x, y);
-			if (dst_c.getAlpha() > 0) {
+		for_each_pixel(dst, dst_pos, size, [&] (video::SColor &dst_c) {
+			if (dst_c.getAlpha() > 0)
 				dst_c = color.getInterpolated(dst_c, interp);
-				dst->setPixel(x, y, dst_c);
-			}
-		}
+		});
 	}
 }
 
 /*
 	Apply color to destination, using a Multiply blend mode
 */
-static void apply_multiplication(video::IImage *dst, v2u32 dst_pos, v2u32 size,
+void apply_multiplication(video::IImage *dst, v2u32 dst_pos, v2u32 size,
 		const video::SColor color)
 {
-	video::SColor dst_c;
+	const u32 r = color.getRed(), g = color.getGreen(), b = color.getBlue();
 
-	for (u32 y = dst_pos.Y; y < dst_pos.Y + size.Y; y++)
-	for (u32 x = dst_pos.X; x < dst_pos.X + size.X; x++) {
-		dst_c = dst->getPixel(x, y);
+	for_each_pixel(dst, dst_pos, size, [&] (video::SColor &dst_c) {
 		dst_c.set(
 				dst_c.getAlpha(),
-				(dst_c.getRed() * color.getRed()) / 255,
-				(dst_c.getGreen() * color.getGreen()) / 255,
-				(dst_c.getBlue() * color.getBlue()) / 255
+				(dst_c.getRed() * r) / 255,
+				(dst_c.getGreen() * g) / 255,
+				(dst_c.getBlue() * b) / 255
 				);
-		dst->setPixel(x, y, dst_c);
-	}
+	});
 }
 
 /*
 	Apply color to destination, using a Screen blend mode
 */
-static void apply_screen(video::IImage *dst, v2u32 dst_pos, v2u32 size,
+void apply_screen(video::IImage *dst, v2u32 dst_pos, v2u32 size,
 		const video::SColor color)
 {
-	video::SColor dst_c;
+	const u32 r = color.getRed(), g = color.getGreen(), b = color.getBlue();
 
-	for (u32 y = dst_pos.Y; y < dst_pos.Y + size.Y; y++)
-	for (u32 x = dst_pos.X; x < dst_pos.X + size.X; x++) {
-		dst_c = dst->getPixel(x, y);
+	for_each_pixel(dst, dst_pos, size, [&] (video::SColor &dst_c) {
 		dst_c.set(
 			dst_c.getAlpha(),
-			255 - ((255 - dst_c.getRed())   * (255 - color.getRed()))   / 255,
-			255 - ((255 - dst_c.getGreen()) * (255 - color.getGreen())) / 255,
-			255 - ((255 - dst_c.getBlue())  * (255 - color.getBlue()))  / 255
+			255 - ((255 - dst_c.getRed())   * (255 - r)) / 255,
+			255 - ((255 - dst_c.getGreen()) * (255 - g)) / 255,
+			255 - ((255 - dst_c.getBlue())  * (255 - b)) / 255
 		);
-		dst->setPixel(x, y, dst_c);
-	}
+	});
 }
 
 /*
@@ -639,22 +666,11 @@ static void apply_hue_saturation(video::IImage *dst, v2u32 dst_pos, v2u32 size,
 	Apply an Overlay blend to destination
 	If hardlight is true then swap the dst & blend images (a hardlight blend)
 */
-static void apply_overlay(video::IImage *blend, video::IImage *dst,
+void apply_overlay(video::IImage *blend, video::IImage *dst,
 	v2s32 blend_pos, v2s32 dst_pos, v2u32 size, bool hardlight)
 {
-	video::IImage *blend_layer = hardlight ? dst : blend;
-	video::IImage *base_layer  = hardlight ? blend : dst;
-	v2s32 blend_layer_pos = hardlight ? dst_pos : blend_pos;
-	v2s32 base_layer_pos  = hardlight ? blend_pos : dst_pos;
-
-	for (u32 y = 0; y < size.Y; y++)
-	for (u32 x = 0; x < size.X; x++) {
-		s32 base_x = x + base_layer_pos.X;
-		s32 base_y = y + base_layer_pos.Y;
-
-		video::SColor blend_c =
-			blend_layer->getPixel(x + blend_layer_pos.X, y + blend_layer_pos.Y);
-		video::SColor base_c = base_layer->getPixel(base_x, base_y);
+	// The result keeps the alpha of the base layer
+	auto overlay = [] (video::SColor base_c, video::SColor blend_c) {
 		f32 blend_r = blend_c.getRed()   / 255.0f;
 		f32 blend_g = blend_c.getGreen() / 255.0f;
 		f32 blend_b = blend_c.getBlue()  / 255.0f;
@@ -669,8 +685,15 @@ static void apply_overlay(video::IImage *blend, video::IImage *dst,
 			(u32)((base_g < 0.5f ? 2 * base_g * blend_g : 1 - 2 * (1 - base_g) * (1 - blend_g)) * 255),
 			(u32)((base_b < 0.5f ? 2 * base_b * blend_b : 1 - 2 * (1 - base_b) * (1 - blend_b)) * 255)
 		);
-		dst->setPixel(base_x, base_y, base_c);
-	}
+		return base_c;
+	};
+
+	// Hardlight only swaps the layers, the result is always written to dst
+	assert(!hardlight || blend_pos == dst_pos);
+	for_each_pixel_pair(blend, dst, blend_pos, dst_pos, size,
+		[&] (video::SColor blend_c, video::SColor &dst_c) {
+			dst_c = hardlight ? overlay(blend_c, dst_c) : overlay(dst_c, blend_c);
+		});
 }
 
 /*
@@ -679,7 +702,7 @@ static void apply_overlay(video::IImage *blend, video::IImage *dst,
 	Conceptually like GIMP's "Brightness-Contrast" feature but allows brightness to be
 	wound all the way up to white or down to black.
 */
-static void apply_brightness_contrast(video::IImage *dst, v2u32 dst_pos, v2u32 size,
+void apply_brightness_contrast(video::IImage *dst, v2u32 dst_pos, v2u32 size,
 	s32 brightness, s32 contrast)
 {
 	// Only allow normalized contrast to get as high as 127/128 to avoid infinite slope.
@@ -713,39 +736,26 @@ static void apply_brightness_contrast(video::IImage *dst, v2u32 dst_pos, v2u32 s
 	// rounded rather than trunc'd.
 	c += 0.5f;
 
-	video::SColor dst_c;
-	for (u32 y = dst_pos.Y; y < dst_pos.Y + size.Y; y++)
-	for (u32 x = dst_pos.X; x < dst_pos.X + size.X; x++) {
-		dst_c = dst->getPixel(x, y);
-
+	for_each_pixel(dst, dst_pos, size, [&] (video::SColor &dst_c) {
 		dst_c.set(
 			dst_c.getAlpha(),
 			core::clamp((int)(slope * dst_c.getRed()   + c), 0, 255),
 			core::clamp((int)(slope * dst_c.getGreen() + c), 0, 255),
 			core::clamp((int)(slope * dst_c.getBlue()  + c), 0, 255)
 		);
-		dst->setPixel(x, y, dst_c);
-	}
+	});
 }
 
 /*
 	Apply mask to destination
 */
-static void apply_mask(video::IImage *mask, video::IImage *dst,
+void apply_mask(video::IImage *mask, video::IImage *dst,
 		v2s32 mask_pos, v2s32 dst_pos, v2u32 size)
 {
-	for (u32 y0 = 0; y0 < size.Y; y0++) {
-		for (u32 x0 = 0; x0 < size.X; x0++) {
-			s32 mask_x = x0 + mask_pos.X;
-			s32 mask_y = y0 + mask_pos.Y;
-			s32 dst_x = x0 + dst_pos.X;
-			s32 dst_y = y0 + dst_pos.Y;
-			video::SColor mask_c = mask->getPixel(mask_x, mask_y);
-			video::SColor dst_c = dst->getPixel(dst_x, dst_y);
+	for_each_pixel_pair(mask, dst, mask_pos, dst_pos, size,
+		[] (video::SColor mask_c, video::SColor &dst_c) {
 			dst_c.color &= mask_c.color;
-			dst->setPixel(dst_x, dst_y, dst_c);
-		}
-	}
+		});
 }
 
 static video::IImage *create_crack_image(video::IImage *crack, s32 frame_index,
@@ -1859,7 +1869,7 @@ video::IImage* ImageSource::generateImage(std::string_view name,
 		using a recursive call.
 	*/
 	if (last_separator_pos != -1) {
-		baseimg = generateImage(name.substr(0, last_separator_pos), source_image_names);
+		baseimg = generateBaseImage(name.substr(0, last_separator_pos), source_image_names);
 	}
 
 	/*
@@ -1918,7 +1928,55 @@ video::IImage* ImageSource::generateImage(std::string_view name,
 	return baseimg;
 }
 
+video::IImage *ImageSource::generateBaseImage(std::string_view name,
+		std::set<std::string> &source_image_names)
+{
+	// About 16 MB
+	constexpr u32 MAX_CACHE_PIXELS = 4 * 1024 * 1024;
+
+	// Single source images are cached as such already
+	if (name.find('^') == std::string_view::npos)
+		return generateImage(name, source_image_names);
+
+	video::IVideoDriver *driver = RenderingEngine::get_video_driver();
+	auto copy_image = [driver] (video::IImage *img) {
+		video::IImage *copy = driver->createImage(img->getColorFormat(), img->getDimension());
+		memcpy(copy->getData(), img->getData(), img->getImageDataSizeInBytes());
+		return copy;
+	};
+
+	std::string name_s(name);
+	auto it = m_base_cache.find(name_s);
+	if (it != m_base_cache.end()) {
+		source_image_names.insert(it->second.source_image_names.begin(),
+			it->second.source_image_names.end());
+		return copy_image(it->second.image.get());
+	}
+
+	std::set<std::string> names;
+	video::IImage *img = generateImage(name, names);
+	source_image_names.insert(names.begin(), names.end());
+	if (!img)
+		return nullptr;
+
+	const core::dimension2du dim = img->getDimension();
+	const u32 pixels = dim.Width * dim.Height;
+	if (pixels > MAX_CACHE_PIXELS / 64)
+		return img;
+	if (m_base_cache_pixels + pixels > MAX_CACHE_PIXELS) {
+		m_base_cache.clear();
+		m_base_cache_pixels = 0;
+	}
+	m_base_cache[name_s] = CachedImage{irr_ptr<video::IImage>(copy_image(img)),
+		std::move(names)};
+	m_base_cache_pixels += pixels;
+	return img;
+}
+
 void ImageSource::insertSourceImage(const std::string &name, video::IImage *img, bool prefer_local)
 {
 	m_sourcecache.insert(name, img, prefer_local);
+	// Base images might be made of the old one
+	m_base_cache.clear();
+	m_base_cache_pixels = 0;
 }
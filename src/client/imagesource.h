@@ -5,6 +5,8 @@
 #pragma once
 
 #include <IImage.h>
+#include "irr_ptr.h"
+#include "irr_v2d.h"
 #include <unordered_map>
 #include <set>
 #include <string>
@@ -30,6 +32,43 @@ class SourceImageCache {
 	std::unordered_map<std::string, video::IImage*> m_images;
 };
 
+// Texture modifiers that work on an area of an image.
+// The areas have to be inside of the images.
+
+// Apply a color to an image.  Uses an int (0-255) to calculate the ratio.
+// If the ratio is 255 or -1 and keep_alpha is true, then it multiples the
+// color alpha with the destination alpha.
+// Otherwise, any pixels that are not fully transparent get the color alpha.
+void apply_colorize(video::IImage *dst, v2u32 dst_pos, v2u32 size,
+		const video::SColor color, int ratio, bool keep_alpha);
+
+// paint a texture using the given color
+void apply_multiplication(video::IImage *dst, v2u32 dst_pos, v2u32 size,
+		const video::SColor color);
+
+// Perform a Screen blend with the given color. The opposite effect of a
+// Multiply blend.
+void apply_screen(video::IImage *dst, v2u32 dst_pos, v2u32 size,
+		const video::SColor color);
+
+// Apply an overlay blend to an images.
+// Overlay blend combines Multiply and Screen blend modes.The parts of the top
+// layer where the base layer is light become lighter, the parts where the base
+// layer is dark become darker.Areas where the base layer are mid grey are
+// unaffected.An overlay with the same picture looks like an S - curve.
+void apply_overlay(video::IImage *overlay, video::IImage *dst,
+		v2s32 overlay_pos, v2s32 dst_pos, v2u32 size, bool hardlight);
+
+// Adjust the brightness and contrast of the base image. Conceptually like
+// "Brightness-Contrast" in GIMP but allowing brightness to be wound all the
+// way up to white or down to black.
+void apply_brightness_contrast(video::IImage *dst, v2u32 dst_pos, v2u32 size,
+		s32 brightness, s32 contrast);
+
+// Apply a mask to an image
+void apply_mask(video::IImage *mask, video::IImage *dst,
+		v2s32 mask_pos, v2s32 dst_pos, v2u32 size);
+
 // Generates images using texture modifiers, and caches source images.
 struct ImageSource {
 	ImageSource();
@@ -58,6 +97,11 @@ struct ImageSource {
 	bool generateImagePart(std::string_view part_of_name, video::IImage *& baseimg,
 			std::set<std::string> &source_image_names);
 
+	// Like generateImage(), for the part of a name before the last '^'.
+	// Looks it up in m_base_cache first, if it has modifiers of its own.
+	video::IImage *generateBaseImage(std::string_view name,
+			std::set<std::string> &source_image_names);
+
 	// Cached settings needed for making textures from meshes
 	bool m_setting_mipmap;
 	bool m_setting_trilinear_filter;
@@ -66,4 +110,19 @@ struct ImageSource {
 
 	// Cache of source images
 	SourceImageCache m_sourcecache;
+
+	/*
+		Cache of base images, i.e. of everything before the last '^', if
+		that is made of more than one part itself. E.g. all of
+		"default_dirt.png^default_grass_side.png^[colorize:<color>" share
+		"default_dirt.png^default_grass_side.png". Plain source images like
+		"wool.png" are not kept here, m_sourcecache has them already.
+		Cleared when it exceeds its size or a source image changes.
+	*/
+	struct CachedImage {
+		irr_ptr<video::IImage> image;
+		std::set<std::string> source_image_names;
+	};
+	std::unordered_map<std::string, CachedImage> m_base_cache;
+	u32 m_base_cache_pixels = 0;
 };
@@ -278,6 +278,32 @@ u16 getSmoothLightTransparent(const v3s16 &p, const v3s16 &corner, MeshMakeData
 	return getSmoothLightCombined(p, dirs, data);
 }
 
+u8 getMeshLod(v3s16 mesh_pos, const MeshGrid &mesh_grid, v3s16 camera_pos,
+	u16 lod_distance, u8 current_lod)
+{
+	if (lod_distance == 0)
+		return 1;
+	const f32 half_size = mesh_grid.cell_size * MAP_BLOCKSIZE * 0.5f;
+	const v3f center = intToFloat(mesh_pos * MAP_BLOCKSIZE, 1.0f) + half_size;
+	f32 distance = center.getDistanceFrom(intToFloat(camera_pos, 1.0f));
+
+	const auto lod_at = [lod_distance] (f32 d) -> u8 {
+		if (d < lod_distance)
+			return 1;
+		if (d < 2 * lod_distance)
+			return 2;
+		return 4;
+	};
+
+	// Only switch once the camera is a block past the border, so that
+	// moving along it does not remake the same meshes over and over
+	const u8 lod = lod_at(distance);
+	if (current_lod == 0 || lod == current_lod)
+		return lod;
+	distance += lod > current_lod ? -MAP_BLOCKSIZE : MAP_BLOCKSIZE;
+	return lod_at(distance);
+}
+
 void get_sunlight_color(video::SColorf *sunlight, u32 daynight_ratio)
 {
 	f32 rg = daynight_ratio / 1000.0f - 0.04f;
@@ -629,9 +655,16 @@ static void applyColorAndMerge(std::vector<PreMeshBuffer> &prebuffers)
 }
 
 MapBlockMesh::MapBlockMesh(Client *client, MeshMakeData *data):
-	m_tsrc(client->getTextureSource()),
-	m_shdrsrc(client->getShaderSource()),
+	MapBlockMesh(client->getTextureSource(), client->getShaderSource(), data)
+{
+}
+
+MapBlockMesh::MapBlockMesh(ITextureSource *tsrc, IShaderSource *shdrsrc,
+		MeshMakeData *data):
+	m_tsrc(tsrc),
+	m_shdrsrc(shdrsrc),
 	m_bounding_sphere_center((data->m_side_length * 0.5f - 0.5f) * BS),
+	m_lod(data->m_lod),
 	m_animation_force_timer(0), // force initial animation
 	m_last_crack(-1)
 {
@@ -665,7 +698,10 @@ MapBlockMesh::MapBlockMesh(Client *client, MeshMakeData *data):
 	// algin vertices to mesh grid, not meshgen area
 	v3f offset = intToFloat((data->m_blockpos - mesh_grid.getMeshPos(data->m_blockpos)) * MAP_BLOCKSIZE, BS);
 
-	MeshCollector collector(m_bounding_sphere_center, offset);
+	// Meshes are made over and over by the same threads, so the buffers of
+	// the previous mesh are filled again instead of growing new ones
+	thread_local PreMeshBufferPool buffer_pool;
+	MeshCollector collector(m_bounding_sphere_center, offset, &buffer_pool);
 
 	{
 		// Generate everything
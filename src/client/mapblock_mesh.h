@@ -48,6 +48,11 @@ struct MeshMakeData
 	bool m_generate_minimap = false;
 	bool m_smooth_lighting = false;
 	bool m_enable_water_reflections = false;
+	// merge faces of solid nodes that look the same into larger quads
+	bool m_merge_faces = false;
+	// level of detail: 1 is full detail, else cubes of this many nodes
+	// along each axis are drawn as one (see getMeshLod())
+	u8 m_lod = 1;
 
 	const NodeDefManager *m_nodedef;
 
@@ -177,6 +182,8 @@ class MapBlockMesh
 public:
 	// Builds the mesh given
 	MapBlockMesh(Client *client, MeshMakeData *data);
+	// Same, without a client (for benchmarks)
+	MapBlockMesh(ITextureSource *tsrc, IShaderSource *shdrsrc, MeshMakeData *data);
 	~MapBlockMesh();
 
 	// Main animation function, parameters:
@@ -236,6 +243,9 @@ class MapBlockMesh
 	/// Radius of the bounding-sphere, in BS-space.
 	f32 getBoundingRadius() const { return m_bounding_radius; }
 
+	/// Level of detail the mesh was made with, see MeshMakeData::m_lod
+	u8 getLod() const { return m_lod; }
+
 	/// Center of the bounding-sphere, in BS-space, relative to block pos.
 	v3f getBoundingSphereCenter() const { return m_bounding_sphere_center; }
 
@@ -285,6 +295,8 @@ class MapBlockMesh
 	f32 m_bounding_radius;
 	v3f m_bounding_sphere_center;
 
+	u8 m_lod;
+
 	// Must animate() be called before rendering?
 	bool m_has_animation;
 	int m_animation_force_timer;
@@ -329,6 +341,19 @@ u16 getFaceLight(MapNode n, MapNode n2, const NodeDefManager *ndef);
 u16 getSmoothLightSolid(const v3s16 &p, const v3s16 &face_dir, const v3s16 &corner, MeshMakeData *data);
 u16 getSmoothLightTransparent(const v3s16 &p, const v3s16 &corner, MeshMakeData *data);
 
+/*!
+ * Returns the level of detail a mesh should be made with.
+ *
+ * \param mesh_pos position of the mesh, in blocks
+ * \param camera_pos position of the camera, in nodes
+ * \param lod_distance distance from which on meshes are made at half
+ * resolution, and at a quarter from twice that. 0 means always full detail.
+ * \param current_lod level of the existing mesh, or 0 if there is none. The
+ * level only changes once the camera is MAP_BLOCKSIZE nodes past the border.
+ */
+u8 getMeshLod(v3s16 mesh_pos, const MeshGrid &mesh_grid, v3s16 camera_pos,
+	u16 lod_distance, u8 current_lod = 0);
+
 /*!
  * Returns the sunlight's color from the current
  * day-night ratio.
@@ -91,6 +91,8 @@ MeshUpdateQueue::MeshUpdateQueue(Client *client):
 {
 	m_cache_smooth_lighting = g_settings->getBool("smooth_lighting");
 	m_cache_enable_water_reflections = g_settings->getBool("enable_water_reflections");
+	m_cache_merge_faces = g_settings->getBool("mesh_merge_faces");
+	m_cache_lod_distance = g_settings->getU16("mesh_lod_distance");
 }
 
 MeshUpdateQueue::~MeshUpdateQueue()
@@ -116,8 +118,16 @@ bool MeshUpdateQueue::addBlock(Map *map, v3s16 p, bool ack_block_to_server,
 	// (where all coordinate are divisible by the chunk size)
 	const v3s16 mesh_position = mesh_grid.getMeshPos(p);
 
+	// Keep the level of the existing mesh near the borders, like ClientMap does
+	u8 current_lod = 0;
+	if (MapBlock *mesh_block = map->getBlockNoCreateNoEx(mesh_position); mesh_block && mesh_block->mesh)
+		current_lod = mesh_block->mesh->getLod();
+
 	MutexAutoLock lock(m_mutex);
 
+	const u8 lod = getMeshLod(mesh_position, mesh_grid, m_camera_pos,
+		m_cache_lod_distance, current_lod);
+
 	/*
 		Mark the block as urgent if requested
 	*/
@@ -135,6 +145,7 @@ bool MeshUpdateQueue::addBlock(Map *map, v3s16 p, bool ack_block_to_server,
 			q->crack_level = m_client->getCrackLevel();
 			q->crack_pos = m_client->getCrackPos();
 			q->urgent |= urgent;
+			q->lod = lod;
 			q->retrieveBlocks(map, mesh_grid.cell_size);
 			return true;
 		}
@@ -150,6 +161,7 @@ bool MeshUpdateQueue::addBlock(Map *map, v3s16 p, bool ack_block_to_server,
 	q->crack_level = m_client->getCrackLevel();
 	q->crack_pos = m_client->getCrackPos();
 	q->urgent = urgent;
+	q->lod = lod;
 	q->retrieveBlocks(map, mesh_grid.cell_size);
 
 	/*
@@ -225,6 +237,8 @@ void MeshUpdateQueue::fillDataFromMapBlocks(QueuedMeshUpdate *q)
 	data->m_generate_minimap = !!m_client->getMinimap();
 	data->m_smooth_lighting = m_cache_smooth_lighting;
 	data->m_enable_water_reflections = m_cache_enable_water_reflections;
+	data->m_merge_faces = m_cache_merge_faces;
+	data->m_lod = q->lod;
 }
 
 /*
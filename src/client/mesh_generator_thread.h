@@ -28,6 +28,7 @@ struct QueuedMeshUpdate
 	MeshMakeData *data = nullptr; // This is generated in MeshUpdateQueue::pop()
 	std::vector<MapBlock*> map_blocks;
 	bool urgent = false;
+	u8 lod = 1;
 
 	QueuedMeshUpdate() = default;
 	~QueuedMeshUpdate();
@@ -87,6 +88,13 @@ class MeshUpdateQueue
 	// Marks a position as finished, unblocking the next update
 	void done(v3s16 pos);
 
+	// Sets where the level of detail of new updates is measured from
+	void setCameraPos(v3s16 camera_pos)
+	{
+		MutexAutoLock lock(m_mutex);
+		m_camera_pos = camera_pos;
+	}
+
 	size_t size()
 	{
 		MutexAutoLock lock(m_mutex);
@@ -103,6 +111,11 @@ class MeshUpdateQueue
 	// TODO: Add callback to update these when g_settings changes, and update all meshes
 	bool m_cache_smooth_lighting;
 	bool m_cache_enable_water_reflections;
+	bool m_cache_merge_faces;
+	u16 m_cache_lod_distance;
+
+	// in nodes
+	v3s16 m_camera_pos;
 
 	void fillDataFromMapBlocks(QueuedMeshUpdate *q);
 };
@@ -148,6 +161,8 @@ class MeshUpdateManager
 	void updateBlock(Map *map, v3s16 p, bool ack_block_to_server, bool urgent,
 			bool update_neighbors = false);
 	void putResult(const MeshUpdateResult &r);
+	/// @param camera_pos in nodes
+	void setCameraPos(v3s16 camera_pos) { m_queue_in.setCameraPos(camera_pos); }
 	/// @note caller needs to refDrop() the affected map_blocks
 	bool getNextResult(MeshUpdateResult &r);
 
@@ -51,6 +51,40 @@ void MeshCollector::append(const TileLayer &layer, const video::S3DVertex *verti
 		p.indices.push_back(indices[i] + vertex_count);
 }
 
+PreMeshBuffer PreMeshBufferPool::get(const TileLayer &layer)
+{
+	if (m_free.empty())
+		return PreMeshBuffer(layer);
+	PreMeshBuffer p = std::move(m_free.back());
+	m_free.pop_back();
+	p.layer = layer;
+	p.indices.clear();
+	p.vertices.clear();
+	return p;
+}
+
+void PreMeshBufferPool::put(std::vector<PreMeshBuffer> &buffers)
+{
+	// Enough for the materials of a typical block, without holding on to
+	// more memory than a few full buffers take
+	constexpr size_t max_free = 32;
+	for (PreMeshBuffer &p : buffers) {
+		if (m_free.size() >= max_free)
+			break;
+		if (p.vertices.capacity() > 0)
+			m_free.push_back(std::move(p));
+	}
+	buffers.clear();
+}
+
+MeshCollector::~MeshCollector()
+{
+	if (!m_pool)
+		return;
+	for (auto &buffers : prebuffers)
+		m_pool->put(buffers);
+}
+
 PreMeshBuffer &MeshCollector::findBuffer(
 		const TileLayer &layer, u8 layernum, u32 numVertices)
 {
@@ -58,9 +92,18 @@ PreMeshBuffer &MeshCollector::findBuffer(
 		throw std::invalid_argument(
 				"Mesh can't contain more than 65536 vertices");
 	std::vector<PreMeshBuffer> &buffers = prebuffers[layernum];
-	for (PreMeshBuffer &p : buffers)
-		if (p.layer == layer && p.vertices.size() + numVertices <= U16_MAX)
-			return p;
-	buffers.emplace_back(layer);
-	return buffers.back();
+	size_t &last = m_last_index[layernum];
+	if (last < buffers.size() && buffers[last].layer == layer &&
+			buffers[last].vertices.size() + numVertices <= U16_MAX)
+		return buffers[last];
+
+	// Full buffers are never looked at again, so the index only needs to
+	// know the last buffer for each material.
+	auto [it, inserted] = m_buffer_index[layernum].try_emplace(layer, buffers.size());
+	if (!inserted && buffers[it->second].vertices.size() + numVertices > U16_MAX)
+		it->second = buffers.size();
+	if (it->second == buffers.size())
+		buffers.push_back(m_pool ? m_pool->get(layer) : PreMeshBuffer(layer));
+	last = it->second;
+	return buffers[last];
 }
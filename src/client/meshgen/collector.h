@@ -4,8 +4,10 @@
 
 #pragma once
 #include <array>
+#include <unordered_map>
 #include <vector>
 #include "irrlichttypes.h"
+#include "util/basic_macros.h"
 #include "irr_v3d.h"
 #include <S3DVertex.h>
 #include "client/tile.h"
@@ -43,6 +45,20 @@ struct PreMeshBuffer
 	bool append(const PreMeshBuffer &other);
 };
 
+/// @brief Keeps the storage of finished buffers for the next collector
+/// @note Not thread-safe, meant to be kept per thread
+struct PreMeshBufferPool
+{
+	/// @brief Returns an empty buffer, reusing a previous one if possible
+	PreMeshBuffer get(const TileLayer &layer);
+
+	/// @brief Takes the storage of the given buffers
+	void put(std::vector<PreMeshBuffer> &buffers);
+
+private:
+	std::vector<PreMeshBuffer> m_free;
+};
+
 struct MeshCollector
 {
 	std::array<std::vector<PreMeshBuffer>, MAX_TILE_LAYERS> prebuffers;
@@ -53,7 +69,13 @@ struct MeshCollector
 
 	// center_pos: pos to use for bounding-sphere, in BS-space
 	// offset: offset added to vertices
-	MeshCollector(const v3f center_pos, v3f offset = v3f()) : m_center_pos(center_pos), offset(offset) {}
+	// pool: where new buffers are taken from and returned to, may be null
+	MeshCollector(const v3f center_pos, v3f offset = v3f(),
+			PreMeshBufferPool *pool = nullptr) :
+		m_center_pos(center_pos), offset(offset), m_pool(pool) {}
+	~MeshCollector();
+
+	DISABLE_CLASS_COPY(MeshCollector)
 
 	void append(const TileSpec &material,
 			const video::S3DVertex *vertices, u32 numVertices,
@@ -66,4 +88,10 @@ struct MeshCollector
 			u8 layernum);
 
 	PreMeshBuffer &findBuffer(const TileLayer &layer, u8 layernum, u32 numVertices);
+
+	PreMeshBufferPool *m_pool;
+	// Index of the buffer that is being filled, per layer and material
+	std::array<std::unordered_map<TileLayer, size_t>, MAX_TILE_LAYERS> m_buffer_index;
+	// The most recently used one, since nodes tend to come in runs
+	std::array<size_t, MAX_TILE_LAYERS> m_last_index{};
 };
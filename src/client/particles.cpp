@@ -52,6 +52,43 @@ static video::ITexture *extractTexture(const TileDef &def, const TileLayer &laye
 	return nullptr;
 }
 
+/*
+	ParticleStepContext
+*/
+
+ParticleStepContext::ParticleStepContext(Environment *env, v3f player_pos,
+		f32 pitch, f32 yaw, v3s16 camera_offset) :
+	env(env),
+	player_pos(player_pos),
+	camera_offset(intToFloat(camera_offset, BS)),
+	m_daynight_ratio(env->getDayNightRatio())
+{
+	// The same as rotating the quad by the pitch around the X axis,
+	// then by the yaw around the Y axis
+	const f32 sp = std::sin(pitch * core::DEGTORAD), cp = std::cos(pitch * core::DEGTORAD);
+	const f32 sy = std::sin(yaw * core::DEGTORAD), cy = std::cos(yaw * core::DEGTORAD);
+	billboard_right = v3f(cy, 0, sy);
+	billboard_up = v3f(-sp * sy, cp, sp * cy);
+}
+
+u8 ParticleStepContext::getLight(v3s16 p)
+{
+	auto it = m_light_cache.find(p);
+	if (it != m_light_cache.end())
+		return it->second;
+
+	u8 light;
+	bool pos_ok;
+	MapNode n = env->getMap().getNode(p, &pos_ok);
+	if (pos_ok)
+		light = n.getLightBlend(m_daynight_ratio,
+				env->getGameDef()->ndef()->getLightingFlags(n));
+	else
+		light = blend_light(m_daynight_ratio, LIGHT_SUN, 0);
+	m_light_cache.emplace(p, light);
+	return light;
+}
+
 /*
 	Particle
 */
@@ -99,7 +136,7 @@ bool Particle::attachToBuffer(ParticleBuffer *buffer)
 	return false;
 }
 
-void Particle::step(float dtime, ClientEnvironment *env)
+void Particle::step(float dtime, ParticleStepContext &ctx)
 {
 	m_time += dtime;
 
@@ -112,7 +149,7 @@ void Particle::step(float dtime, ClientEnvironment *env)
 		aabb3f box(v3f(-m_p.size / 2.0f), v3f(m_p.size / 2.0f));
 		v3f p_pos = m_pos * BS;
 		v3f p_velocity = m_velocity * BS;
-		collisionMoveResult r = collisionMoveSimple(env, env->getGameDef(),
+		collisionMoveResult r = collisionMoveSimple(ctx.env, ctx.env->getGameDef(),
 			box, 0.0f, dtime, &p_pos, &p_velocity, m_acceleration * BS, nullptr,
 			m_p.object_collision);
 
@@ -170,29 +207,21 @@ void Particle::step(float dtime, ClientEnvironment *env)
 		alpha = m_texture.tex -> alpha.blend(m_time / (m_expiration+0.1f));
 
 	// Update lighting
-	auto col = updateLight(env);
+	auto col = updateLight(ctx);
 	col.setAlpha(255 * alpha);
 
 	// Update model
-	updateVertices(env, col);
+	updateVertices(ctx, col);
 }
 
-video::SColor Particle::updateLight(ClientEnvironment *env)
+video::SColor Particle::updateLight(ParticleStepContext &ctx)
 {
-	u8 light = 0;
-	bool pos_ok;
-
 	v3s16 p = v3s16(
 		floor(m_pos.X+0.5),
 		floor(m_pos.Y+0.5),
 		floor(m_pos.Z+0.5)
 	);
-	MapNode n = env->getClientMap().getNode(p, &pos_ok);
-	if (pos_ok)
-		light = n.getLightBlend(env->getDayNightRatio(),
-				env->getGameDef()->ndef()->getLightingFlags(n));
-	else
-		light = blend_light(env->getDayNightRatio(), LIGHT_SUN, 0);
+	u8 light = ctx.getLight(p);
 
 	u8 m_light = decode_light(light + m_p.glow);
 	return video::SColor(255,
@@ -201,7 +230,7 @@ video::SColor Particle::updateLight(ClientEnvironment *env)
 		m_light * m_base_color.getBlue() / 255);
 }
 
-void Particle::updateVertices(ClientEnvironment *env, video::SColor color)
+void Particle::updateVertices(const ParticleStepContext &ctx, video::SColor color)
 {
 	f32 tx0, tx1, ty0, ty1;
 	v2f scale;
@@ -238,31 +267,23 @@ void Particle::updateVertices(ClientEnvironment *env, video::SColor color)
 	auto half = m_p.size * .5f,
 	     hx   = half * scale.X,
 	     hy   = half * scale.Y;
-	vertices[0] = video::S3DVertex(-hx, -hy,
-		0, 0, 0, 0, color, tx0, ty1);
-	vertices[1] = video::S3DVertex(hx, -hy,
-		0, 0, 0, 0, color, tx1, ty1);
-	vertices[2] = video::S3DVertex(hx, hy,
-		0, 0, 0, 0, color, tx1, ty0);
-	vertices[3] = video::S3DVertex(-hx, hy,
-		0, 0, 0, 0, color, tx0, ty0);
-
-	// Update position -- see #10398
-	auto *player = env->getLocalPlayer();
-	v3s16 camera_offset = env->getCameraOffset();
-
-	for (u16 i = 0; i < 4; i++) {
-		video::S3DVertex &vertex = vertices[i];
-		if (m_p.vertical) {
-			v3f ppos = player->getPosition() / BS;
-			vertex.Pos.rotateXZBy(std::atan2(ppos.Z - m_pos.Z, ppos.X - m_pos.X) /
-				core::DEGTORAD + 90);
-		} else {
-			vertex.Pos.rotateYZBy(player->getPitch());
-			vertex.Pos.rotateXZBy(player->getYaw());
-		}
-		vertex.Pos += m_pos * BS - intToFloat(camera_offset, BS);
+
+	v3f right = ctx.billboard_right * hx;
+	v3f up = ctx.billboard_up * hy;
+	if (m_p.vertical) {
+		// Only turned around the Y axis, towards the player
+		v2f dir(ctx.player_pos.X - m_pos.X, ctx.player_pos.Z - m_pos.Z);
+		f32 length = dir.getLength();
+		right = length > 0 ? v3f(-dir.Y, 0, dir.X) * (hx / length) : v3f(0, 0, hx);
+		up = v3f(0, hy, 0);
 	}
+
+	// Relative to the camera offset -- see #10398
+	const v3f center = m_pos * BS - ctx.camera_offset;
+	vertices[0] = video::S3DVertex(center - right - up, v3f(), color, v2f(tx0, ty1));
+	vertices[1] = video::S3DVertex(center + right - up, v3f(), color, v2f(tx1, ty1));
+	vertices[2] = video::S3DVertex(center + right + up, v3f(), color, v2f(tx1, ty0));
+	vertices[3] = video::S3DVertex(center - right + up, v3f(), color, v2f(tx0, ty0));
 }
 
 /*
@@ -567,10 +588,9 @@ void ParticleSpawner::step(float dtime, ClientEnvironment *env)
 	ParticleBuffer
 */
 
-ParticleBuffer::ParticleBuffer(ClientEnvironment *env, const video::SMaterial &material)
-	: scene::ISceneNode(
-			env->getGameDef()->getSceneManager()->getRootSceneNode(),
-			env->getGameDef()->getSceneManager()),
+ParticleBuffer::ParticleBuffer(scene::ISceneNode *parent, scene::ISceneManager *smgr,
+		const video::SMaterial &material)
+	: scene::ISceneNode(parent, smgr),
 	m_mesh_buffer(make_irr<scene::SMeshBuffer>())
 {
 	m_mesh_buffer->getMaterial() = material;
@@ -729,6 +749,13 @@ void ParticleManager::stepParticles(float dtime)
 {
 	MutexAutoLock lock(m_particle_list_lock);
 
+	if (m_particles.empty())
+		return;
+
+	LocalPlayer *player = m_env->getLocalPlayer();
+	ParticleStepContext ctx(m_env, player->getPosition() / BS,
+		player->getPitch(), player->getYaw(), m_env->getCameraOffset());
+
 	for (size_t i = 0; i < m_particles.size();) {
 		Particle &p = *m_particles[i];
 		if (p.isExpired()) {
@@ -741,7 +768,7 @@ void ParticleManager::stepParticles(float dtime)
 			m_particles[i] = std::move(m_particles.back());
 			m_particles.pop_back();
 		} else {
-			p.step(dtime, m_env);
+			p.step(dtime, ctx);
 			++i;
 		}
 	}
@@ -1062,7 +1089,8 @@ bool ParticleManager::addParticle(std::unique_ptr<Particle> toadd)
 	}
 	// or create a new one
 	if (!found) {
-		auto tmp = make_irr<ParticleBuffer>(m_env, material);
+		scene::ISceneManager *smgr = m_env->getGameDef()->getSceneManager();
+		auto tmp = make_irr<ParticleBuffer>(smgr->getRootSceneNode(), smgr, material);
 		found = tmp.get();
 		m_particle_buffers.push_back(std::move(tmp));
 	}
@@ -23,6 +23,7 @@ namespace video {
 
 struct ClientEvent;
 class ParticleManager;
+class Environment;
 class ClientEnvironment;
 struct MapNode;
 struct ContentFeatures;
@@ -62,6 +63,35 @@ struct ClientParticleTexRef
 class ParticleSpawner;
 class ParticleBuffer;
 
+/*
+	What all particles need to know about the world during one step.
+	It is set up once per step, so that the particles share the camera
+	orientation and the light of the nodes they are in.
+*/
+class ParticleStepContext
+{
+public:
+	ParticleStepContext(Environment *env, v3f player_pos, f32 pitch, f32 yaw,
+		v3s16 camera_offset);
+
+	// Light at a node, blended for the current time of day
+	u8 getLight(v3s16 p);
+
+	// Used for collisions and light
+	Environment *const env;
+	// In nodes
+	const v3f player_pos;
+	// In BS units
+	const v3f camera_offset;
+	// Particles facing the camera are drawn in the plane of these axes
+	v3f billboard_right;
+	v3f billboard_up;
+
+private:
+	const u32 m_daynight_ratio;
+	std::unordered_map<v3s16, u8> m_light_cache;
+};
+
 class Particle
 {
 public:
@@ -79,7 +109,7 @@ class Particle
 
 	DISABLE_CLASS_COPY(Particle)
 
-	void step(float dtime, ClientEnvironment *env);
+	void step(float dtime, ParticleStepContext &ctx);
 
 	bool isExpired () const
 	{ return m_expiration < m_time; }
@@ -95,8 +125,8 @@ class Particle
 	bool attachToBuffer(ParticleBuffer *buffer);
 
 private:
-	video::SColor updateLight(ClientEnvironment *env);
-	void updateVertices(ClientEnvironment *env, video::SColor color);
+	video::SColor updateLight(ParticleStepContext &ctx);
+	void updateVertices(const ParticleStepContext &ctx, video::SColor color);
 
 	ParticleBuffer *m_buffer = nullptr;
 	u16 m_index; // index in m_buffer
@@ -159,7 +189,8 @@ class ParticleBuffer : public scene::ISceneNode
 {
 	friend class ParticleManager;
 public:
-	ParticleBuffer(ClientEnvironment *env, const video::SMaterial &material);
+	ParticleBuffer(scene::ISceneNode *parent, scene::ISceneManager *smgr,
+		const video::SMaterial &material);
 
 	// for pointer stability
 	DISABLE_CLASS_COPY(ParticleBuffer)
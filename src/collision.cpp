@@ -82,6 +82,28 @@ inline v3f rangelimv(const v3f vec, const f32 low, const f32 high)
 		rangelim(vec.Z, low, high)
 	);
 }
+
+// Returns the volume covered by `movingbox` while moving for `dtime`.
+// Padded so that float rounding in axisAlignedCollision can't make a box
+// outside of it collide.
+inline aabb3f sweptBox(const aabb3f &movingbox, const v3f speed, const f32 dtime)
+{
+	constexpr f32 margin = 0.01f * BS;
+	const v3f movement = speed * dtime;
+	return aabb3f(
+		movingbox.MinEdge + componentwise_min(movement, v3f()) - margin,
+		movingbox.MaxEdge + componentwise_max(movement, v3f()) + margin
+	);
+}
+
+// Whether two boxes overlap or touch. The axes are combined with & instead
+// of && to avoid branching on each comparison.
+inline bool boxesTouch(const aabb3f &a, const aabb3f &b)
+{
+	return (a.MinEdge.X <= b.MaxEdge.X) & (a.MaxEdge.X >= b.MinEdge.X) &
+		(a.MinEdge.Y <= b.MaxEdge.Y) & (a.MaxEdge.Y >= b.MinEdge.Y) &
+		(a.MinEdge.Z <= b.MaxEdge.Z) & (a.MaxEdge.Z >= b.MinEdge.Z);
+}
 }
 
 // Helper function:
@@ -279,6 +301,15 @@ static bool add_area_node_boxes(const v3s16 min, const v3s16 max, IGameDef *game
 			// Negative bouncy may have a meaning, but we need +value here.
 			int n_bouncy_value = abs(itemgroup_get(f.groups, "bouncy"));
 
+			// Fast path for full cubes, which is what most walkable nodes are.
+			// Same selection as in MapNode::getCollisionBoxes().
+			const NodeBox &nodebox = f.collision_box.fixed.empty() ?
+					f.node_box : f.collision_box;
+			if (nodebox.type == NODEBOX_REGULAR) {
+				cinfo.emplace_back(false, n_bouncy_value, p, getNodeBox(p, BS));
+				continue;
+			}
+
 			u8 neighbors = n.getNeighbors(p, map);
 
 			nodeboxes.clear();
@@ -465,6 +496,10 @@ collisionMoveResult collisionMoveSimple(Environment *env, IGameDef *gamedef,
 		f32 nearest_dtime = dtime;
 		int nearest_boxindex = -1;
 
+		// Any box that can collide during this interval touches the swept
+		// volume, so use that as a cheap filter before the exact test.
+		const aabb3f sweptbox = sweptBox(movingbox, aspeed_f, dtime);
+
 		// Go through every nodebox, find nearest collision
 		for (u32 boxindex = 0; boxindex < cinfo.size(); boxindex++) {
 			const NearbyCollisionInfo &box_info = cinfo[boxindex];
@@ -472,6 +507,9 @@ collisionMoveResult collisionMoveSimple(Environment *env, IGameDef *gamedef,
 			if (box_info.is_step_up)
 				continue;
 
+			if (!boxesTouch(box_info.box, sweptbox))
+				continue;
+
 			// Find nearest collision of the two boxes (raytracing-like)
 			f32 dtime_tmp = nearest_dtime;
 			CollisionAxis collided = axisAlignedCollision(box_info.box,
@@ -249,6 +249,8 @@ void set_default_settings()
 	settings->setDefault("fps_max_unfocused", "10");
 	settings->setDefault("viewing_range", "190");
 	settings->setDefault("client_mesh_chunk", "1");
+	settings->setDefault("mesh_merge_faces", "false");
+	settings->setDefault("mesh_lod_distance", "0");
 	settings->setDefault("screen_w", "1024");
 	settings->setDefault("screen_h", "600");
 	settings->setDefault("window_maximized", "false");
@@ -297,6 +299,8 @@ void set_default_settings()
 	settings->setDefault("smooth_scrolling", "true");
 	settings->setDefault("hud_hotbar_max_width", "1.0");
 	settings->setDefault("enable_local_map_saving", "false");
+	settings->setDefault("client_block_cache", "false");
+	settings->setDefault("client_block_cache_size", "256");
 	settings->setDefault("show_entity_selectionbox", "false");
 	settings->setDefault("ambient_occlusion_gamma", "1.8");
 	settings->setDefault("arm_inertia", "true");
@@ -10,9 +10,11 @@
 #include <iostream>
 #include "config.h"
 #include "constants.h"
+#include "dummymap.h"
 #include "irrlicht_changes/printing.h"
 #include "filesys.h"
 #include "log.h"
+#include "nodedef.h"
 #include "serverenvironment.h"
 #include "servermap.h"
 #include "mapblock.h"
@@ -25,8 +27,10 @@
 #include "scripting_server.h"
 #include "scripting_emerge.h"
 #include "script/common/c_types.h" // LuaError
+#include "serialization.h"
 #include "server.h"
 #include "settings.h"
+#include "util/serialize.h"
 #include "voxel.h"
 
 EmergeParams::~EmergeParams()
@@ -118,6 +122,13 @@ EmergeManager::~EmergeManager()
 			delete m_mapgens[i];
 	}
 
+	if (m_surface_thread && m_threads_active) {
+		m_surface_thread->stop();
+		m_surface_thread->signal();
+		m_surface_thread->wait();
+	}
+	m_surface_thread.reset();
+
 	delete biomegen;
 	delete biomemgr;
 	delete oremgr;
@@ -195,6 +206,18 @@ void EmergeManager::initMapgens(MapgenParams *params)
 			biomemgr, oremgr, decomgr, schemmgr);
 		m_mapgens.push_back(Mapgen::createMapgen(params->mgtype, params, p));
 	}
+
+	m_surface_thread = std::make_unique<MapgenSurfaceThread>(this,
+		m_server->getWorldPath() + DIR_DELIM "mapgen_surface");
+}
+
+Mapgen *EmergeManager::createMapgen()
+{
+	FATAL_ERROR_IF(m_mapgens.empty(), "Mapgen not initialized.");
+
+	EmergeParams *p = new EmergeParams(this, biomegen,
+		biomemgr, oremgr, decomgr, schemmgr);
+	return Mapgen::createMapgen(mgparams->mgtype, mgparams, p);
 }
 
 void EmergeManager::initThreads(bool should_multithread)
@@ -248,6 +271,8 @@ void EmergeManager::startThreads()
 
 	for (u32 i = 0; i != m_threads.size(); i++)
 		m_threads[i]->start();
+	if (m_surface_thread)
+		m_surface_thread->start();
 
 	m_threads_active = true;
 }
@@ -263,10 +288,16 @@ void EmergeManager::stopThreads()
 		m_threads[i]->stop();
 		m_threads[i]->signal();
 	}
+	if (m_surface_thread) {
+		m_surface_thread->stop();
+		m_surface_thread->signal();
+	}
 
 	// Then do the waiting for each
 	for (u32 i = 0; i != m_threads.size(); i++)
 		m_threads[i]->wait();
+	if (m_surface_thread)
+		m_surface_thread->wait();
 
 	m_threads_active = false;
 }
@@ -308,7 +339,7 @@ bool EmergeManager::enqueueBlockEmergeEx(
 		if (entry_already_exists)
 			return true;
 
-		thread = getOptimalThread();
+		thread = getOptimalThread(blockpos);
 		thread->pushBlock(blockpos);
 	}
 
@@ -357,6 +388,29 @@ int EmergeManager::getSpawnLevelAtPoint(v2s16 p)
 }
 
 
+bool EmergeManager::enqueueMapgenSurface(v2s16 minp, v2s16 maxp,
+	MapgenSurfaceCallback callback, void *callback_param)
+{
+	if (!m_surface_thread) {
+		errorstream << "EmergeManager: enqueueMapgenSurface() called"
+			" before mapgen init" << std::endl;
+		return false;
+	}
+
+	m_surface_thread->enqueue(minp, maxp, callback, callback_param);
+	return true;
+}
+
+
+v3s16 EmergeManager::getChunkPos(v3s16 blockpos) const
+{
+	// Mapgen params are only known after init, nothing is generated before
+	if (!mgparams)
+		return blockpos;
+	return getContainingChunk(blockpos, mgparams->chunksize);
+}
+
+
 // TODO(hmmmm): Move this to ServerMap
 bool EmergeManager::isBlockUnderground(v3s16 blockpos)
 {
@@ -413,6 +467,11 @@ bool EmergeManager::pushBlockEmergeData(
 
 bool EmergeManager::popBlockEmergeData(v3s16 pos, BlockEmergeData *bedata)
 {
+	// The block has left the thread queue
+	auto chunk_it = m_chunks_enqueued.find(getChunkPos(pos));
+	if (chunk_it != m_chunks_enqueued.end() && --chunk_it->second.count == 0)
+		m_chunks_enqueued.erase(chunk_it);
+
 	auto it = m_blocks_enqueued.find(pos);
 	if (it == m_blocks_enqueued.end())
 		return false;
@@ -434,12 +493,18 @@ bool EmergeManager::popBlockEmergeData(v3s16 pos, BlockEmergeData *bedata)
 }
 
 
-EmergeThread *EmergeManager::getOptimalThread()
+EmergeThread *EmergeManager::getOptimalThread(v3s16 blockpos)
 {
 	size_t nthreads = m_threads.size();
 
 	FATAL_ERROR_IF(nthreads == 0, "No emerge threads!");
 
+	// Stick with the thread that already has blocks of this chunk queued
+	ChunkQueueEntry &entry = m_chunks_enqueued[getChunkPos(blockpos)];
+	entry.count++;
+	if (entry.thread)
+		return entry.thread;
+
 	size_t index = 0;
 	size_t nitems_lowest = m_threads[0]->m_block_queue.size();
 
@@ -451,7 +516,29 @@ EmergeThread *EmergeManager::getOptimalThread()
 		}
 	}
 
-	return m_threads[index];
+	entry.thread = m_threads[index];
+	return entry.thread;
+}
+
+bool EmergeManager::isNextToGeneratingChunk(v3s16 blockpos,
+	const EmergeThread *thread) const
+{
+	if (m_chunks_generating.empty())
+		return false;
+
+	const v3s16 chunkpos = getChunkPos(blockpos);
+	const v3s16 csize = mgparams->chunksize;
+	for (auto &it : m_chunks_generating) {
+		if (it.second == thread)
+			continue;
+		// Generation writes into the one block thick shell around a chunk,
+		// so neighbours (including diagonal ones) overlap.
+		const v3s16 d = it.first - chunkpos;
+		if (std::abs(d.X) <= csize.X && std::abs(d.Y) <= csize.Y &&
+				std::abs(d.Z) <= csize.Z)
+			return true;
+	}
+	return false;
 }
 
 void EmergeManager::reportCompletedEmerge(EmergeAction action)
@@ -486,7 +573,7 @@ void EmergeThread::signal()
 
 bool EmergeThread::pushBlock(v3s16 pos)
 {
-	m_block_queue.push(pos);
+	m_block_queue.push_back(pos);
 	return true;
 }
 
@@ -500,7 +587,7 @@ void EmergeThread::cancelPendingItems()
 		v3s16 pos;
 
 		pos = m_block_queue.front();
-		m_block_queue.pop();
+		m_block_queue.pop_front();
 
 		m_emerge->popBlockEmergeData(pos, &bedata);
 
@@ -533,8 +620,22 @@ bool EmergeThread::popBlockEmerge(v3s16 *pos, BlockEmergeData *bedata)
 	if (m_block_queue.empty())
 		return false;
 
-	*pos = m_block_queue.front();
-	m_block_queue.pop();
+	// Prefer a block that doesn't touch a chunk another thread is generating,
+	// its generation would have to wait for the map lock and might race with
+	// the other mapgen. Only look a few entries ahead to keep the order.
+	constexpr size_t LOOKAHEAD = 16;
+	auto it = m_block_queue.begin();
+	const auto end = m_block_queue.begin() +
+		std::min(m_block_queue.size(), LOOKAHEAD);
+	for (auto it2 = it; it2 != end; ++it2) {
+		if (!m_emerge->isNextToGeneratingChunk(*it2, this)) {
+			it = it2;
+			break;
+		}
+	}
+
+	*pos = *it;
+	m_block_queue.erase(it);
 
 	m_emerge->popBlockEmergeData(*pos, bedata);
 
@@ -542,6 +643,17 @@ bool EmergeThread::popBlockEmerge(v3s16 *pos, BlockEmergeData *bedata)
 }
 
 
+void EmergeThread::setChunkGenerating(v3s16 chunkpos, bool generating)
+{
+	MutexAutoLock queuelock(m_emerge->m_queue_mutex);
+
+	if (generating)
+		m_emerge->m_chunks_generating[chunkpos] = this;
+	else
+		m_emerge->m_chunks_generating.erase(chunkpos);
+}
+
+
 EmergeAction EmergeThread::getBlockOrStartGen(const v3s16 pos, bool allow_gen,
 	 const std::string *from_db, MapBlock **block, BlockMakeData *bmdata)
 {
@@ -729,6 +841,7 @@ void *EmergeThread::run()
 		if (action == EMERGE_GENERATED) {
 			bool error = false;
 			m_trans_liquid = &bmdata.transforming_liquid;
+			setChunkGenerating(bmdata.blockpos_min, true);
 
 			{
 				ScopeProfiler sp(g_profiler,
@@ -756,6 +869,7 @@ void *EmergeThread::run()
 			if (!block || error)
 				action = EMERGE_ERRORED;
 
+			setChunkGenerating(bmdata.blockpos_min, false);
 			m_trans_liquid = nullptr;
 		}
 
@@ -806,3 +920,361 @@ void *EmergeThread::run()
 	END_DEBUG_EXCEPTION_HANDLER
 	return NULL;
 }
+
+
+////
+//// MapgenSurfaceThread
+////
+
+// Version of the tile file format, part of the cache key
+constexpr int MAPGEN_SURFACE_TILE_VERSION = 1;
+// Number of tiles kept in memory besides those on disk
+constexpr size_t MAPGEN_SURFACE_MEMORY_TILES = 64;
+// The search for the ground starts at the mapchunk containing the water
+// level and goes at most this many mapchunks up and down from there
+constexpr s16 MAPGEN_SURFACE_SEARCH_CHUNKS = 8;
+
+MapgenSurfaceThread::MapgenSurfaceThread(EmergeManager *emerge,
+		const std::string &cache_root) :
+	Thread("MapgenSurface"),
+	m_emerge(emerge),
+	m_cache_root(cache_root),
+	m_tiles(MAPGEN_SURFACE_MEMORY_TILES, [] (void *, const v2s16 &, Tile *) {}, nullptr)
+{
+}
+
+
+MapgenSurfaceThread::~MapgenSurfaceThread() = default;
+
+
+void MapgenSurfaceThread::signal()
+{
+	m_queue_event.signal();
+}
+
+
+void MapgenSurfaceThread::enqueue(v2s16 minp, v2s16 maxp,
+	MapgenSurfaceCallback callback, void *callback_param)
+{
+	{
+		MutexAutoLock lock(m_queue_mutex);
+		m_queue.push_back({minp, maxp, callback, callback_param});
+	}
+	signal();
+}
+
+
+void MapgenSurfaceThread::cancelPendingItems()
+{
+	std::deque<Query> queue;
+	{
+		MutexAutoLock lock(m_queue_mutex);
+		queue.swap(m_queue);
+	}
+
+	for (const Query &query : queue)
+		query.callback(nullptr, query.callback_param);
+}
+
+
+void *MapgenSurfaceThread::run()
+{
+	BEGIN_DEBUG_EXCEPTION_HANDLER
+
+	initMapgen();
+
+	while (!stopRequested()) {
+		Query query;
+		{
+			MutexAutoLock lock(m_queue_mutex);
+			if (m_queue.empty()) {
+				query.callback = nullptr;
+			} else {
+				query = m_queue.front();
+				m_queue.pop_front();
+			}
+		}
+		if (!query.callback) {
+			m_queue_event.wait();
+			continue;
+		}
+
+		MapgenSurface surface;
+		bool ok = getSurface(query.minp, query.maxp, surface);
+		query.callback(ok ? &surface : nullptr, query.callback_param);
+	}
+
+	cancelPendingItems();
+
+	END_DEBUG_EXCEPTION_HANDLER
+	return nullptr;
+}
+
+
+void MapgenSurfaceThread::initMapgen()
+{
+	if (m_mapgen)
+		return;
+
+	m_mapgen.reset(m_emerge->createMapgen());
+	// Everything that does not change the ground level is skipped
+	m_mapgen->flags &= MG_BIOMES;
+	// Nothing is loaded, chunks are always generated from scratch
+	m_map = std::make_unique<DummyMap>(m_emerge->m_server, v3s16(0), v3s16(-1));
+
+	// Tiles generated with other parameters are of no use anymore
+	const std::string key = getCacheKey();
+	for (const fs::DirListNode &node : fs::GetDirListing(m_cache_root)) {
+		if (node.dir && node.name != key)
+			fs::RecursiveDelete(m_cache_root + DIR_DELIM + node.name);
+	}
+	m_cache_dir = m_cache_root + DIR_DELIM + key;
+	if (!fs::CreateAllDirs(m_cache_dir)) {
+		warningstream << "MapgenSurfaceThread: failed to create \""
+			<< m_cache_dir << "\", tiles are not saved" << std::endl;
+	}
+}
+
+
+std::string MapgenSurfaceThread::getCacheKey() const
+{
+	std::ostringstream os(std::ios_base::binary);
+	os << MAPGEN_SURFACE_TILE_VERSION << '\n';
+
+	// Mapgen parameters, including the seed and the biome noises
+	Settings params;
+	const MapgenParams *mgparams = m_emerge->mgparams;
+	mgparams->MapgenParams::writeParams(&params);
+	mgparams->writeParams(&params);
+	params.writeLines(os);
+
+	const BiomeManager *biomemgr = m_emerge->biomemgr;
+	for (size_t i = 0; i < biomemgr->getNumObjects(); i++) {
+		const Biome *b = static_cast<const Biome *>(biomemgr->getRaw(i));
+		os << b->name << ' ' << b->c_top << ' ' << b->c_filler << ' '
+			<< b->c_stone << ' ' << b->c_water_top << ' ' << b->c_water << ' '
+			<< b->c_river_water << ' ' << b->c_riverbed << ' ' << b->c_dust << ' '
+			<< b->depth_top << ' ' << b->depth_filler << ' '
+			<< b->depth_water_top << ' ' << b->depth_riverbed << ' '
+			<< b->min_pos << ' ' << b->max_pos << ' ' << b->heat_point << ' '
+			<< b->humidity_point << ' ' << b->vertical_blend << ' '
+			<< b->weight << '\n';
+	}
+
+	// Mapgens and biomes refer to nodes by their IDs
+	const NodeDefManager *ndef = m_emerge->ndef;
+	for (u32 c = 0; c < ndef->size(); c++)
+		os << c << ' ' << ndef->get(c).name << '\n';
+
+	const std::string data = os.str();
+	char buf[17];
+	porting::mt_snprintf(buf, sizeof(buf), "%016llx",
+		(unsigned long long)murmur_hash_64_ua(data.data(), data.size(), 0));
+	return buf;
+}
+
+
+bool MapgenSurfaceThread::getSurface(v2s16 minp, v2s16 maxp, MapgenSurface &surface)
+{
+	if (!m_mapgen->heightmap)
+		return false;
+	const bool has_biomes = m_mapgen->biomemap && (m_mapgen->flags & MG_BIOMES);
+
+	if (minp.X > maxp.X)
+		std::swap(minp.X, maxp.X);
+	if (minp.Y > maxp.Y)
+		std::swap(minp.Y, maxp.Y);
+	const u32 width = maxp.X - minp.X + 1;
+	const u32 depth = maxp.Y - minp.Y + 1;
+	surface.minp = minp;
+	surface.maxp = maxp;
+	surface.heights.assign(width * depth, -MAX_MAP_GENERATION_LIMIT);
+	surface.biomes.assign(has_biomes ? width * depth : 0, BIOME_NONE);
+
+	const v3s16 csize = m_emerge->mgparams->chunksize;
+	const v2s16 csize_nodes(csize.X * MAP_BLOCKSIZE, csize.Z * MAP_BLOCKSIZE);
+	const v3s16 chunkmin = EmergeManager::getContainingChunk(
+		getNodeBlockPos(v3s16(minp.X, 0, minp.Y)), csize);
+	const v3s16 chunkmax = EmergeManager::getContainingChunk(
+		getNodeBlockPos(v3s16(maxp.X, 0, maxp.Y)), csize);
+
+	for (s32 cz = chunkmin.Z; cz <= chunkmax.Z; cz += csize.Z)
+	for (s32 cx = chunkmin.X; cx <= chunkmax.X; cx += csize.X) {
+		const Tile &tile = getTile(v2s16(cx, cz));
+
+		// Part of the area within this tile, in nodes
+		const v2s32 node_min(cx * MAP_BLOCKSIZE, cz * MAP_BLOCKSIZE);
+		const v2s32 pmin(std::max<s32>(minp.X, node_min.X),
+			std::max<s32>(minp.Y, node_min.Y));
+		const v2s32 pmax(std::min<s32>(maxp.X, node_min.X + csize_nodes.X - 1),
+			std::min<s32>(maxp.Y, node_min.Y + csize_nodes.Y - 1));
+
+		for (s32 z = pmin.Y; z <= pmax.Y; z++)
+		for (s32 x = pmin.X; x <= pmax.X; x++) {
+			u32 i = (z - minp.Y) * width + (x - minp.X);
+			u32 ti = (z - node_min.Y) * csize_nodes.X + (x - node_min.X);
+			surface.heights[i] = tile.heights[ti];
+			if (has_biomes)
+				surface.biomes[i] = tile.biomes[ti];
+		}
+	}
+
+	return true;
+}
+
+
+const MapgenSurfaceThread::Tile &MapgenSurfaceThread::getTile(v2s16 chunkpos)
+{
+	Tile *tile = m_tiles.lookupCache(chunkpos);
+	// a miss leaves an empty entry behind
+	if (!tile->heights.empty())
+		return *tile;
+
+	if (!loadTile(chunkpos, *tile)) {
+		generateTile(chunkpos, *tile);
+		saveTile(chunkpos, *tile);
+	}
+	return *tile;
+}
+
+
+void MapgenSurfaceThread::generateTile(v2s16 chunkpos, Tile &tile)
+{
+	const MapgenParams *mgparams = m_emerge->mgparams;
+	const v3s16 csize = mgparams->chunksize;
+	const u32 count = csize.X * MAP_BLOCKSIZE * csize.Z * MAP_BLOCKSIZE;
+	const bool has_biomes = m_mapgen->biomemap && (m_mapgen->flags & MG_BIOMES);
+	tile.heights.assign(count, -MAX_MAP_GENERATION_LIMIT);
+	tile.biomes.assign(has_biomes ? count : 0, BIOME_NONE);
+
+	// Tiles outside of the mapgen limits are left without ground.
+	// The limits are aligned to mapchunks.
+	auto [edge_min, edge_max] = get_mapgen_edges(mgparams->mapgen_limit, csize);
+	const v3s16 node_min(chunkpos.X * MAP_BLOCKSIZE, 0, chunkpos.Y * MAP_BLOCKSIZE);
+	if (node_min.X < edge_min.X || node_min.X > edge_max.X ||
+			node_min.Z < edge_min.Z || node_min.Z > edge_max.Z)
+		return;
+
+	const s16 start_y = EmergeManager::getContainingChunk(
+		getNodeBlockPos(v3s16(0, mgparams->water_level, 0)), csize).Y;
+	const s16 edge_y_min = getNodeBlockPos(edge_min).Y;
+	const s16 edge_y_max = EmergeManager::getContainingChunk(
+		getNodeBlockPos(edge_max), csize).Y;
+	const s16 ymin = std::max<s32>(edge_y_min,
+		start_y - MAPGEN_SURFACE_SEARCH_CHUNKS * csize.Y);
+	const s16 ymax = std::min<s32>(edge_y_max,
+		start_y + MAPGEN_SURFACE_SEARCH_CHUNKS * csize.Y);
+
+	// Heightmap and biomemap of every mapchunk of the column generated so far
+	std::map<s16, Tile> chunks;
+	auto generate = [&] (s16 cy) -> const Tile & {
+		auto it = chunks.find(cy);
+		if (it != chunks.end())
+			return it->second;
+
+		BlockMakeData data;
+		data.seed = mgparams->seed;
+		data.blockpos_min = v3s16(chunkpos.X, cy, chunkpos.Y);
+		data.blockpos_max = data.blockpos_min + csize - 1;
+		data.nodedef = m_emerge->ndef;
+		data.vmanip = new MMVManip(m_map.get());
+		data.vmanip->initialEmerge(data.blockpos_min - 1, data.blockpos_max + 1, false);
+
+		m_mapgen->makeChunk(&data);
+
+		Tile &chunk = chunks[cy];
+		chunk.heights.assign(m_mapgen->heightmap, m_mapgen->heightmap + count);
+		if (has_biomes)
+			chunk.biomes.assign(m_mapgen->biomemap, m_mapgen->biomemap + count);
+		return chunk;
+	};
+
+	// Go up while the ground of any column reaches the top of the mapchunk
+	s16 top_y = rangelim(start_y, ymin, ymax);
+	while (top_y + csize.Y <= ymax) {
+		const Tile &chunk = generate(top_y);
+		const s16 node_max_y = (top_y + csize.Y) * MAP_BLOCKSIZE - 1;
+		bool reaches_top = false;
+		for (s16 h : chunk.heights) {
+			if (h >= node_max_y) {
+				reaches_top = true;
+				break;
+			}
+		}
+		if (!reaches_top)
+			break;
+		top_y += csize.Y;
+	}
+
+	// Then down until every column has found its ground
+	u32 remaining = count;
+	for (s32 cy = top_y; cy >= ymin && remaining > 0; cy -= csize.Y) {
+		const Tile &chunk = generate(cy);
+		for (u32 i = 0; i < count; i++) {
+			if (tile.heights[i] != -MAX_MAP_GENERATION_LIMIT ||
+					chunk.heights[i] == -MAX_MAP_GENERATION_LIMIT)
+				continue;
+			tile.heights[i] = chunk.heights[i];
+			if (has_biomes)
+				tile.biomes[i] = chunk.biomes[i];
+			remaining--;
+		}
+	}
+}
+
+
+std::string MapgenSurfaceThread::getTilePath(v2s16 chunkpos) const
+{
+	return m_cache_dir + DIR_DELIM + itos(chunkpos.X) + "_" + itos(chunkpos.Y);
+}
+
+
+bool MapgenSurfaceThread::loadTile(v2s16 chunkpos, Tile &tile) const
+{
+	std::string compressed;
+	if (!fs::ReadFile(getTilePath(chunkpos), compressed))
+		return false;
+
+	const v3s16 csize = m_emerge->mgparams->chunksize;
+	const u32 count = csize.X * MAP_BLOCKSIZE * csize.Z * MAP_BLOCKSIZE;
+	try {
+		std::istringstream is(compressed, std::ios_base::binary);
+		std::ostringstream os(std::ios_base::binary);
+		decompressZstd(is, os);
+
+		std::istringstream data(os.str(), std::ios_base::binary);
+		if (readU32(data) != count)
+			throw SerializationError("wrong size");
+		tile.heights.resize(count);
+		for (s16 &height : tile.heights)
+			height = readS16(data);
+		tile.biomes.resize(readU8(data) ? count : 0);
+		for (biome_t &biome : tile.biomes)
+			biome = readU16(data);
+	} catch (SerializationError &e) {
+		warningstream << "MapgenSurfaceThread: discarding damaged tile "
+			<< getTilePath(chunkpos) << ": " << e.what() << std::endl;
+		tile = Tile();
+		return false;
+	}
+	return true;
+}
+
+
+void MapgenSurfaceThread::saveTile(v2s16 chunkpos, const Tile &tile) const
+{
+	std::ostringstream os(std::ios_base::binary);
+	writeU32(os, tile.heights.size());
+	for (s16 height : tile.heights)
+		writeS16(os, height);
+	writeU8(os, tile.biomes.empty() ? 0 : 1);
+	for (biome_t biome : tile.biomes)
+		writeU16(os, biome);
+
+	std::ostringstream compressed(std::ios_base::binary);
+	compressZstd(os.str(), compressed);
+	if (!fs::safeWriteToFile(getTilePath(chunkpos), compressed.str())) {
+		warningstream << "MapgenSurfaceThread: failed to save tile "
+			<< getTilePath(chunkpos) << std::endl;
+	}
+}
@@ -5,7 +5,9 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 #include "network/networkprotocol.h"
 #include "irr_v3d.h"
 #include "util/metricsbackend.h"
@@ -30,6 +32,7 @@ class DecorationManager;
 class SchematicManager;
 class Server;
 class ModApiMapgen;
+class MapgenSurfaceThread;
 struct MapDatabaseAccessor;
 
 // Structure containing inputs/outputs for chunk generation
@@ -47,6 +50,18 @@ struct BlockMakeData {
 	~BlockMakeData() { delete vmanip; }
 };
 
+// Ground level and biomes of an area as the mapgen would generate it,
+// see EmergeManager::enqueueMapgenSurface
+struct MapgenSurface {
+	v2s16 minp;
+	v2s16 maxp;
+	// Indexed by (z - minp.Y) * width + (x - minp.X).
+	// -MAX_MAP_GENERATION_LIMIT where no ground was found.
+	std::vector<s16> heights;
+	// Biome at the ground level, empty if the mapgen has no biomes
+	std::vector<biome_t> biomes;
+};
+
 // Result from processing an item on the emerge queue
 enum EmergeAction {
 	EMERGE_CANCELLED,
@@ -68,6 +83,11 @@ constexpr const char *emergeActionStrs[] = {
 typedef void (*EmergeCompletionCallback)(
 	v3s16 blockpos, EmergeAction action, void *param);
 
+// Called with the result of EmergeManager::enqueueMapgenSurface, or with
+// nullptr if the mapgen has no heightmap or the query was cancelled
+typedef void (*MapgenSurfaceCallback)(
+	const MapgenSurface *surface, void *param);
+
 typedef std::vector<
 	std::pair<
 		EmergeCompletionCallback,
@@ -158,6 +178,9 @@ class EmergeManager {
 	SchematicManager *getWritableSchematicManager();
 
 	void initMapgens(MapgenParams *mgparams);
+	/// Creates a mapgen that is not used by the emerge threads, e.g. for
+	/// benchmarks. Only usable after mapgen init, the caller owns it.
+	Mapgen *createMapgen();
 	/// @param holder non-owned reference that must stay alive
 	void initMap(MapDatabaseAccessor *holder);
 	/// resets the reference
@@ -187,6 +210,13 @@ class EmergeManager {
 	// Mapgen helpers methods
 	int getSpawnLevelAtPoint(v2s16 p);
 	bool isBlockUnderground(v3s16 blockpos);
+	/// Queues running the terrain and biome stages of the mapgen for the
+	/// area without touching the map, e.g. to preview ungenerated terrain.
+	/// This happens on a thread of its own, which also calls the callback.
+	/// Results are kept on disk in the world directory.
+	/// @return false if the mapgen is not initialized
+	bool enqueueMapgenSurface(v2s16 minp, v2s16 maxp,
+		MapgenSurfaceCallback callback, void *callback_param);
 
 	/// @return min edge of chunk in block units
 	static v3s16 getContainingChunk(v3s16 blockpos, v3s16 chunksize);
@@ -204,9 +234,19 @@ class EmergeManager {
 	MapDatabaseAccessor *m_db = nullptr;
 
 	std::mutex m_queue_mutex;
-	std::map<v3s16, BlockEmergeData> m_blocks_enqueued;
+	std::unordered_map<v3s16, BlockEmergeData> m_blocks_enqueued;
 	std::unordered_map<u16, u32> m_peer_queue_count;
 
+	// All queued blocks of a mapchunk go to the same thread, so that they
+	// are processed in order instead of waiting on each other's generation.
+	struct ChunkQueueEntry {
+		EmergeThread *thread = nullptr;
+		u32 count = 0; // number of queued blocks
+	};
+	std::unordered_map<v3s16, ChunkQueueEntry> m_chunks_enqueued;
+	// Mapchunks that are being generated right now, and by which thread
+	std::unordered_map<v3s16, EmergeThread *> m_chunks_generating;
+
 	u32 m_qlimit_total;
 	u32 m_qlimit_diskonly;
 	u32 m_qlimit_generate;
@@ -222,8 +262,17 @@ class EmergeManager {
 	DecorationManager *decomgr;
 	SchematicManager *schemmgr;
 
+	// Handles enqueueMapgenSurface, created with the mapgens
+	std::unique_ptr<MapgenSurfaceThread> m_surface_thread;
+
+	/// @return min edge of the mapchunk containing blockpos
+	v3s16 getChunkPos(v3s16 blockpos) const;
+
+	// Requires m_queue_mutex held
+	EmergeThread *getOptimalThread(v3s16 blockpos);
+
 	// Requires m_queue_mutex held
-	EmergeThread *getOptimalThread();
+	bool isNextToGeneratingChunk(v3s16 blockpos, const EmergeThread *thread) const;
 
 	bool pushBlockEmergeData(
 		v3s16 pos,
@@ -238,4 +287,5 @@ class EmergeManager {
 	void reportCompletedEmerge(EmergeAction action);
 
 	friend class EmergeThread;
+	friend class MapgenSurfaceThread;
 };
@@ -10,7 +10,7 @@
 
 #include "emerge.h"
 
-#include <queue>
+#include <deque>
 
 #include "util/thread.h"
 #include "threading/event.h"
@@ -21,6 +21,7 @@ class Mapgen;
 
 class EmergeManager;
 class EmergeScripting;
+class DummyMap;
 
 class EmergeThread : public Thread {
 public:
@@ -58,10 +59,12 @@ class EmergeThread : public Thread {
 	UniqueQueue<v3s16> *m_trans_liquid; //< non-null only when generating a mapblock
 
 	Event m_queue_event;
-	std::queue<v3s16> m_block_queue;
+	std::deque<v3s16> m_block_queue;
 
 	bool initScripting();
 
+	void setChunkGenerating(v3s16 chunkpos, bool generating);
+
 	bool popBlockEmerge(v3s16 *pos, BlockEmergeData *bedata);
 
 	/**
@@ -86,6 +89,64 @@ class EmergeThread : public Thread {
 	friend class ModApiMapgen;
 };
 
+/*
+	Handles EmergeManager::enqueueMapgenSurface with a mapgen of its own.
+	The surface is generated for whole columns of mapchunks ("tiles"), which
+	are kept on disk. The tiles are only valid for the mapgen parameters,
+	biomes and node IDs they were generated with, so they are stored in a
+	directory named after a hash of those.
+*/
+class MapgenSurfaceThread : public Thread {
+public:
+	MapgenSurfaceThread(EmergeManager *emerge, const std::string &cache_root);
+	~MapgenSurfaceThread();
+
+	void *run();
+	void signal();
+
+	void enqueue(v2s16 minp, v2s16 maxp, MapgenSurfaceCallback callback,
+		void *callback_param);
+
+	void cancelPendingItems();
+
+private:
+	struct Query {
+		v2s16 minp;
+		v2s16 maxp;
+		MapgenSurfaceCallback callback;
+		void *callback_param;
+	};
+
+	// Ground level and biomes of every column of a column of mapchunks
+	struct Tile {
+		std::vector<s16> heights;
+		std::vector<biome_t> biomes;
+	};
+
+	EmergeManager *m_emerge;
+	const std::string m_cache_root;
+	std::string m_cache_dir;
+
+	std::unique_ptr<Mapgen> m_mapgen;
+	std::unique_ptr<DummyMap> m_map;
+	LRUCache<v2s16, Tile> m_tiles;
+
+	std::mutex m_queue_mutex;
+	std::deque<Query> m_queue;
+	Event m_queue_event;
+
+	void initMapgen();
+	std::string getCacheKey() const;
+
+	bool getSurface(v2s16 minp, v2s16 maxp, MapgenSurface &surface);
+	const Tile &getTile(v2s16 chunkpos);
+	void generateTile(v2s16 chunkpos, Tile &tile);
+
+	std::string getTilePath(v2s16 chunkpos) const;
+	bool loadTile(v2s16 chunkpos, Tile &tile) const;
+	void saveTile(v2s16 chunkpos, const Tile &tile) const;
+};
+
 // Scoped helper to set Server::m_ignore_map_edit_events_area
 class MapEditEventAreaIgnorer
 {
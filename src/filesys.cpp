@@ -134,6 +134,17 @@ bool IsFile(const std::string &path)
 			!(attr & FILE_ATTRIBUTE_DIRECTORY));
 }
 
+bool GetFileInfo(const std::string &path, uint64_t *size, uint64_t *mtime)
+{
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesEx(path.c_str(), GetFileExInfoStandard, &data))
+		return false;
+	*size = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+	*mtime = ((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) |
+		data.ftLastWriteTime.dwLowDateTime;
+	return true;
+}
+
 bool IsExecutable(const std::string &path)
 {
 	DWORD type;
@@ -356,6 +367,22 @@ bool IsFile(const std::string &path)
 	return ((statbuf.st_mode & S_IFDIR) != S_IFDIR);
 }
 
+bool GetFileInfo(const std::string &path, uint64_t *size, uint64_t *mtime)
+{
+	struct stat statbuf{};
+	if (stat(path.c_str(), &statbuf))
+		return false;
+	*size = statbuf.st_size;
+	// In nanoseconds, seconds alone would miss changes right after a read
+#ifdef __APPLE__
+	const struct timespec &ts = statbuf.st_mtimespec;
+#else
+	const struct timespec &ts = statbuf.st_mtim;
+#endif
+	*mtime = (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+	return true;
+}
+
 bool IsExecutable(const std::string &path)
 {
 	return access(path.c_str(), X_OK) == 0;
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "config.h"
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -51,6 +52,11 @@ bool CreateDir(const std::string &path);
 
 [[nodiscard]] bool IsFile(const std::string &path);
 
+// Size in bytes and modification time of a file. The time is in an
+// unspecified unit of (up to) nanoseconds, so only compare it with others.
+[[nodiscard]] bool GetFileInfo(const std::string &path, uint64_t *size,
+	uint64_t *mtime);
+
 [[nodiscard]] inline bool IsDirDelimiter(char c)
 {
 	return c == '/' || c == DIR_DELIM_CHAR;
@@ -389,6 +389,10 @@ static void set_allowed_options(OptionList *allowed_options)
 			_("Enable ncurses interactive terminal" SERVER_ONLY))));
 	allowed_options->insert(std::make_pair("recompress", ValueSpec(VALUETYPE_FLAG,
 			_("Recompress the blocks of the given map database" SERVER_ONLY))));
+	allowed_options->insert(std::make_pair("pregenerate", ValueSpec(VALUETYPE_STRING,
+			_("Generate the map in the area \"(x1,y1,z1) (x2,y2,z2)\" and exit" SERVER_ONLY))));
+	allowed_options->insert(std::make_pair("mapgen-surface", ValueSpec(VALUETYPE_STRING,
+			_("Print the ground level and biome of every column in the area \"(x1,z1) (x2,z2)\" and exit" SERVER_ONLY))));
 #if CHECK_CLIENT_BUILD()
 	allowed_options->insert(std::make_pair("address", ValueSpec(VALUETYPE_STRING,
 			_("Address to connect to ('' = local game)"))));
@@ -1136,6 +1140,12 @@ static bool run_dedicated_server(const GameParams &game_params, const Settings &
 	if (cmd_args.getFlag("recompress"))
 		return recompress_map_database(game_params, cmd_args);
 
+	if (cmd_args.exists("pregenerate"))
+		return Server::pregenerateMap(game_params, cmd_args);
+
+	if (cmd_args.exists("mapgen-surface"))
+		return Server::printMapgenSurface(game_params, cmd_args);
+
 	// Bind address
 	std::string bind_str = g_settings->get("bind_address");
 	Address bind_addr(0, 0, 0, 0, game_params.socket_port);
@@ -657,8 +657,45 @@ bool Map::determineAdditionalOcclusionCheck(const v3s16 pos_camera,
 	return false;
 }
 
+SectorSnapshot::SectorSnapshot(v2s16 p_min, v2s16 p_max) :
+	m_min(p_min), m_max(p_max)
+{
+	if (m_max.X >= m_min.X && m_max.Y >= m_min.Y)
+		m_sectors.resize((m_max.X - m_min.X + 1) * (m_max.Y - m_min.Y + 1), nullptr);
+}
+
+void SectorSnapshot::add(const MapSector *sector)
+{
+	const v2s16 p = sector->getPos();
+	if (p.X < m_min.X || p.Y < m_min.Y || p.X > m_max.X || p.Y > m_max.Y)
+		return;
+	m_sectors[(p.Y - m_min.Y) * (m_max.X - m_min.X + 1) + p.X - m_min.X] = sector;
+}
+
+MapBlock *SectorSnapshot::getBlock(v3s16 p) const
+{
+	if (p.X < m_min.X || p.Z < m_min.Y || p.X > m_max.X || p.Z > m_max.Y)
+		return nullptr;
+	const MapSector *sector =
+		m_sectors[(p.Z - m_min.Y) * (m_max.X - m_min.X + 1) + p.X - m_min.X];
+	if (!sector)
+		return nullptr;
+	const auto &blocks = sector->getBlocks();
+	auto it = blocks.find(p.Y);
+	return it != blocks.end() ? it->second.get() : nullptr;
+}
+
+SectorSnapshot Map::getSectorSnapshot(v2s16 p_min, v2s16 p_max)
+{
+	SectorSnapshot snapshot(p_min, p_max);
+	for (const auto &it : m_sectors)
+		snapshot.add(it.second);
+	return snapshot;
+}
+
 bool Map::isOccluded(const v3s16 pos_camera, const v3s16 pos_target,
-	float step, float stepfac, float offset, float end_offset, u32 needed_count)
+	float step, float stepfac, float offset, float end_offset, u32 needed_count,
+	const SectorSnapshot *snapshot)
 {
 	v3f direction = intToFloat(pos_target - pos_camera, BS);
 	float distance = direction.getLength();
@@ -669,16 +706,24 @@ bool Map::isOccluded(const v3s16 pos_camera, const v3s16 pos_target,
 
 	v3f pos_origin_f = intToFloat(pos_camera, BS);
 	u32 count = 0;
-	bool is_valid_position;
+
+	// Most steps stay in the block of the previous one
+	v3s16 blockpos(S16_MAX);
+	MapBlock *block = nullptr;
 
 	for (; offset < distance + end_offset; offset += step) {
 		v3f pos_node_f = pos_origin_f + direction * offset;
 		v3s16 pos_node = floatToInt(pos_node_f, BS);
 
-		MapNode node = getNode(pos_node, &is_valid_position);
+		v3s16 node_blockpos = getNodeBlockPos(pos_node);
+		if (node_blockpos != blockpos) {
+			blockpos = node_blockpos;
+			block = snapshot ? snapshot->getBlock(blockpos) :
+					getBlockNoCreateNoEx(blockpos);
+		}
 
-		if (is_valid_position &&
-				!m_nodedef->getLightingFlags(node).light_propagates) {
+		if (block && !m_nodedef->getLightingFlags(
+				block->getNodeNoCheck(pos_node - blockpos * MAP_BLOCKSIZE)).light_propagates) {
 			// Cannot see through light-blocking nodes --> occluded
 			count++;
 			if (count >= needed_count)
@@ -689,7 +734,8 @@ bool Map::isOccluded(const v3s16 pos_camera, const v3s16 pos_target,
 	return false;
 }
 
-bool Map::isBlockOccluded(v3s16 pos_relative, v3s16 cam_pos_nodes, bool simple_check)
+bool Map::isBlockOccluded(v3s16 pos_relative, v3s16 cam_pos_nodes, bool simple_check,
+	const SectorSnapshot *snapshot)
 {
 	// Check occlusion for center and all 8 corners of the mapblock
 	// Overshoot a little for less flickering
@@ -733,7 +779,7 @@ bool Map::isBlockOccluded(v3s16 pos_relative, v3s16 cam_pos_nodes, bool simple_c
 	if (simple_check) {
 		v3s16 random_point(myrand_range(-bs2, bs2), myrand_range(-bs2, bs2), myrand_range(-bs2, bs2));
 		return isOccluded(cam_pos_nodes, pos_blockcenter + random_point, step, stepfac,
-					start_offset, end_offset, 1);
+					start_offset, end_offset, 1, snapshot);
 	}
 
 	// Additional occlusion check, see comments in that function
@@ -741,13 +787,13 @@ bool Map::isBlockOccluded(v3s16 pos_relative, v3s16 cam_pos_nodes, bool simple_c
 	if (determineAdditionalOcclusionCheck(cam_pos_nodes, MapBlock::getBox(pos_relative), check)) {
 		// node is always on a side facing the camera, end_offset can be lower
 		if (!isOccluded(cam_pos_nodes, check, step, stepfac, start_offset,
-				-1.0f, needed_count))
+				-1.0f, needed_count, snapshot))
 			return false;
 	}
 
 	for (const v3s16 &dir : dir9) {
 		if (!isOccluded(cam_pos_nodes, pos_blockcenter + dir, step, stepfac,
-				start_offset, end_offset, needed_count))
+				start_offset, end_offset, needed_count, snapshot))
 			return false;
 	}
 	return true;
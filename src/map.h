@@ -99,6 +99,29 @@ class MapEventReceiver
 	virtual void onMapEditEvent(const MapEditEvent &event) = 0;
 };
 
+/*
+	The sectors of an area of the map, to look up map blocks from other
+	threads. Map::getBlockNoCreateNoEx() can't be used there, the map and
+	its sectors remember the last block that was looked up.
+	The map must not change while a snapshot is used.
+*/
+class SectorSnapshot
+{
+public:
+	// The area is in sector positions
+	SectorSnapshot(v2s16 p_min, v2s16 p_max);
+
+	// Sectors outside of the area are left out
+	void add(const MapSector *sector);
+
+	// Returns NULL if not found, or outside of the area
+	MapBlock *getBlock(v3s16 p) const;
+
+private:
+	v2s16 m_min, m_max;
+	std::vector<const MapSector *> m_sectors;
+};
+
 class Map /*: public NodeContainer*/
 {
 public:
@@ -270,11 +293,18 @@ class Map /*: public NodeContainer*/
 		}
 	}
 
-	bool isBlockOccluded(MapBlock *block, v3s16 cam_pos_nodes)
+	// With a snapshot, the blocks are only looked up in it. This is safe to
+	// call from other threads then, as long as the map doesn't change.
+	bool isBlockOccluded(MapBlock *block, v3s16 cam_pos_nodes,
+		const SectorSnapshot *snapshot = nullptr)
 	{
-		return isBlockOccluded(block->getPosRelative(), cam_pos_nodes, false);
+		return isBlockOccluded(block->getPosRelative(), cam_pos_nodes, false, snapshot);
 	}
-	bool isBlockOccluded(v3s16 pos_relative, v3s16 cam_pos_nodes, bool simple_check = false);
+	bool isBlockOccluded(v3s16 pos_relative, v3s16 cam_pos_nodes, bool simple_check = false,
+		const SectorSnapshot *snapshot = nullptr);
+
+	// Of the sectors in the area, see SectorSnapshot
+	SectorSnapshot getSectorSnapshot(v2s16 p_min, v2s16 p_max);
 
 protected:
 	IGameDef *m_gamedef;
@@ -297,7 +327,7 @@ class Map /*: public NodeContainer*/
 		const core::aabbox3d<s16> &block_bounds, v3s16 &to_check);
 	bool isOccluded(v3s16 pos_camera, v3s16 pos_target,
 		float step, float stepfac, float start_offset, float end_offset,
-		u32 needed_count);
+		u32 needed_count, const SectorSnapshot *snapshot = nullptr);
 };
 
 class MMVManip : public VoxelManipulator
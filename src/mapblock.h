@@ -460,6 +460,9 @@ class MapBlock
 
 	// marks the sides which are opaque: 00+Z-Z+Y-Y+X-X
 	u8 solid_sides = 0;
+
+	// level of detail of a mesh update that is still on its way, or 0
+	u8 mesh_lod_requested = 0;
 #endif
 
 private:
@@ -6,6 +6,7 @@
 
 #include "util/numeric.h"
 #include <cmath>
+#include <vector>
 #include "map.h"
 #include "mapgen.h"
 #include "mg_biome.h"
@@ -61,11 +62,39 @@ void CavesNoiseIntersection::generateCaves(MMVManip *vm,
 	noise_cave1->noiseMap3D(nmin.X, nmin.Y - 1, nmin.Z);
 	noise_cave2->noiseMap3D(nmin.X, nmin.Y - 1, nmin.Z);
 
+	// Find the tunnels in one flat pass over the noise, which the compiler
+	// can vectorize. Most columns contain no tunnel at all, and as nothing
+	// is placed in such a column, the node loop below can skip it.
+	const u32 volume = m_zstride_1d * m_csize.Z;
+	const float *noise1 = noise_cave1->result;
+	const float *noise2 = noise_cave2->result;
+	std::vector<u8> tunnel(volume);
+	for (u32 i = 0; i < volume; i++) {
+		// Same as contour()
+		float d1 = std::fabs(noise1[i]);
+		float d2 = std::fabs(noise2[i]);
+		d1 = d1 >= 1.0f ? 0.0f : (float)(1.0 - d1);
+		d2 = d2 >= 1.0f ? 0.0f : (float)(1.0 - d2);
+		tunnel[i] = d1 * d2 > m_cave_width;
+	}
+
+	std::vector<u8> column_has_tunnel(m_csize.X * m_csize.Z);
+	for (s16 z = 0; z < m_csize.Z; z++)
+	for (s16 y = 0; y <= m_csize.Y; y++) {
+		const u8 *row = &tunnel[z * m_zstride_1d + y * m_ystride];
+		u8 *columns = &column_has_tunnel[z * m_csize.X];
+		for (s16 x = 0; x < m_csize.X; x++)
+			columns[x] |= row[x];
+	}
+
 	const v3s32 &em = vm->m_area.getExtent();
 	u32 index2d = 0;  // Biomemap index
 
 	for (s16 z = nmin.Z; z <= nmax.Z; z++)
 	for (s16 x = nmin.X; x <= nmax.X; x++, index2d++) {
+		if (!column_has_tunnel[index2d])
+			continue;
+
 		bool column_is_open = false;  // Is column open to overground
 		bool is_under_river = false;  // Is column under river water
 		bool is_under_tunnel = false;  // Is tunnel or is under tunnel
@@ -118,10 +147,7 @@ void CavesNoiseIntersection::generateCaves(MMVManip *vm,
 			}
 
 			// Ground
-			float d1 = contour(noise_cave1->result[index3d]);
-			float d2 = contour(noise_cave2->result[index3d]);
-
-			if (d1 * d2 > m_cave_width && m_ndef->get(c).is_ground_content) {
+			if (tunnel[index3d] && m_ndef->get(c).is_ground_content) {
 				// In tunnel and ground content, excavate
 				vm->m_data[vi] = MapNode(CONTENT_AIR);
 				is_under_tunnel = true;
@@ -219,21 +245,46 @@ bool CavernsNoise::generateCaverns(MMVManip *vm, v3s16 nmin, v3s16 nmax)
 
 	// Cache cavern_amp values
 	float *cavern_amp = new float[m_csize.Y + 1];
-	u8 cavern_amp_index = 0;  // Index zero at column top
+	u16 cavern_amp_index = 0;  // Index zero at column top
 	for (s16 y = nmax.Y; y >= nmin.Y - 1; y--, cavern_amp_index++) {
 		cavern_amp[cavern_amp_index] =
 			MYMIN((m_cavern_limit - y) / (float)m_cavern_taper, 1.0f);
 	}
 
-	//// Place nodes
+	// Find the caverns in one flat pass over the noise, which the compiler
+	// can vectorize, then only visit the columns that contain one.
+	const float near_threshold = m_cavern_threshold - 0.1f;
+	const float *noise = noise_cavern->result;
+	std::vector<u8> cavern(m_zstride_1d * m_csize.Z);
+	std::vector<u8> column_has_cavern(m_csize.X * m_csize.Z);
 	bool near_cavern = false;
+	for (s16 z = 0; z < m_csize.Z; z++)
+	for (s16 y = 0; y <= m_csize.Y; y++) {
+		const u32 i0 = z * m_zstride_1d + y * m_ystride;
+		const float amp = cavern_amp[m_csize.Y - y];
+		u8 *columns = &column_has_cavern[z * m_csize.X];
+		u8 near = 0;
+		for (s16 x = 0; x < m_csize.X; x++) {
+			float n_absamp_cavern = std::fabs(noise[i0 + x]) * amp;
+			// Disable CavesRandomWalk at a safe distance from caverns
+			// to avoid excessively spreading liquids in caverns.
+			near |= n_absamp_cavern > near_threshold;
+			u8 is_cavern = n_absamp_cavern > m_cavern_threshold;
+			cavern[i0 + x] = is_cavern;
+			columns[x] |= is_cavern;
+		}
+		near_cavern |= near;
+	}
+
+	//// Place nodes
 	const v3s32 &em = vm->m_area.getExtent();
 	u32 index2d = 0;
 
 	for (s16 z = nmin.Z; z <= nmax.Z; z++)
 	for (s16 x = nmin.X; x <= nmax.X; x++, index2d++) {
-		// Reset cave_amp index to column top
-		cavern_amp_index = 0;
+		if (!column_has_cavern[index2d])
+			continue;
+
 		// Initial voxelmanip index at column top
 		u32 vi = vm->m_area.index(x, nmax.Y, z);
 		// Initial 3D noise index at column top
@@ -245,19 +296,10 @@ bool CavernsNoise::generateCaverns(MMVManip *vm, v3s16 nmin, v3s16 nmax)
 		// This 'roof' is excavated when the mapchunk above is generated.
 		for (s16 y = nmax.Y; y >= nmin.Y - 1; y--,
 				index3d -= m_ystride,
-				VoxelArea::add_y(em, vi, -1),
-				cavern_amp_index++) {
-			content_t c = vm->m_data[vi].getContent();
-			float n_absamp_cavern = std::fabs(noise_cavern->result[index3d]) *
-				cavern_amp[cavern_amp_index];
-			// Disable CavesRandomWalk at a safe distance from caverns
-			// to avoid excessively spreading liquids in caverns.
-			if (n_absamp_cavern > m_cavern_threshold - 0.1f) {
-				near_cavern = true;
-				if (n_absamp_cavern > m_cavern_threshold &&
-						m_ndef->get(c).is_ground_content)
-					vm->m_data[vi] = MapNode(CONTENT_AIR);
-			}
+				VoxelArea::add_y(em, vi, -1)) {
+			if (cavern[index3d] &&
+					m_ndef->get(vm->m_data[vi].getContent()).is_ground_content)
+				vm->m_data[vi] = MapNode(CONTENT_AIR);
 		}
 	}
 
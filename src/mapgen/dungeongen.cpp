@@ -85,14 +85,22 @@ void DungeonGen::generate(MMVManip *vm, u32 bseed, v3s16 nmin, v3s16 nmax)
 		// Like randomwalk caves, preserve nodes that have 'is_ground_content = false',
 		// to avoid dungeons that generate out beyond the edge of a mapchunk destroying
 		// nodes added by mods in 'register_on_generated()'.
+		// The chunk is mostly made of long runs of the same node, so the
+		// result for the previous node is reused.
+		content_t last_c = CONTENT_IGNORE;
+		bool preserve = true;
 		for (s16 z = nmin.Z; z <= nmax.Z; z++) {
 			for (s16 y = nmin.Y; y <= nmax.Y; y++) {
 				u32 i = vm->m_area.index(nmin.X, y, z);
 				for (s16 x = nmin.X; x <= nmax.X; x++) {
 					content_t c = vm->m_data[i].getContent();
-					NodeDrawType dtype = ndef->get(c).drawtype;
-					if (dtype == NDT_AIRLIKE || dtype == NDT_LIQUID ||
-							c == CONTENT_IGNORE || !ndef->get(c).is_ground_content)
+					if (c != last_c) {
+						const ContentFeatures &f = ndef->get(c);
+						preserve = f.drawtype == NDT_AIRLIKE || f.drawtype == NDT_LIQUID ||
+							c == CONTENT_IGNORE || !f.is_ground_content;
+						last_c = c;
+					}
+					if (preserve)
 						vm->m_flags[i] |= VMANIP_FLAG_DUNGEON_PRESERVE;
 					i++;
 				}
@@ -157,15 +165,15 @@ void DungeonGen::makeDungeon(v3s16 start_padding)
 			otherwise it might end up floating in the air
 		*/
 		fits = true;
-		for (s16 z = 0; z < roomsize.Z; z++)
-		for (s16 y = 0; y < roomsize.Y; y++)
-		for (s16 x = 0; x < roomsize.X; x++) {
-			v3s16 p = roomplace + v3s16(x, y, z);
-			u32 vi = vm->m_area.index(p);
-			if ((vm->m_flags[vi] & VMANIP_FLAG_DUNGEON_UNTOUCHABLE) ||
-					vm->m_data[vi].getContent() == CONTENT_IGNORE) {
-				fits = false;
-				break;
+		for (s16 z = 0; z < roomsize.Z && fits; z++)
+		for (s16 y = 0; y < roomsize.Y && fits; y++) {
+			u32 vi = vm->m_area.index(roomplace.X, roomplace.Y + y, roomplace.Z + z);
+			for (s16 x = 0; x < roomsize.X; x++, vi++) {
+				if ((vm->m_flags[vi] & VMANIP_FLAG_DUNGEON_UNTOUCHABLE) ||
+						vm->m_data[vi].getContent() == CONTENT_IGNORE) {
+					fits = false;
+					break;
+				}
 			}
 		}
 	}
@@ -263,85 +271,81 @@ void DungeonGen::makeRoom(v3s16 roomsize, v3s16 roomplace)
 	MapNode n_wall(dp.c_wall);
 	MapNode n_air(CONTENT_AIR);
 
+	const VoxelArea &area = vm->m_area;
+	const u32 ystride = area.getExtent().X;
+	const u32 zstride = area.getExtent().X * area.getExtent().Y;
+	const v3s16 roommax = roomplace + roomsize - 1;
+
+	// Part of the room inside the voxel manipulator, only the rows of
+	// nodes in there are visited
+	const v3s16 pmin = componentwise_max(roomplace, area.MinEdge);
+	const v3s16 pmax = componentwise_min(roommax, area.MaxEdge);
+	if (pmin.X > pmax.X || pmin.Y > pmax.Y || pmin.Z > pmax.Z)
+		return;
+
+	auto inside = [] (s16 v, s16 min, s16 max) {
+		return v >= min && v <= max;
+	};
+	auto place_wall = [&] (u32 vi) {
+		if (vm->m_flags[vi] & VMANIP_FLAG_DUNGEON_UNTOUCHABLE)
+			return false;
+		vm->m_data[vi] = n_wall;
+		return true;
+	};
+
+	/*
+		Opposite walls are made in pairs. The far wall node is skipped
+		whenever the near one is outside or untouchable, the generated
+		dungeons depend on this.
+	*/
+
 	// Make +-X walls
-	for (s16 z = 0; z < roomsize.Z; z++)
-	for (s16 y = 0; y < roomsize.Y; y++) {
-		{
-			v3s16 p = roomplace + v3s16(0, y, z);
-			if (!vm->m_area.contains(p))
-				continue;
-			u32 vi = vm->m_area.index(p);
-			if (vm->m_flags[vi] & VMANIP_FLAG_DUNGEON_UNTOUCHABLE)
-				continue;
-			vm->m_data[vi] = n_wall;
-		}
-		{
-			v3s16 p = roomplace + v3s16(roomsize.X - 1, y, z);
-			if (!vm->m_area.contains(p))
-				continue;
-			u32 vi = vm->m_area.index(p);
-			if (vm->m_flags[vi] & VMANIP_FLAG_DUNGEON_UNTOUCHABLE)
-				continue;
-			vm->m_data[vi] = n_wall;
+	if (inside(roomplace.X, area.MinEdge.X, area.MaxEdge.X)) {
+		const bool far_inside = inside(roommax.X, area.MinEdge.X, area.MaxEdge.X);
+		for (s16 z = pmin.Z; z <= pmax.Z; z++)
+		for (s16 y = pmin.Y; y <= pmax.Y; y++) {
+			u32 vi = area.index(roomplace.X, y, z);
+			if (place_wall(vi) && far_inside)
+				place_wall(vi + roomsize.X - 1);
 		}
 	}
 
 	// Make +-Z walls
-	for (s16 x = 0; x < roomsize.X; x++)
-	for (s16 y = 0; y < roomsize.Y; y++) {
-		{
-			v3s16 p = roomplace + v3s16(x, y, 0);
-			if (!vm->m_area.contains(p))
-				continue;
-			u32 vi = vm->m_area.index(p);
-			if (vm->m_flags[vi] & VMANIP_FLAG_DUNGEON_UNTOUCHABLE)
-				continue;
-			vm->m_data[vi] = n_wall;
-		}
-		{
-			v3s16 p = roomplace + v3s16(x, y, roomsize.Z - 1);
-			if (!vm->m_area.contains(p))
-				continue;
-			u32 vi = vm->m_area.index(p);
-			if (vm->m_flags[vi] & VMANIP_FLAG_DUNGEON_UNTOUCHABLE)
-				continue;
-			vm->m_data[vi] = n_wall;
+	if (inside(roomplace.Z, area.MinEdge.Z, area.MaxEdge.Z)) {
+		const bool far_inside = inside(roommax.Z, area.MinEdge.Z, area.MaxEdge.Z);
+		const u32 far_offset = (roomsize.Z - 1) * zstride;
+		for (s16 y = pmin.Y; y <= pmax.Y; y++) {
+			u32 vi = area.index(pmin.X, y, roomplace.Z);
+			for (s16 x = pmin.X; x <= pmax.X; x++, vi++) {
+				if (place_wall(vi) && far_inside)
+					place_wall(vi + far_offset);
+			}
 		}
 	}
 
 	// Make +-Y walls (floor and ceiling)
-	for (s16 z = 0; z < roomsize.Z; z++)
-	for (s16 x = 0; x < roomsize.X; x++) {
-		{
-			v3s16 p = roomplace + v3s16(x, 0, z);
-			if (!vm->m_area.contains(p))
-				continue;
-			u32 vi = vm->m_area.index(p);
-			if (vm->m_flags[vi] & VMANIP_FLAG_DUNGEON_UNTOUCHABLE)
-				continue;
-			vm->m_data[vi] = n_wall;
-		}
-		{
-			v3s16 p = roomplace + v3s16(x,roomsize. Y - 1, z);
-			if (!vm->m_area.contains(p))
-				continue;
-			u32 vi = vm->m_area.index(p);
-			if (vm->m_flags[vi] & VMANIP_FLAG_DUNGEON_UNTOUCHABLE)
-				continue;
-			vm->m_data[vi] = n_wall;
+	if (inside(roomplace.Y, area.MinEdge.Y, area.MaxEdge.Y)) {
+		const bool far_inside = inside(roommax.Y, area.MinEdge.Y, area.MaxEdge.Y);
+		const u32 far_offset = (roomsize.Y - 1) * ystride;
+		for (s16 z = pmin.Z; z <= pmax.Z; z++) {
+			u32 vi = area.index(pmin.X, roomplace.Y, z);
+			for (s16 x = pmin.X; x <= pmax.X; x++, vi++) {
+				if (place_wall(vi) && far_inside)
+					place_wall(vi + far_offset);
+			}
 		}
 	}
 
 	// Fill with air
-	for (s16 z = 1; z < roomsize.Z - 1; z++)
-	for (s16 y = 1; y < roomsize.Y - 1; y++)
-	for (s16 x = 1; x < roomsize.X - 1; x++) {
-		v3s16 p = roomplace + v3s16(x, y, z);
-		if (!vm->m_area.contains(p))
-			continue;
-		u32 vi = vm->m_area.index(p);
-		vm->m_flags[vi] |= VMANIP_FLAG_DUNGEON_UNTOUCHABLE;
-		vm->m_data[vi] = n_air;
+	const v3s16 fmin = componentwise_max(roomplace + 1, area.MinEdge);
+	const v3s16 fmax = componentwise_min(roommax - 1, area.MaxEdge);
+	for (s16 z = fmin.Z; z <= fmax.Z; z++)
+	for (s16 y = fmin.Y; y <= fmax.Y; y++) {
+		u32 vi = area.index(fmin.X, y, z);
+		for (s16 x = fmin.X; x <= fmax.X; x++, vi++) {
+			vm->m_flags[vi] |= VMANIP_FLAG_DUNGEON_UNTOUCHABLE;
+			vm->m_data[vi] = n_air;
+		}
 	}
 }
 
@@ -349,17 +353,19 @@ void DungeonGen::makeRoom(v3s16 roomsize, v3s16 roomplace)
 void DungeonGen::makeFill(v3s16 place, v3s16 size,
 	u8 avoid_flags, MapNode n, u8 or_flags)
 {
-	for (s16 z = 0; z < size.Z; z++)
-	for (s16 y = 0; y < size.Y; y++)
-	for (s16 x = 0; x < size.X; x++) {
-		v3s16 p = place + v3s16(x, y, z);
-		if (!vm->m_area.contains(p))
-			continue;
-		u32 vi = vm->m_area.index(p);
-		if (vm->m_flags[vi] & avoid_flags)
-			continue;
-		vm->m_flags[vi] |= or_flags;
-		vm->m_data[vi] = n;
+	const VoxelArea &area = vm->m_area;
+	const v3s16 pmin = componentwise_max(place, area.MinEdge);
+	const v3s16 pmax = componentwise_min(place + size - 1, area.MaxEdge);
+
+	for (s16 z = pmin.Z; z <= pmax.Z; z++)
+	for (s16 y = pmin.Y; y <= pmax.Y; y++) {
+		u32 vi = area.index(pmin.X, y, z);
+		for (s16 x = pmin.X; x <= pmax.X; x++, vi++) {
+			if (vm->m_flags[vi] & avoid_flags)
+				continue;
+			vm->m_flags[vi] |= or_flags;
+			vm->m_data[vi] = n;
+		}
 	}
 }
 
@@ -488,6 +494,8 @@ void DungeonGen::makeCorridor(v3s16 doorplace, v3s16 doordir,
 
 bool DungeonGen::findPlaceForDoor(v3s16 &result_place, v3s16 &result_dir)
 {
+	const u32 ystride = vm->m_area.getExtent().X;
+
 	for (u32 i = 0; i < 100; i++) {
 		v3s16 p = m_pos + m_dir;
 		v3s16 p1 = p + v3s16(0, 1, 0);
@@ -495,8 +503,21 @@ bool DungeonGen::findPlaceForDoor(v3s16 &result_place, v3s16 &result_dir)
 			randomizeDir();
 			continue;
 		}
-		if (vm->getNodeNoExNoEmerge(p).getContent() == dp.c_wall &&
-				vm->getNodeNoExNoEmerge(p1).getContent() == dp.c_wall) {
+		// The walker only looks at the nodes from one below to two above p,
+		// they are read at once
+		content_t column[4];
+		u32 vi = vm->m_area.index(p.X, p.Y - 1, p.Z);
+		for (s16 k = 0; k < 4; k++, vi += ystride) {
+			s16 y = p.Y - 1 + k;
+			if (y < vm->m_area.MinEdge.Y || y > vm->m_area.MaxEdge.Y ||
+					(vm->m_flags[vi] & VOXELFLAG_NO_DATA))
+				column[k] = CONTENT_IGNORE;
+			else
+				column[k] = vm->m_data[vi].getContent();
+		}
+		auto at = [&column] (s16 dy) { return column[dy + 1]; };
+
+		if (at(0) == dp.c_wall && at(1) == dp.c_wall) {
 			// Found wall, this is a good place!
 			result_place = p;
 			result_dir = m_dir;
@@ -507,32 +528,23 @@ bool DungeonGen::findPlaceForDoor(v3s16 &result_place, v3s16 &result_dir)
 		/*
 			Determine where to move next
 		*/
+		s16 dy = 0;
 		// Jump one up if the actual space is there
-		if (vm->getNodeNoExNoEmerge(p +
-				v3s16(0, 0, 0)).getContent() == dp.c_wall &&
-				vm->getNodeNoExNoEmerge(p +
-				v3s16(0, 1, 0)).getContent() == CONTENT_AIR &&
-				vm->getNodeNoExNoEmerge(p +
-				v3s16(0, 2, 0)).getContent() == CONTENT_AIR)
-			p += v3s16(0,1,0);
+		if (at(dy) == dp.c_wall && at(dy + 1) == CONTENT_AIR &&
+				at(dy + 2) == CONTENT_AIR)
+			dy++;
 		// Jump one down if the actual space is there
-		if (vm->getNodeNoExNoEmerge(p +
-				v3s16(0, 1, 0)).getContent() == dp.c_wall &&
-				vm->getNodeNoExNoEmerge(p +
-				v3s16(0, 0, 0)).getContent() == CONTENT_AIR &&
-				vm->getNodeNoExNoEmerge(p +
-				v3s16(0, -1, 0)).getContent() == CONTENT_AIR)
-			p += v3s16(0, -1, 0);
+		if (at(dy + 1) == dp.c_wall && at(dy) == CONTENT_AIR &&
+				at(dy - 1) == CONTENT_AIR)
+			dy--;
 		// Check if walking is now possible
-		if (vm->getNodeNoExNoEmerge(p).getContent() != CONTENT_AIR ||
-				vm->getNodeNoExNoEmerge(p +
-				v3s16(0, 1, 0)).getContent() != CONTENT_AIR) {
+		if (at(dy) != CONTENT_AIR || at(dy + 1) != CONTENT_AIR) {
 			// Cannot continue walking here
 			randomizeDir();
 			continue;
 		}
 		// Move there
-		m_pos = p;
+		m_pos = p + v3s16(0, dy, 0);
 	}
 	return false;
 }
@@ -562,19 +574,22 @@ bool DungeonGen::findPlaceForRoomDoor(v3s16 roomsize, v3s16 &result_doorplace,
 			roomplace = doorplace +
 				v3s16(random.range(-roomsize.X + 2, -2), -1, -roomsize.Z + 1);
 
-		// Check fit
+		// Check fit: the inside of the room must be in the voxel manipulator
+		// and not overlap other rooms or corridors
+		const v3s16 fmin = roomplace + 1;
+		const v3s16 fmax = roomplace + roomsize - 2;
 		bool fits = true;
-		for (s16 z = 1; z < roomsize.Z - 1; z++)
-		for (s16 y = 1; y < roomsize.Y - 1; y++)
-		for (s16 x = 1; x < roomsize.X - 1; x++) {
-			v3s16 p = roomplace + v3s16(x, y, z);
-			if (!vm->m_area.contains(p)) {
-				fits = false;
-				break;
-			}
-			if (vm->m_flags[vm->m_area.index(p)] & VMANIP_FLAG_DUNGEON_INSIDE) {
-				fits = false;
-				break;
+		if (fmin.X <= fmax.X && fmin.Y <= fmax.Y && fmin.Z <= fmax.Z) {
+			fits = vm->m_area.contains(fmin) && vm->m_area.contains(fmax);
+			for (s16 z = fmin.Z; z <= fmax.Z && fits; z++)
+			for (s16 y = fmin.Y; y <= fmax.Y && fits; y++) {
+				u32 vi = vm->m_area.index(fmin.X, y, z);
+				for (s16 x = fmin.X; x <= fmax.X; x++, vi++) {
+					if (vm->m_flags[vi] & VMANIP_FLAG_DUNGEON_INSIDE) {
+						fits = false;
+						break;
+					}
+				}
 			}
 		}
 		if (!fits) {
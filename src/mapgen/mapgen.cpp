@@ -352,6 +352,8 @@ inline bool Mapgen::isLiquidHorizontallyFlowable(u32 vi, v3s32 em)
 
 void Mapgen::updateLiquid(UniqueQueue<v3s16> *trans_liquid, v3s16 nmin, v3s16 nmax)
 {
+	ScopeProfiler sp(g_profiler, "EmergeThread: update liquids", SPT_AVG, PRECISION_MICRO);
+
 	bool isignored, isliquid, wasignored, wasliquid, waschecked, waspushed;
 	content_t was_n;
 	const v3s32 &em = vm->m_area.getExtent();
@@ -413,7 +415,8 @@ void Mapgen::updateLiquid(UniqueQueue<v3s16> *trans_liquid, v3s16 nmin, v3s16 nm
 
 void Mapgen::setLighting(u8 light, v3s16 nmin, v3s16 nmax)
 {
-	ScopeProfiler sp(g_profiler, "EmergeThread: update lighting", SPT_AVG);
+	ScopeProfiler sp(g_profiler, "EmergeThread: set lighting", SPT_AVG, PRECISION_MICRO);
+
 	VoxelArea a(nmin, nmax);
 
 	for (int z = a.MinEdge.Z; z <= a.MaxEdge.Z; z++) {
@@ -426,47 +429,10 @@ void Mapgen::setLighting(u8 light, v3s16 nmin, v3s16 nmax)
 }
 
 
-void Mapgen::lightSpread(VoxelArea &a, std::queue<std::pair<v3s16, u8>> &queue,
-	const v3s16 &p, u8 light)
-{
-	if (light <= 1 || !a.contains(p))
-		return;
-
-	u32 vi = vm->m_area.index(p);
-	MapNode &n = vm->m_data[vi];
-
-	// Decay light in each of the banks separately
-	u8 light_day = light & 0x0F;
-	if (light_day > 0)
-		light_day -= 0x01;
-
-	u8 light_night = light & 0xF0;
-	if (light_night > 0)
-		light_night -= 0x10;
-
-	// Bail out only if we have no more light from either bank to propogate, or
-	// we hit a solid block that light cannot pass through.
-	if ((light_day  <= (n.param1 & 0x0F) &&
-			light_night <= (n.param1 & 0xF0)) ||
-			!ndef->getLightingFlags(n).light_propagates)
-		return;
-
-	// MYMAX still needed here because we only exit early if both banks have
-	// nothing to propagate anymore.
-	light = MYMAX(light_day, n.param1 & 0x0F) |
-			MYMAX(light_night, n.param1 & 0xF0);
-
-	n.param1 = light;
-
-	// add to queue
-	queue.emplace(p, light);
-}
-
-
 void Mapgen::calcLighting(v3s16 nmin, v3s16 nmax, v3s16 full_nmin, v3s16 full_nmax,
 	bool propagate_shadow)
 {
-	ScopeProfiler sp(g_profiler, "EmergeThread: update lighting", SPT_AVG);
+	ScopeProfiler sp(g_profiler, "EmergeThread: update lighting", SPT_AVG, PRECISION_MICRO);
 
 	propagateSunlight(nmin, nmax, propagate_shadow);
 	spreadLight(full_nmin, full_nmax);
@@ -475,85 +441,15 @@ void Mapgen::calcLighting(v3s16 nmin, v3s16 nmax, v3s16 full_nmin, v3s16 full_nm
 
 void Mapgen::propagateSunlight(v3s16 nmin, v3s16 nmax, bool propagate_shadow)
 {
-	//TimeTaker t("propagateSunlight");
-	VoxelArea a(nmin, nmax);
 	bool block_is_underground = (water_level >= nmax.Y);
-	const v3s32 &em = vm->m_area.getExtent();
-
-	// NOTE: Direct access to the low 4 bits of param1 is okay here because,
-	// by definition, sunlight will never be in the night lightbank.
-
-	for (int z = a.MinEdge.Z; z <= a.MaxEdge.Z; z++) {
-		for (int x = a.MinEdge.X; x <= a.MaxEdge.X; x++) {
-			// see if we can get a light value from the overtop
-			u32 i = vm->m_area.index(x, a.MaxEdge.Y + 1, z);
-			if (vm->m_data[i].getContent() == CONTENT_IGNORE) {
-				if (block_is_underground)
-					continue;
-			} else if ((vm->m_data[i].param1 & 0x0F) != LIGHT_SUN &&
-					propagate_shadow) {
-				continue;
-			}
-			VoxelArea::add_y(em, i, -1);
-
-			for (int y = a.MaxEdge.Y; y >= a.MinEdge.Y; y--) {
-				MapNode &n = vm->m_data[i];
-				if (!ndef->getLightingFlags(n).sunlight_propagates)
-					break;
-				n.param1 = LIGHT_SUN;
-				VoxelArea::add_y(em, i, -1);
-			}
-		}
-	}
-	//printf("propagateSunlight: %dms\n", t.stop());
+	voxalgo::propagate_sunlight(vm, ndef, VoxelArea(nmin, nmax),
+		block_is_underground, propagate_shadow);
 }
 
 
 void Mapgen::spreadLight(const v3s16 &nmin, const v3s16 &nmax)
 {
-	//TimeTaker t("spreadLight");
-	std::queue<std::pair<v3s16, u8>> queue;
-	VoxelArea a(nmin, nmax);
-
-	for (int z = a.MinEdge.Z; z <= a.MaxEdge.Z; z++) {
-		for (int y = a.MinEdge.Y; y <= a.MaxEdge.Y; y++) {
-			u32 i = vm->m_area.index(a.MinEdge.X, y, z);
-			for (int x = a.MinEdge.X; x <= a.MaxEdge.X; x++, i++) {
-				MapNode &n = vm->m_data[i];
-				if (n.getContent() == CONTENT_IGNORE)
-					continue;
-
-				ContentLightingFlags cf = ndef->getLightingFlags(n);
-				if (!cf.light_propagates)
-					continue;
-
-				// TODO(hmmmmm): Abstract away direct param1 accesses with a
-				// wrapper, but something lighter than MapNode::get/setLight
-
-				u8 light_produced = cf.light_source;
-				if (light_produced)
-					n.param1 = light_produced | (light_produced << 4);
-
-				u8 light = n.param1;
-				if (light) {
-					const v3s16 p(x, y, z);
-					// spread to all 6 neighbor nodes
-					for (const auto &dir : g_6dirs)
-						lightSpread(a, queue, p + dir, light);
-				}
-			}
-		}
-	}
-
-	while (!queue.empty()) {
-		const auto &i = queue.front();
-		// spread to all 6 neighbor nodes
-		for (const auto &dir : g_6dirs)
-			lightSpread(a, queue, i.first + dir, i.second);
-		queue.pop();
-	}
-
-	//printf("spreadLight: %lums\n", t.stop());
+	voxalgo::spread_light(vm, ndef, VoxelArea(nmin, nmax));
 }
 
 
@@ -622,6 +518,8 @@ MapgenBasic::~MapgenBasic()
 
 void MapgenBasic::generateBiomes()
 {
+	ScopeProfiler sp(g_profiler, "EmergeThread: generate biomes", SPT_AVG, PRECISION_MICRO);
+
 	// can't generate biomes without a biome generator!
 	assert(biomegen);
 	assert(biomemap);
@@ -768,6 +666,8 @@ void MapgenBasic::generateBiomes()
 
 void MapgenBasic::dustTopNodes()
 {
+	ScopeProfiler sp(g_profiler, "EmergeThread: dust top nodes", SPT_AVG, PRECISION_MICRO);
+
 	if (node_max.Y < water_level)
 		return;
 
@@ -832,6 +732,8 @@ void MapgenBasic::dustTopNodes()
 
 void MapgenBasic::generateCavesNoiseIntersection(s16 max_stone_y)
 {
+	ScopeProfiler sp(g_profiler, "EmergeThread: generate caves (noise)", SPT_AVG, PRECISION_MICRO);
+
 	// cave_width >= 10 is used to disable generation and avoid the intensive
 	// 3D noise calculations. Tunnels already have zero width when cave_width > 1.
 	if (node_min.Y > max_stone_y || cave_width >= 10.0f)
@@ -846,6 +748,8 @@ void MapgenBasic::generateCavesNoiseIntersection(s16 max_stone_y)
 
 void MapgenBasic::generateCavesRandomWalk(s16 max_stone_y, s16 large_cave_ymax)
 {
+	ScopeProfiler sp(g_profiler, "EmergeThread: generate caves (random walk)", SPT_AVG, PRECISION_MICRO);
+
 	if (node_min.Y > max_stone_y)
 		return;
 
@@ -877,6 +781,8 @@ void MapgenBasic::generateCavesRandomWalk(s16 max_stone_y, s16 large_cave_ymax)
 
 bool MapgenBasic::generateCavernsNoise(s16 max_stone_y)
 {
+	ScopeProfiler sp(g_profiler, "EmergeThread: generate caverns", SPT_AVG, PRECISION_MICRO);
+
 	if (node_min.Y > max_stone_y || node_min.Y > cavern_limit)
 		return false;
 
@@ -889,6 +795,8 @@ bool MapgenBasic::generateCavernsNoise(s16 max_stone_y)
 
 void MapgenBasic::generateDungeons(s16 max_stone_y)
 {
+	ScopeProfiler sp(g_profiler, "EmergeThread: generate dungeons", SPT_AVG, PRECISION_MICRO);
+
 	if (node_min.Y > max_stone_y || node_min.Y > dungeon_ymax ||
 			node_max.Y < dungeon_ymin)
 		return;
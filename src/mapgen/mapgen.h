@@ -241,18 +241,6 @@ class Mapgen {
 	static void setDefaultSettings(Settings *settings);
 
 private:
-	/**
-	 * Spread light to the node at the given position, add to queue if changed.
-	 * The given light value is diminished once.
-	 * @param a VoxelArea being operated on
-	 * @param queue Queue for later lightSpread() calls
-	 * @param p Node position
-	 * @param light Light value (contains both banks)
-	 *
-	 */
-	void lightSpread(VoxelArea &a, std::queue<std::pair<v3s16, u8>> &queue,
-		const v3s16 &p, u8 light);
-
 	// isLiquidHorizontallyFlowable() is a helper function for updateLiquid()
 	// that checks whether there are floodable nodes without liquid beneath
 	// the node at index vi.
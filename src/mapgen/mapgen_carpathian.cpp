@@ -12,7 +12,7 @@
 #include "map.h"
 #include "nodedef.h"
 #include "voxelalgorithms.h"
-//#include "profiler.h" // For TimeTaker
+#include "profiler.h"
 #include "settings.h" // For g_settings
 #include "emerge.h"
 #include "dungeongen.h"
@@ -423,6 +423,8 @@ int MapgenCarpathian::getSpawnLevelAtPoint(v2s16 p)
 
 int MapgenCarpathian::generateTerrain()
 {
+	ScopeProfiler sp(g_profiler, "EmergeThread: generate terrain", SPT_AVG, PRECISION_MICRO);
+
 	MapNode mn_air(CONTENT_AIR);
 	MapNode mn_stone(c_stone);
 	MapNode mn_water(c_water_source);
@@ -11,7 +11,7 @@
 #include "map.h"
 #include "nodedef.h"
 #include "voxelalgorithms.h"
-//#include "profiler.h" // For TimeTaker
+#include "profiler.h"
 #include "settings.h" // For g_settings
 #include "emerge.h"
 #include "dungeongen.h"
@@ -273,6 +273,8 @@ void MapgenFlat::makeChunk(BlockMakeData *data)
 
 s16 MapgenFlat::generateTerrain()
 {
+	ScopeProfiler sp(g_profiler, "EmergeThread: generate terrain", SPT_AVG, PRECISION_MICRO);
+
 	MapNode n_air(CONTENT_AIR);
 	MapNode n_stone(c_stone);
 	MapNode n_water(c_water_source);
@@ -13,7 +13,7 @@
 #include "map.h"
 #include "nodedef.h"
 #include "voxelalgorithms.h"
-//#include "profiler.h" // For TimeTaker
+#include "profiler.h"
 #include "settings.h" // For g_settings
 #include "emerge.h"
 #include "dungeongen.h"
@@ -662,6 +662,8 @@ void MapgenV6::calculateNoise()
 
 int MapgenV6::generateGround()
 {
+	ScopeProfiler sp(g_profiler, "EmergeThread: generate terrain", SPT_AVG, PRECISION_MICRO);
+
 	//TimeTaker timer1("Generating ground level");
 	MapNode n_air(CONTENT_AIR), n_water_source(c_water_source);
 	MapNode n_stone(c_stone), n_desert_stone(c_desert_stone);
@@ -1086,6 +1088,8 @@ void MapgenV6::growGrass() // Add surface nodes
 
 void MapgenV6::generateCaves(int max_stone_y)
 {
+	ScopeProfiler sp(g_profiler, "EmergeThread: generate caves", SPT_AVG, PRECISION_MICRO);
+
 	float cave_amount = NoiseFractal2D(np_cave, node_min.X, node_min.Y, seed);
 	int volume_nodes = (node_max.X - node_min.X + 1) *
 					   (node_max.Y - node_min.Y + 1) * MAP_BLOCKSIZE;
@@ -8,9 +8,80 @@
 #include "emerge.h"
 #include "server.h"
 #include "nodedef.h"
+#include "profiler.h"
 #include "settings.h"
+#include "threading/mutex_auto_lock.h"
+#include "util/container.h"
 
 #include <algorithm>
+#include <mutex>
+
+///////////////////////////////////////////////////////////////////////////////
+
+BiomeMapContents::BiomeMapContents(const biome_t *biomemap, size_t count)
+{
+	if (!biomemap) {
+		m_all = true;
+		return;
+	}
+	for (size_t i = 0; i < count; i++) {
+		biome_t id = biomemap[i];
+		if (id >= m_present.size())
+			m_present.resize(id + 1);
+		m_present[id] = true;
+	}
+}
+
+bool BiomeMapContents::containsAny(const std::unordered_set<biome_t> &biomes) const
+{
+	if (m_all || biomes.empty())
+		return true;
+	for (biome_t id : biomes) {
+		if (id < m_present.size() && m_present[id])
+			return true;
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+class BiomeNoiseCache
+{
+public:
+	BiomeNoiseCache() :
+		m_cache(64, [] (void *, const v2s16 &, Column *) {}, nullptr)
+	{}
+
+	// Copies the cached noise of the column into heat and humidity
+	bool get(v2s16 column, float *heat, float *humidity, size_t count)
+	{
+		MutexAutoLock lock(m_mutex);
+		const Column *c = m_cache.lookupCache(column);
+		// a miss leaves an empty entry behind, put() fills it
+		if (c->heat.size() != count)
+			return false;
+		std::copy(c->heat.begin(), c->heat.end(), heat);
+		std::copy(c->humidity.begin(), c->humidity.end(), humidity);
+		return true;
+	}
+
+	void put(v2s16 column, const float *heat, const float *humidity, size_t count)
+	{
+		MutexAutoLock lock(m_mutex);
+		Column *c = m_cache.lookupCache(column);
+		c->heat.assign(heat, heat + count);
+		c->humidity.assign(humidity, humidity + count);
+	}
+
+private:
+	struct Column {
+		std::vector<float> heat;
+		std::vector<float> humidity;
+	};
+
+	std::mutex m_mutex;
+	LRUCache<v2s16, Column> m_cache;
+};
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -114,6 +185,8 @@ BiomeGenOriginal::BiomeGenOriginal(BiomeManager *biomemgr,
 	heatmap  = noise_heat->result;
 	humidmap = noise_humidity->result;
 
+	m_noise_cache = std::make_shared<BiomeNoiseCache>();
+
 	biomemap = new biome_t[m_csize.X * m_csize.Z];
 	// Initialise with the ID of 'BIOME_NONE' so that cavegen can get the
 	// fallback biome when biome generation (which calculates the biomemap IDs)
@@ -157,7 +230,9 @@ s16 BiomeGenOriginal::getNextTransitionY(s16 y) const
 
 BiomeGen *BiomeGenOriginal::clone(BiomeManager *biomemgr) const
 {
-	return new BiomeGenOriginal(biomemgr, m_params, m_csize);
+	auto *ret = new BiomeGenOriginal(biomemgr, m_params, m_csize);
+	ret->m_noise_cache = m_noise_cache;
+	return ret;
 }
 
 float BiomeGenOriginal::calcHeatAtPoint(v3s16 pos) const
@@ -180,17 +255,26 @@ Biome *BiomeGenOriginal::calcBiomeAtPoint(v3s16 pos) const
 
 void BiomeGenOriginal::calcBiomeNoise(v3s16 pmin)
 {
+	ScopeProfiler sp(g_profiler, "EmergeThread: biome noise", SPT_AVG, PRECISION_MICRO);
+
 	m_pmin = pmin;
 
+	const v2s16 column(pmin.X, pmin.Z);
+	const size_t count = m_csize.X * m_csize.Z;
+	if (m_noise_cache->get(column, noise_heat->result, noise_humidity->result, count))
+		return;
+
 	noise_heat->noiseMap2D(pmin.X, pmin.Z);
 	noise_humidity->noiseMap2D(pmin.X, pmin.Z);
 	noise_heat_blend->noiseMap2D(pmin.X, pmin.Z);
 	noise_humidity_blend->noiseMap2D(pmin.X, pmin.Z);
 
-	for (s32 i = 0; i < m_csize.X * m_csize.Z; i++) {
+	for (size_t i = 0; i < count; i++) {
 		noise_heat->result[i]     += noise_heat_blend->result[i];
 		noise_humidity->result[i] += noise_humidity_blend->result[i];
 	}
+
+	m_noise_cache->put(column, noise_heat->result, noise_humidity->result, count);
 }
 
 
@@ -5,6 +5,9 @@
 
 #pragma once
 
+#include <memory>
+#include <unordered_set>
+#include <vector>
 #include "constants.h"
 #include "objdef.h"
 #include "nodedef.h"
@@ -14,6 +17,7 @@
 class Server;
 class Settings;
 class BiomeManager;
+class BiomeNoiseCache;
 
 ////
 //// Biome
@@ -67,6 +71,22 @@ class Biome : public ObjDef, public NodeResolver {
 	virtual void resolveNodeNames();
 };
 
+/*
+ * Which biomes occur in a biome map. Ores and decorations limited to
+ * biomes that don't occur can skip the whole area.
+ */
+class BiomeMapContents {
+public:
+	// biomemap may be null, then every biome is considered present
+	BiomeMapContents(const biome_t *biomemap, size_t count);
+
+	bool containsAny(const std::unordered_set<biome_t> &biomes) const;
+
+private:
+	std::vector<bool> m_present;
+	bool m_all = false;
+};
+
 
 ////
 //// BiomeGen
@@ -194,6 +214,10 @@ class BiomeGenOriginal final : public BiomeGen {
 private:
 	const BiomeParamsOriginal *m_params;
 
+	// Heat and humidity only depend on X and Z, so chunks stacked on top of
+	// each other can share them. Shared with all clones.
+	std::shared_ptr<BiomeNoiseCache> m_noise_cache;
+
 	Noise *noise_heat;
 	Noise *noise_humidity;
 	Noise *noise_heat_blend;
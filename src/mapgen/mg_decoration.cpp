@@ -6,8 +6,10 @@
 #include "mg_decoration.h"
 #include "mg_schematic.h"
 #include "mapgen.h"
+#include "mg_biome.h"
 #include "noise.h"
 #include "map.h"
+#include "profiler.h"
 #include <algorithm>
 #include <vector>
 #include "mapgen/treegen.h"
@@ -37,12 +39,20 @@ DecorationManager::DecorationManager(IGameDef *gamedef) :
 void DecorationManager::placeAllDecos(Mapgen *mg, u32 blockseed,
 	v3s16 nmin, v3s16 nmax)
 {
+	ScopeProfiler sp(g_profiler, "EmergeThread: place decorations", SPT_AVG, PRECISION_MICRO);
+
+	// Every decoration has its own random generator, so skipping one that
+	// can't be placed anyway doesn't change the others.
+	const BiomeMapContents biomes_present(mg->biomemap,
+		(nmax.X - nmin.X + 1) * (nmax.Z - nmin.Z + 1));
+
 	for (size_t i = 0; i != m_objects.size(); i++) {
 		Decoration *deco = (Decoration *)m_objects[i];
 		if (!deco)
 			continue;
 
-		deco->placeDeco(mg, blockseed, nmin, nmax);
+		if (biomes_present.containsAny(deco->biomes))
+			deco->placeDeco(mg, blockseed, nmin, nmax);
 		blockseed++;
 	}
 }
@@ -142,6 +152,10 @@ void Decoration::placeDeco(Mapgen *mg, u32 blockseed, v3s16 nmin, v3s16 nmax)
 
 	int area = sidelen * sidelen;
 
+	// For all-surfaces decorations
+	std::vector<s16> floors;
+	std::vector<s16> ceilings;
+
 	for (s16 z0 = 0; z0 < carea_size; z0 += sidelen)
 	for (s16 x0 = 0; x0 < carea_size; x0 += sidelen) {
 		v2s16 p2d_min(nmin.X + x0, nmin.Z + z0);
@@ -197,12 +211,8 @@ void Decoration::placeDeco(Mapgen *mg, u32 blockseed, v3s16 nmin, v3s16 nmax)
 				}
 
 				// Get all floors and ceilings in node column
-				u16 size = (nmax.Y - nmin.Y + 1) / 2;
-				std::vector<s16> floors;
-				std::vector<s16> ceilings;
-				floors.reserve(size);
-				ceilings.reserve(size);
-
+				floors.clear();
+				ceilings.clear();
 				mg->getSurfaces(v2s16(x, z), nmin.Y, nmax.Y, floors, ceilings);
 
 				if (flags & DECO_ALL_FLOORS) {
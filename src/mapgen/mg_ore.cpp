@@ -5,8 +5,10 @@
 
 #include "mg_ore.h"
 #include "mapgen.h"
+#include "mg_biome.h"
 #include "noise.h"
 #include "map.h"
+#include "profiler.h"
 #include <cmath>
 #include <algorithm>
 
@@ -30,14 +32,22 @@ OreManager::OreManager(IGameDef *gamedef) :
 
 size_t OreManager::placeAllOres(Mapgen *mg, u32 blockseed, v3s16 nmin, v3s16 nmax)
 {
+	ScopeProfiler sp(g_profiler, "EmergeThread: place ores", SPT_AVG, PRECISION_MICRO);
+
 	size_t nplaced = 0;
 
+	// Ores only use the seed they are given, so skipping one that can't be
+	// placed anyway doesn't change the others.
+	const BiomeMapContents biomes_present(mg->biomemap,
+		(nmax.X - nmin.X + 1) * (nmax.Z - nmin.Z + 1));
+
 	for (size_t i = 0; i != m_objects.size(); i++) {
 		Ore *ore = (Ore *)m_objects[i];
 		if (!ore)
 			continue;
 
-		nplaced += ore->placeOre(mg, blockseed, nmin, nmax);
+		if (biomes_present.containsAny(ore->biomes))
+			nplaced += ore->placeOre(mg, blockseed, nmin, nmax);
 		blockseed++;
 	}
 
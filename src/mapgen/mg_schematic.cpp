@@ -18,6 +18,7 @@
 #include "filesys.h"
 #include "voxelalgorithms.h"
 #include "porting.h"
+#include "threading/mutex_auto_lock.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -106,6 +107,7 @@ void Schematic::resolveNodeNames()
 		// Unfold condensed ID layout to content_t
 		schemdata[i].setContent(c_nodes[c_original]);
 	}
+	invalidatePlans();
 }
 
 
@@ -114,6 +116,78 @@ void Schematic::blitToVManip(MMVManip *vm, v3s16 p, Rotation rot, bool force_pla
 	assert(schemdata && slice_probs);
 	sanity_check(m_ndef != NULL);
 
+	// Keeps the plan alive even if the schematic is changed meanwhile
+	const std::shared_ptr<const Plan> plan_ref = getPlan(rot);
+	const Plan &plan = *plan_ref;
+	const VoxelArea &area = vm->m_area;
+
+	s16 y_map = p.Y;
+	for (s16 y = 0; y != plan.size.Y; y++) {
+		// Skipped slices don't take up space, the ones above move down
+		if ((slice_probs[y] != MTSCHEM_PROB_ALWAYS) &&
+			(slice_probs[y] <= myrand_range(1, MTSCHEM_PROB_ALWAYS)))
+			continue;
+
+		const s16 y_slice = y_map++;
+		if (y_slice < area.MinEdge.Y || y_slice > area.MaxEdge.Y)
+			continue;
+
+		for (u32 si = plan.slices[y]; si != plan.slices[y + 1]; si++) {
+			const Plan::Span &span = plan.spans[si];
+			s32 z_map = p.Z + span.z;
+			if (z_map < area.MinEdge.Z || z_map > area.MaxEdge.Z)
+				continue;
+
+			// Clip the span to the voxel area
+			s32 x_map = p.X + span.x;
+			s32 begin = std::max<s32>(area.MinEdge.X - x_map, 0);
+			s32 end = std::min<s32>(area.MaxEdge.X - x_map + 1, span.length);
+			if (begin >= end)
+				continue;
+
+			const MapNode *src = &plan.nodes[span.first];
+			u32 vi = area.index(x_map + begin, y_slice, z_map);
+
+			if (span.always && (force_place || span.forced)) {
+				std::copy(src + begin, src + end, &vm->m_data[vi]);
+				continue;
+			}
+
+			const u8 *param1 = &plan.param1[span.first];
+			for (s32 x = begin; x != end; x++, vi++) {
+				if (!force_place && !(param1[x] & MTSCHEM_FORCE_PLACE)) {
+					content_t c = vm->m_data[vi].getContent();
+					if (c != CONTENT_AIR && c != CONTENT_IGNORE)
+						continue;
+				}
+
+				u8 placement_prob = param1[x] & MTSCHEM_PROB_MASK;
+				if ((placement_prob != MTSCHEM_PROB_ALWAYS) &&
+					(placement_prob <= myrand_range(1, MTSCHEM_PROB_ALWAYS)))
+					continue;
+
+				vm->m_data[vi] = src[x];
+			}
+		}
+	}
+}
+
+
+std::shared_ptr<const Schematic::Plan> Schematic::getPlan(Rotation rot)
+{
+	assert(rot >= ROTATE_0 && rot <= ROTATE_270);
+
+	// Decorations and mods may place the same schematic from several threads
+	MutexAutoLock lock(m_plans_mutex);
+	std::shared_ptr<const Plan> &plan = m_plans[rot];
+	if (!plan)
+		plan = buildPlan(rot);
+	return plan;
+}
+
+
+std::unique_ptr<Schematic::Plan> Schematic::buildPlan(Rotation rot) const
+{
 	int xstride = 1;
 	int ystride = size.X;
 	int zstride = size.X * size.Y;
@@ -147,48 +221,57 @@ void Schematic::blitToVManip(MMVManip *vm, v3s16 p, Rotation rot, bool force_pla
 			i_step_z = zstride;
 	}
 
-	s16 y_map = p.Y;
-	for (s16 y = 0; y != sy; y++) {
-		if ((slice_probs[y] != MTSCHEM_PROB_ALWAYS) &&
-			(slice_probs[y] <= myrand_range(1, MTSCHEM_PROB_ALWAYS)))
-			continue;
+	auto plan = std::make_unique<Plan>();
+	plan->size = v3s16(sx, sy, sz);
+	plan->slices.reserve(sy + 1);
 
+	Plan::Span *span = nullptr;
+	for (s16 y = 0; y != sy; y++) {
+		plan->slices.push_back(plan->spans.size());
 		for (s16 z = 0; z != sz; z++) {
+			span = nullptr;
 			u32 i = z * i_step_z + y * ystride + i_start;
 			for (s16 x = 0; x != sx; x++, i += i_step_x) {
-				v3s16 pos(p.X + x, y_map, p.Z + z);
-				if (!vm->m_area.contains(pos))
-					continue;
-
-				if (schemdata[i].getContent() == CONTENT_IGNORE)
+				u8 param1 = schemdata[i].param1;
+				if (schemdata[i].getContent() == CONTENT_IGNORE ||
+						(param1 & MTSCHEM_PROB_MASK) == MTSCHEM_PROB_NEVER) {
+					span = nullptr;
 					continue;
-
-				u8 placement_prob     = schemdata[i].param1 & MTSCHEM_PROB_MASK;
-				bool force_place_node = schemdata[i].param1 & MTSCHEM_FORCE_PLACE;
-
-				if (placement_prob == MTSCHEM_PROB_NEVER)
-					continue;
-
-				u32 vi = vm->m_area.index(pos);
-				if (!force_place && !force_place_node) {
-					content_t c = vm->m_data[vi].getContent();
-					if (c != CONTENT_AIR && c != CONTENT_IGNORE)
-						continue;
 				}
 
-				if ((placement_prob != MTSCHEM_PROB_ALWAYS) &&
-					(placement_prob <= myrand_range(1, MTSCHEM_PROB_ALWAYS)))
-					continue;
-
-				vm->m_data[vi] = schemdata[i];
-				vm->m_data[vi].param1 = 0;
+				if (!span) {
+					span = &plan->spans.emplace_back();
+					span->x = x;
+					span->z = z;
+					span->length = 0;
+					span->always = true;
+					span->forced = true;
+					span->first = plan->nodes.size();
+				}
+				span->length++;
+				span->always &= (param1 & MTSCHEM_PROB_MASK) == MTSCHEM_PROB_ALWAYS;
+				span->forced &= (param1 & MTSCHEM_FORCE_PLACE) != 0;
 
+				MapNode n = schemdata[i];
+				n.param1 = 0;
 				if (rot)
-					vm->m_data[vi].rotateAlongYAxis(m_ndef, rot);
+					n.rotateAlongYAxis(m_ndef, rot);
+				plan->nodes.push_back(n);
+				plan->param1.push_back(param1);
 			}
 		}
-		y_map++;
 	}
+	plan->slices.push_back(plan->spans.size());
+
+	return plan;
+}
+
+
+void Schematic::invalidatePlans()
+{
+	MutexAutoLock lock(m_plans_mutex);
+	for (auto &plan : m_plans)
+		plan.reset();
 }
 
 
@@ -347,6 +430,7 @@ bool Schematic::deserializeFromMts(std::istream *is)
 			schemdata[i].param1 >>= 1;
 	}
 
+	invalidatePlans();
 	return true;
 }
 
@@ -560,6 +644,7 @@ bool Schematic::getSchematicFromMap(Map *map, v3s16 p1, v3s16 p2)
 
 	// Reset and mark as complete
 	NodeResolver::reset(true);
+	invalidatePlans();
 
 	return true;
 }
@@ -587,6 +672,7 @@ void Schematic::applyProbabilities(v3s16 p0,
 		if (slice < size.Y)
 			slice_probs[slice] = (*splist)[i].second;
 	}
+	invalidatePlans();
 }
 
 
@@ -5,6 +5,9 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <vector>
 #include "mg_decoration.h"
 #include "util/string.h"
 
@@ -107,8 +110,41 @@ class Schematic : public ObjDef, public NodeResolver {
 	u8 *slice_probs = nullptr;
 
 private:
+	/*
+		Placement plan of the schematic for one rotation, built on first use.
+		The nodes are stored in rotated order, already rotated and with
+		param1 cleared, and grouped into spans along X that contain no
+		ignore or never-placed nodes.
+	*/
+	struct Plan {
+		struct Span {
+			s16 x, z;      // Position of the first node, in rotated coordinates
+			u16 length;
+			bool always;   // Every node has MTSCHEM_PROB_ALWAYS
+			bool forced;   // Every node has MTSCHEM_FORCE_PLACE
+			u32 first;     // Index into nodes and param1
+		};
+
+		v3s16 size;
+		// Spans of slice y are spans[slices[y]] to spans[slices[y + 1] - 1]
+		std::vector<u32> slices;
+		std::vector<Span> spans;
+		std::vector<MapNode> nodes;
+		std::vector<u8> param1;
+	};
+
 	// Counterpart to the node resolver: Condense content_t to a sequential "m_nodenames" list
 	void condenseContentIds();
+
+	// The plan stays valid for as long as it is held, even if the
+	// schematic changes meanwhile
+	std::shared_ptr<const Plan> getPlan(Rotation rot);
+	std::unique_ptr<Plan> buildPlan(Rotation rot) const;
+	// Must be called whenever schemdata changes
+	void invalidatePlans();
+
+	std::mutex m_plans_mutex;
+	std::shared_ptr<const Plan> m_plans[4];
 };
 
 class SchematicManager : public ObjDefManager {
@@ -7,6 +7,7 @@
 #include "exceptions.h"
 #include "irr_v2d.h"
 #include "util/base64.h"
+#include "client/blockcache.h"
 #include "client/camera.h"
 #include "client/mesh_generator_thread.h"
 #include "chatmessage.h"
@@ -246,6 +247,9 @@ void Client::handleCommand_RemoveNode(NetworkPacket* pkt)
 {
 	v3s16 p;
 	*pkt >> p;
+	// The change must not be overwritten by an older block from the cache
+	if (m_block_cache && m_block_cache->hasPendingLoads())
+		receiveCachedBlocks(true);
 	removeNode(p);
 }
 
@@ -263,6 +267,8 @@ void Client::handleCommand_AddNode(NetworkPacket* pkt)
 	bool keep_metadata;
 	*pkt >> keep_metadata;
 
+	if (m_block_cache && m_block_cache->hasPendingLoads())
+		receiveCachedBlocks(true);
 	addNode(p, n, !keep_metadata);
 }
 
@@ -278,6 +284,9 @@ void Client::handleCommand_NodemetaChanged(NetworkPacket *pkt)
 	NodeMetadataList meta_updates_list(false);
 	meta_updates_list.deSerialize(sstr, m_itemdef, true);
 
+	if (m_block_cache && m_block_cache->hasPendingLoads())
+		receiveCachedBlocks(true);
+
 	Map &map = m_env.getMap();
 	for (auto i = meta_updates_list.begin();
 			i != meta_updates_list.end(); ++i) {
@@ -302,6 +311,46 @@ void Client::handleCommand_BlockData(NetworkPacket* pkt)
 	*pkt >> p;
 
 	std::string datastring(pkt->getRemainingString(), pkt->getRemainingBytes());
+	receiveBlock(p, datastring);
+
+	if (m_block_cache)
+		m_block_cache->store(p, datastring);
+}
+
+void Client::handleCommand_BlockDataCached(NetworkPacket *pkt)
+{
+	v3s16 p;
+	*pkt >> p;
+
+	// The block is passed on in receiveCachedBlocks()
+	if (!m_block_cache || !m_block_cache->requestLoad(p)) {
+		// Have the server send it again, it won't use the cache next time
+		std::vector<v3s16> blocks{p};
+		sendDeletedBlocks(blocks);
+	}
+}
+
+void Client::receiveCachedBlocks(bool wait)
+{
+	if (!m_block_cache)
+		return;
+	if (wait)
+		m_block_cache->waitLoads();
+
+	std::vector<v3s16> missing;
+	ClientBlockCache::LoadResult result;
+	while (m_block_cache->getNextLoaded(result)) {
+		if (result.ok)
+			receiveBlock(result.pos, result.data);
+		else
+			missing.push_back(result.pos);
+	}
+	if (!missing.empty())
+		sendDeletedBlocks(missing);
+}
+
+void Client::receiveBlock(v3s16 p, const std::string &datastring)
+{
 	std::istringstream istr(datastring, std::ios_base::binary);
 
 	MapSector *sector;
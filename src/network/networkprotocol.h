@@ -24,6 +24,10 @@ extern const u16 FORMSPEC_API_VERSION;
 // This is a bit lower to include safety margin.
 #define MEDIAFILE_MAX_SIZE (16700000U)
 
+// Maximum number of cached blocks the server keeps track of per client.
+// See TOSERVER_HAVE_BLOCKS.
+#define MAX_ADVERTISED_BLOCKS (65536U)
+
 typedef u16 session_t;
 
 enum ToClientCommand : u16
@@ -701,7 +705,15 @@ enum ToClientCommand : u16
 			u8[len] serialized ParticleParameters
 	*/
 
-	TOCLIENT_NUM_MSG_TYPES = 0x65,
+	TOCLIENT_BLOCKDATA_CACHED = 0x65,
+	/*
+		Sent instead of TOCLIENT_BLOCKDATA if the client advertised the
+		same block data with TOSERVER_HAVE_BLOCKS.
+
+		v3s16 position
+	*/
+
+	TOCLIENT_NUM_MSG_TYPES = 0x66,
 };
 
 enum ToServerCommand : u16
@@ -908,7 +920,18 @@ enum ToServerCommand : u16
 		v2f32 max_fs_info
 	*/
 
-	TOSERVER_NUM_MSG_TYPES = 0x54,
+	TOSERVER_HAVE_BLOCKS = 0x54,
+	/*
+		Blocks the client has cached from an earlier session, sent before
+		TOSERVER_CLIENT_READY.
+
+		u16 count
+		for each block:
+			v3s16 position
+			u64 murmur_hash_64_ua (seed 0) of the data in TOCLIENT_BLOCKDATA
+	*/
+
+	TOSERVER_NUM_MSG_TYPES = 0x55,
 };
 
 enum AuthMechanism
@@ -1834,3 +1834,22 @@ void Server::handleCommand_UpdateClientInfo(NetworkPacket *pkt)
 	RemoteClient *client = getClient(peer_id, CS_Invalid);
 	client->setDynamicInfo(info);
 }
+
+void Server::handleCommand_HaveBlocks(NetworkPacket *pkt)
+{
+	u16 count;
+	*pkt >> count;
+
+	ClientInterface::AutoLock lock(m_clients);
+	RemoteClient *client = m_clients.lockedGetClientNoEx(pkt->getPeerId(), CS_InitDone);
+	if (!client)
+		return;
+
+	client->enableBlockCache();
+	for (u16 i = 0; i < count; i++) {
+		v3s16 p;
+		u64 hash;
+		*pkt >> p >> hash;
+		client->setCachedBlock(p, hash);
+	}
+}
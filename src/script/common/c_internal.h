@@ -52,6 +52,8 @@ enum {
 	CUSTOM_RIDX_READ_NODE,
 	CUSTOM_RIDX_PUSH_NODE,
 	CUSTOM_RIDX_PUSH_MOVERESULT1,
+	// core.run_callbacks, to skip looking it up by name for every callback
+	CUSTOM_RIDX_RUN_CALLBACKS,
 };
 
 
@@ -142,6 +142,11 @@ ScriptApiBase::ScriptApiBase(ScriptingType type):
 		return 0;
 	});
 	lua_setfield(m_luastack, -2, "set_push_moveresult1");
+	lua_pushcfunction(m_luastack, [](lua_State *L) -> int {
+		lua_rawseti(L, LUA_REGISTRYINDEX, CUSTOM_RIDX_RUN_CALLBACKS);
+		return 0;
+	});
+	lua_setfield(m_luastack, -2, "set_run_callbacks");
 	// Finally, put the table into the global environment:
 	lua_setglobal(m_luastack, "core");
 
@@ -335,9 +340,13 @@ void ScriptApiBase::runCallbacksRaw(int nargs,
 	lua_insert(L, error_handler);
 
 	// Insert run_callbacks between error handler and table
-	lua_getglobal(L, "core");
-	lua_getfield(L, -1, "run_callbacks");
-	lua_remove(L, -2);
+	lua_rawgeti(L, LUA_REGISTRYINDEX, CUSTOM_RIDX_RUN_CALLBACKS);
+	if (lua_type(L, -1) != LUA_TFUNCTION) {
+		lua_pop(L, 1);
+		lua_getglobal(L, "core");
+		lua_getfield(L, -1, "run_callbacks");
+		lua_remove(L, -2);
+	}
 	lua_insert(L, error_handler + 1);
 
 	// Insert mode after table
@@ -405,8 +414,20 @@ void ScriptApiBase::setOriginDirect(const char *origin)
 void ScriptApiBase::setOriginFromTableRaw(int index, const char *fxn)
 {
 	lua_State *L = getStack();
-	m_last_run_mod = lua_istable(L, index) ?
-		getstringfield_default(L, index, "mod_origin", "") : "";
+	// Called for every entity and node callback, so assign in place to
+	// reuse the string's buffer instead of allocating a temporary.
+	if (!lua_istable(L, index)) {
+		m_last_run_mod.clear();
+		return;
+	}
+	lua_getfield(L, index, "mod_origin");
+	size_t len = 0;
+	const char *origin = lua_isstring(L, -1) ? lua_tolstring(L, -1, &len) : nullptr;
+	if (origin)
+		m_last_run_mod.assign(origin, len);
+	else
+		m_last_run_mod.clear();
+	lua_pop(L, 1);
 }
 
 /*
@@ -9,6 +9,7 @@
 #include "common/c_converter.h"
 #include "common/c_content.h"
 #include "server.h"
+#include "server/luaentity_sao.h"
 
 bool ScriptApiEntity::luaentity_Add(u16 id, const char *name)
 {
@@ -211,6 +212,26 @@ void ScriptApiEntity::luaentity_GetProperties(u16 id,
 	lua_pop(L, 1);
 }
 
+void ScriptApiEntity::luaentity_GetStepSettings(u16 id,
+		LuaEntityStepSettings *settings)
+{
+	SCRIPTAPI_PRECHECKHEADER
+
+	// Get core.luaentities[id]
+	luaentity_get(L, id);
+
+	getfloatfield(L, -1, "step_interval", settings->interval);
+	settings->interval = std::max(settings->interval, 0.0f);
+	getboolfield(L, -1, "step_on_collision", settings->on_collision);
+
+	if (getfloatfield(L, -1, "ground_friction", settings->ground_friction))
+		settings->ground_friction = std::max(settings->ground_friction, 0.0f) * BS;
+	if (getfloatfield(L, -1, "jump_on_collide", settings->jump_on_collide))
+		settings->jump_on_collide = std::max(settings->jump_on_collide, 0.0f) * BS;
+
+	lua_pop(L, 1);
+}
+
 void ScriptApiEntity::luaentity_Step(u16 id, float dtime,
 	const collisionMoveResult *moveresult)
 {
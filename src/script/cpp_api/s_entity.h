@@ -11,6 +11,7 @@
 struct ObjectProperties;
 struct ToolCapabilities;
 struct collisionMoveResult;
+struct LuaEntityStepSettings;
 
 class ScriptApiEntity
 		: virtual public ScriptApiBase
@@ -24,6 +25,7 @@ class ScriptApiEntity
 	std::string luaentity_GetStaticdata(u16 id);
 	void luaentity_GetProperties(u16 id,
 			ServerActiveObject *self, ObjectProperties *prop, const std::string &entity_name);
+	void luaentity_GetStepSettings(u16 id, LuaEntityStepSettings *settings);
 	void luaentity_Step(u16 id, float dtime,
 		const collisionMoveResult *moveresult);
 	bool luaentity_Punch(u16 id,
@@ -5,6 +5,7 @@
 #include "cpp_api/s_env.h"
 #include "cpp_api/s_internal.h"
 #include "common/c_converter.h"
+#include "emerge.h"
 #include "log.h"
 #include "mapgen/mapgen.h"
 #include "lua_api/l_env.h"
@@ -19,7 +20,10 @@
 
 class LuaABM : public ActiveBlockModifier {
 private:
-	const int m_id;
+	// Registry reference to the action function, resolved once in readABMs()
+	// so that triggering doesn't need to look up the definition table.
+	const int m_action_ref;
+	const std::string m_origin;
 
 	std::vector<std::string> m_trigger_contents;
 	std::vector<std::string> m_required_neighbors;
@@ -30,13 +34,14 @@ class LuaABM : public ActiveBlockModifier {
 	s16 m_min_y;
 	s16 m_max_y;
 public:
-	LuaABM(int id,
+	LuaABM(int action_ref, const std::string &origin,
 			const std::vector<std::string> &trigger_contents,
 			const std::vector<std::string> &required_neighbors,
 			const std::vector<std::string> &without_neighbors,
 			float trigger_interval, u32 trigger_chance, bool simple_catch_up,
 			s16 min_y, s16 max_y):
-		m_id(id),
+		m_action_ref(action_ref),
+		m_origin(origin),
 		m_trigger_contents(trigger_contents),
 		m_required_neighbors(required_neighbors),
 		m_without_neighbors(without_neighbors),
@@ -84,7 +89,8 @@ class LuaABM : public ActiveBlockModifier {
 			u32 active_object_count, u32 active_object_count_wider)
 	{
 		auto *script = env->getScriptIface();
-		script->triggerABM(m_id, p, n, active_object_count, active_object_count_wider);
+		script->triggerABM(m_action_ref, m_origin, p, n,
+				active_object_count, active_object_count_wider);
 	}
 };
 
@@ -209,7 +215,6 @@ void ScriptApiEnv::readABMs()
 	lua_pushnil(L);
 	while (lua_next(L, registered_abms)) {
 		// key at index -2 and value at index -1
-		int id = lua_tonumber(L, -2);
 		int current_abm = lua_gettop(L);
 
 		std::vector<std::string> trigger_contents;
@@ -242,11 +247,15 @@ void ScriptApiEnv::readABMs()
 		s16 max_y = INT16_MAX;
 		getintfield(L, current_abm, "max_y", max_y);
 
+		std::string origin;
+		getstringfield(L, current_abm, "mod_origin", origin);
+
+		// The reference is never released, ABMs live as long as the environment.
 		lua_getfield(L, current_abm, "action");
 		luaL_checktype(L, current_abm + 1, LUA_TFUNCTION);
-		lua_pop(L, 1);
+		int action_ref = luaL_ref(L, LUA_REGISTRYINDEX);
 
-		LuaABM *abm = new LuaABM(id, trigger_contents, required_neighbors,
+		LuaABM *abm = new LuaABM(action_ref, origin, trigger_contents, required_neighbors,
 			without_neighbors, trigger_interval, trigger_chance,
 			simple_catch_up, min_y, max_y);
 
@@ -343,6 +352,57 @@ void ScriptApiEnv::on_emerge_area_completion(
 	}
 }
 
+void ScriptApiEnv::on_mapgen_surface(const MapgenSurface *surface,
+	ScriptCallbackState *state)
+{
+	Server *server = getServer();
+
+	// Called with envlock held, see on_emerge_area_completion
+	SCRIPTAPI_PRECHECKHEADER
+
+	int error_handler = PUSH_ERROR_HANDLER(L);
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, state->callback_ref);
+	luaL_checktype(L, -1, LUA_TFUNCTION);
+
+	if (surface) {
+		lua_createtable(L, 0, 2);
+
+		lua_createtable(L, surface->heights.size(), 0);
+		for (size_t i = 0; i < surface->heights.size(); i++) {
+			lua_pushinteger(L, surface->heights[i]);
+			lua_rawseti(L, -2, i + 1);
+		}
+		lua_setfield(L, -2, "heights");
+
+		if (!surface->biomes.empty()) {
+			lua_createtable(L, surface->biomes.size(), 0);
+			for (size_t i = 0; i < surface->biomes.size(); i++) {
+				lua_pushinteger(L, surface->biomes[i]);
+				lua_rawseti(L, -2, i + 1);
+			}
+			lua_setfield(L, -2, "biomes");
+		}
+	} else {
+		lua_pushnil(L);
+	}
+	lua_rawgeti(L, LUA_REGISTRYINDEX, state->args_ref);
+
+	setOriginDirect(state->origin.c_str());
+
+	try {
+		PCALL_RES(lua_pcall(L, 2, 0, error_handler));
+	} catch (LuaError &e) {
+		// Note: don't throw here, we still need to run the cleanup code below
+		server->setAsyncFatalError(e);
+	}
+
+	lua_pop(L, 1); // Pop error handler
+
+	luaL_unref(L, LUA_REGISTRYINDEX, state->callback_ref);
+	luaL_unref(L, LUA_REGISTRYINDEX, state->args_ref);
+}
+
 void ScriptApiEnv::check_for_falling(v3s16 p)
 {
 	SCRIPTAPI_PRECHECKHEADER
@@ -419,32 +479,18 @@ bool ScriptApiEnv::has_on_mapblocks_changed()
 	return lua_objlen(L, -1) > 0;
 }
 
-void ScriptApiEnv::triggerABM(int id, v3s16 p, MapNode n,
+void ScriptApiEnv::triggerABM(int action_ref, const std::string &origin,
+		v3s16 p, MapNode n,
 		u32 active_object_count, u32 active_object_count_wider)
 {
 	SCRIPTAPI_PRECHECKHEADER
 
 	int error_handler = PUSH_ERROR_HANDLER(L);
 
-	// Get registered_abms
-	lua_getglobal(L, "core");
-	lua_getfield(L, -1, "registered_abms");
-	luaL_checktype(L, -1, LUA_TTABLE);
-	lua_remove(L, -2); // Remove core
-
-	// Get registered_abms[m_id]
-	lua_pushinteger(L, id);
-	lua_gettable(L, -2);
-	FATAL_ERROR_IF(lua_isnil(L, -1), "Entry with given id not found in registered_abms table");
-	lua_remove(L, -2); // Remove registered_abms
-
-	setOriginFromTable(-1);
+	m_last_run_mod = origin;
 
 	// Call action
-	luaL_checktype(L, -1, LUA_TTABLE);
-	lua_getfield(L, -1, "action");
-	luaL_checktype(L, -1, LUA_TFUNCTION);
-	lua_remove(L, -2); // Remove registered_abms[m_id]
+	lua_rawgeti(L, LUA_REGISTRYINDEX, action_ref);
 	push_v3s16(L, p);
 	pushnode(L, n);
 	lua_pushnumber(L, active_object_count);
@@ -12,6 +12,7 @@
 
 class ServerEnvironment;
 class MapBlock;
+struct MapgenSurface;
 struct ScriptCallbackState;
 
 class ScriptApiEnv : virtual public ScriptApiBase
@@ -30,6 +31,10 @@ class ScriptApiEnv : virtual public ScriptApiBase
 	void on_emerge_area_completion(v3s16 blockpos, int action,
 		ScriptCallbackState *state);
 
+	// Called with the result of core.get_mapgen_surface(), surface may be null
+	void on_mapgen_surface(const MapgenSurface *surface,
+		ScriptCallbackState *state);
+
 	void check_for_falling(v3s16 p);
 
 	// Called after liquid transform changes
@@ -44,7 +49,7 @@ class ScriptApiEnv : virtual public ScriptApiBase
 	// Initializes environment and loads some definitions from Lua
 	void initializeEnvironment(ServerEnvironment *env);
 
-	void triggerABM(int id, v3s16 p, MapNode n,
+	void triggerABM(int action_ref, const std::string &origin, v3s16 p, MapNode n,
 			u32 active_object_count, u32 active_object_count_wider);
 
 	void triggerLBM(int id, MapBlock *block,
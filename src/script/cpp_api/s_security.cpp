@@ -13,11 +13,15 @@
 #include "content/mods.h" // ModSpec
 #include "settings.h"
 #include "constants.h"
+#include "threading/mutex_auto_lock.h"
 
 #include <cerrno>
 #include <string>
 #include <algorithm>
 #include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 
 #define SECURE_API(lib, name) \
@@ -592,6 +596,117 @@ bool ScriptApiSecurity::safeLoadString(lua_State *L, std::string_view code, cons
 	return true;
 }
 
+namespace {
+
+/*
+	Compiled chunks of files loaded through safeLoadFile(), shared by all Lua
+	environments of the process. The same files are loaded by the server, every
+	async worker and the emerge environment, so parsing them once is enough.
+	Only holds bytecode dumped from source we compiled ourselves, the check
+	for bytecode in untrusted input is not affected.
+*/
+class ChunkCache
+{
+public:
+	// Pushes the cached function if `code` matches, returns false otherwise
+	bool load(lua_State *L, std::string_view code, const char *chunk_name)
+	{
+		std::string bytecode;
+		{
+			MutexAutoLock lock(m_mutex);
+			auto it = m_entries.find(chunk_name);
+			// Compare the whole source, a different file must never run
+			// the bytecode of this one
+			if (it == m_entries.end() || it->second.source != code)
+				return false;
+			it->second.last_used = ++m_use_counter;
+			bytecode = it->second.bytecode;
+		}
+		if (luaL_loadbuffer(L, bytecode.data(), bytecode.size(), chunk_name)) {
+			lua_pop(L, 1); // error message
+			return false;
+		}
+		return true;
+	}
+
+	// Stores the function on top of the stack as compiled form of `code`
+	void store(lua_State *L, std::string_view code, const char *chunk_name)
+	{
+		Entry entry;
+		entry.source = code;
+		if (lua_dump(L, writer, &entry.bytecode) != 0)
+			return;
+		if (entry.size() > MAX_SIZE / 4)
+			return;
+
+		MutexAutoLock lock(m_mutex);
+		entry.last_used = ++m_use_counter;
+		auto it = m_entries.find(chunk_name);
+		if (it != m_entries.end()) {
+			m_size -= it->second.size();
+			it->second = std::move(entry);
+		} else {
+			it = m_entries.emplace(chunk_name, std::move(entry)).first;
+		}
+		m_size += it->second.size();
+		prune();
+	}
+
+private:
+	// Bytes of source and bytecode kept at most
+	static constexpr size_t MAX_SIZE = 64 * 1024 * 1024;
+
+	struct Entry {
+		std::string source;
+		std::string bytecode;
+		u64 last_used;
+
+		size_t size() const { return source.size() + bytecode.size(); }
+	};
+
+	static int writer(lua_State *L, const void *p, size_t sz, void *ud)
+	{
+		reinterpret_cast<std::string *>(ud)->append(
+			reinterpret_cast<const char *>(p), sz);
+		return 0;
+	}
+
+	// Removes the least recently used chunks, down to 3/4 of the limit so
+	// that this doesn't happen again on the next store
+	void prune()
+	{
+		if (m_size <= MAX_SIZE)
+			return;
+
+		std::vector<std::pair<u64, const std::string *>> by_use;
+		by_use.reserve(m_entries.size());
+		for (const auto &it : m_entries)
+			by_use.emplace_back(it.second.last_used, &it.first);
+		std::sort(by_use.begin(), by_use.end());
+
+		std::vector<std::string> names;
+		size_t size = m_size;
+		for (const auto &it : by_use) {
+			if (size <= MAX_SIZE / 4 * 3)
+				break;
+			size -= m_entries.at(*it.second).size();
+			names.push_back(*it.second);
+		}
+		for (const std::string &name : names)
+			m_entries.erase(name);
+		m_size = size;
+	}
+
+	std::mutex m_mutex;
+	std::unordered_map<std::string, Entry> m_entries;
+	size_t m_size = 0;
+	u64 m_use_counter = 0;
+};
+
+ChunkCache g_chunk_cache;
+
+}
+
 bool ScriptApiSecurity::safeLoadFile(lua_State *L, const char *path, const char *display_name)
 {
 	FILE *fp;
@@ -654,7 +769,16 @@ bool ScriptApiSecurity::safeLoadFile(lua_State *L, const char *path, const char
 		return false;
 	}
 
-	bool result = safeLoadString(L, code, chunk_name);
+	bool result;
+	if (!path) {
+		result = safeLoadString(L, code, chunk_name);
+	} else if (g_chunk_cache.load(L, code, chunk_name)) {
+		result = true;
+	} else {
+		result = safeLoadString(L, code, chunk_name);
+		if (result)
+			g_chunk_cache.store(L, code, chunk_name);
+	}
 	if (path)
 		delete [] chunk_name;
 	return result;
@@ -4,10 +4,12 @@
 
 #include "lua_api/l_mapgen.h"
 #include "lua_api/l_internal.h"
+#include "lua_api/l_env.h"
 #include "lua_api/l_vmanip.h"
 #include "common/c_converter.h"
 #include "common/c_content.h"
 #include "cpp_api/s_security.h"
+#include "scripting_server.h"
 #include "server.h"
 #include "serverenvironment.h"
 #include "servermap.h"
@@ -22,6 +24,24 @@
 #include "settings.h"
 #include "log.h"
 
+// get_mapgen_surface passes a Lua table entry for every column
+constexpr u64 MAPGEN_SURFACE_MAX_AREA = 1024 * 1024;
+
+static void LuaMapgenSurfaceCallback(const MapgenSurface *surface, void *param)
+{
+	ScriptCallbackState *state = (ScriptCallbackState *)param;
+	assert(state != NULL);
+	assert(state->script != NULL);
+
+	// state must be protected by envlock
+	Server *server = state->script->getServer();
+	Server::EnvAutoLock envlock(server);
+
+	state->script->on_mapgen_surface(surface, state);
+
+	delete state;
+}
+
 struct EnumString ModApiMapgen::es_BiomeTerrainType[] =
 {
 	{BIOMETYPE_NORMAL, "normal"},
@@ -735,6 +755,46 @@ int ModApiMapgen::l_get_spawn_level(lua_State *L)
 }
 
 
+// get_mapgen_surface(minp, maxp, callback, [param])
+int ModApiMapgen::l_get_mapgen_surface(lua_State *L)
+{
+	NO_MAP_LOCK_REQUIRED;
+
+	v3s16 minp = read_v3s16(L, 1);
+	v3s16 maxp = read_v3s16(L, 2);
+	sortBoxVerticies(minp, maxp);
+	luaL_checktype(L, 3, LUA_TFUNCTION);
+
+	const u64 area = (u64)(maxp.X - minp.X + 1) * (maxp.Z - minp.Z + 1);
+	if (area > MAPGEN_SURFACE_MAX_AREA)
+		throw LuaError("get_mapgen_surface: area is too large");
+
+	lua_pushvalue(L, 3);
+	int callback_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+
+	lua_pushvalue(L, 4);
+	int args_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+
+	ScriptCallbackState *state = new ScriptCallbackState;
+	state->script       = getServer(L)->getScriptIface();
+	state->callback_ref = callback_ref;
+	state->args_ref     = args_ref;
+	state->refcount     = 1;
+	state->origin       = getScriptApiBase(L)->getOrigin();
+
+	EmergeManager *emerge = getServer(L)->getEmergeManager();
+	if (!emerge->enqueueMapgenSurface(v2s16(minp.X, minp.Z), v2s16(maxp.X, maxp.Z),
+			LuaMapgenSurfaceCallback, state)) {
+		luaL_unref(L, LUA_REGISTRYINDEX, callback_ref);
+		luaL_unref(L, LUA_REGISTRYINDEX, args_ref);
+		delete state;
+		throw LuaError("get_mapgen_surface: mapgen is not initialized yet");
+	}
+
+	return 0;
+}
+
+
 // get_seed([add])
 int ModApiMapgen::l_get_seed(lua_State *L)
 {
@@ -2075,6 +2135,7 @@ void ModApiMapgen::Initialize(lua_State *L, int top)
 	API_FCT(get_biome_data);
 	API_FCT(get_mapgen_object);
 	API_FCT(get_spawn_level);
+	API_FCT(get_mapgen_surface);
 
 	API_FCT(get_mapgen_params);
 	API_FCT(set_mapgen_params);
@@ -45,6 +45,9 @@ class ModApiMapgen : public ModApiBase
 	// get_spawn_level(x = num, z = num)
 	static int l_get_spawn_level(lua_State *L);
 
+	// get_mapgen_surface(minp, maxp, callback, [param])
+	static int l_get_mapgen_surface(lua_State *L);
+
 	// get_mapgen_params()
 	// returns the currently active map generation parameter set
 	static int l_get_mapgen_params(lua_State *L);
@@ -993,6 +993,10 @@ int ObjectRef::l_set_nametag_attributes(lua_State *L)
 	if (prop == nullptr)
 		return 0;
 
+	const auto old_color = prop->nametag_color;
+	const auto old_bgcolor = prop->nametag_bgcolor;
+	const std::string old_text = prop->nametag;
+
 	lua_getfield(L, 2, "color");
 	if (!lua_isnil(L, -1)) {
 		video::SColor color = prop->nametag_color;
@@ -1015,8 +1019,12 @@ int ObjectRef::l_set_nametag_attributes(lua_State *L)
 
 	prop->nametag = getstringfield_default(L, 2, "text", prop->nametag);
 
-	prop->validate();
-	sao->notifyObjectPropertiesModified();
+	// Mods commonly call this every step, only resend on actual changes
+	if (prop->nametag != old_text || prop->nametag_color != old_color ||
+			prop->nametag_bgcolor != old_bgcolor) {
+		prop->validate();
+		sao->notifyObjectPropertiesModified();
+	}
 	return 0;
 }
 
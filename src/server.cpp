@@ -25,6 +25,7 @@
 #include "server/ban.h"
 #include "serverenvironment.h"
 #include "servermap.h"
+#include "server/mediaindex.h"
 #include "server/player_sao.h"
 #include "server/rollback.h"
 #include "server/serveractiveobject.h"
@@ -2502,9 +2503,10 @@ void Server::sendMetadataChanged(const std::unordered_set<v3s16> &positions, flo
 	}
 }
 
-void Server::SendBlockNoLock(session_t peer_id, MapBlock *block, u8 ver,
-		u16 net_proto_version, SerializedBlockCache *cache)
+void Server::SendBlockNoLock(RemoteClient *client, MapBlock *block,
+		SerializedBlockCache *cache)
 {
+	const u8 ver = client->serialization_version;
 	thread_local const int net_compression_level = rangelim(g_settings->getS16("map_compression_level_net"), -1, 9);
 	std::string s, *sptr = nullptr;
 
@@ -2523,10 +2525,26 @@ void Server::SendBlockNoLock(session_t peer_id, MapBlock *block, u8 ver,
 		sptr = &s;
 	}
 
-	NetworkPacket pkt(TOCLIENT_BLOCKDATA, 2 + 2 + 2 + sptr->size(), peer_id);
-	pkt << block->getPos();
-	pkt.putRawString(*sptr);
-	Send(&pkt);
+	const v3s16 pos = block->getPos();
+	bool cached = false;
+	if (client->hasBlockCache()) {
+		// The client stores every block it receives
+		const u64 hash = murmur_hash_64_ua(sptr->data(), sptr->size(), 0);
+		cached = client->useCachedBlock(pos, hash);
+		if (!cached)
+			client->setCachedBlock(pos, hash);
+	}
+
+	if (cached) {
+		NetworkPacket pkt(TOCLIENT_BLOCKDATA_CACHED, 2 + 2 + 2, client->peer_id);
+		pkt << pos;
+		Send(&pkt);
+	} else {
+		NetworkPacket pkt(TOCLIENT_BLOCKDATA, 2 + 2 + 2 + sptr->size(), client->peer_id);
+		pkt << pos;
+		pkt.putRawString(*sptr);
+		Send(&pkt);
+	}
 
 	// Store away in cache
 	if (cache && sptr == &s)
@@ -2594,8 +2612,7 @@ void Server::SendBlocks(float dtime)
 		if (!client)
 			continue;
 
-		SendBlockNoLock(block_to_send.peer_id, block, client->serialization_version,
-				client->net_proto_version, cache_ptr);
+		SendBlockNoLock(client, block, cache_ptr);
 
 		client->SentBlock(block_to_send.pos);
 		total_sending++;
@@ -2612,15 +2629,14 @@ bool Server::SendBlock(session_t peer_id, const v3s16 &blockpos)
 	RemoteClient *client = m_clients.lockedGetClientNoEx(peer_id, CS_Active);
 	if (!client || client->isBlockSent(blockpos))
 		return false;
-	SendBlockNoLock(peer_id, block, client->serialization_version,
-			client->net_proto_version);
+	SendBlockNoLock(client, block);
 
 	return true;
 }
 
 bool Server::addMediaFile(const std::string &filename,
 	const std::string &filepath, std::string *filedata_to,
-	std::string *digest_to)
+	std::string *digest_to, const std::string &known_digest)
 {
 	// If name contains illegal characters, ignore the file
 	if (!string_allowed(filename, TEXTURENAME_ALLOWED_CHARS)) {
@@ -2645,6 +2661,16 @@ bool Server::addMediaFile(const std::string &filename,
 				<< filename << "\"" << std::endl;
 		return false;
 	}
+
+	if (!known_digest.empty() && !filedata_to) {
+		if (digest_to)
+			*digest_to = known_digest;
+		m_media[filename] = MediaInfo(filepath, known_digest);
+		verbosestream << "Server: " << hex_encode(known_digest) << " is "
+				<< filename << " (unchanged)" << std::endl;
+		return true;
+	}
+
 	// Ok, attempt to load the file and add to cache
 
 	// Read data
@@ -2693,6 +2719,18 @@ void Server::fillMediaCache()
 	fs::GetRecursiveDirs(paths, m_gamespec.path + DIR_DELIM + "textures");
 	m_modmgr->getModsMediaPaths(paths);
 
+	// One index per world, so that servers sharing the cache directory
+	// don't drop each other's entries or write the same file
+	char index_name[32];
+	porting::mt_snprintf(index_name, sizeof(index_name), "%016llx.txt",
+		(unsigned long long)murmur_hash_64_ua(m_path_world.data(), m_path_world.size(), 0));
+	const std::string index_path = porting::path_cache + DIR_DELIM + "media_index" +
+		DIR_DELIM + index_name;
+
+	MediaIndex old_index, new_index;
+	old_index.read(index_path);
+	u32 hashed_count = 0;
+
 	// Collect media file information from paths into cache
 	for (const std::string &mediapath : paths) {
 		std::vector<fs::DirListNode> dirlist = fs::GetDirListing(mediapath);
@@ -2706,11 +2744,31 @@ void Server::fillMediaCache()
 
 			std::string filepath = mediapath;
 			filepath.append(DIR_DELIM).append(filename);
-			addMediaFile(filename, filepath);
+
+			// Before reading the file, so that later changes are noticed
+			MediaIndex::Entry entry;
+			if (!fs::GetFileInfo(filepath, &entry.size, &entry.mtime)) {
+				addMediaFile(filename, filepath);
+				continue;
+			}
+			const std::string *known_digest =
+				old_index.getDigest(filepath, entry.size, entry.mtime);
+
+			if (!addMediaFile(filename, filepath, nullptr, &entry.sha1_digest,
+					known_digest ? *known_digest : ""))
+				continue;
+			if (!known_digest)
+				hashed_count++;
+			new_index.set(filepath, std::move(entry));
 		}
 	}
 
-	infostream << "Server: " << m_media.size() << " media files collected" << std::endl;
+	if ((hashed_count > 0 || new_index.size() != old_index.size()) &&
+			!new_index.write(index_path))
+		warningstream << "Server: Failed to write media index" << std::endl;
+
+	infostream << "Server: " << m_media.size() << " media files collected, "
+		<< hashed_count << " of them changed" << std::endl;
 }
 
 void Server::sendMediaAnnouncement(session_t peer_id, const std::string &lang_code)
@@ -241,6 +241,7 @@ class Server : public con::PeerHandler, public MapEventReceiver,
 	void handleCommand_SrpBytesM(NetworkPacket* pkt);
 	void handleCommand_HaveMedia(NetworkPacket *pkt);
 	void handleCommand_UpdateClientInfo(NetworkPacket *pkt);
+	void handleCommand_HaveBlocks(NetworkPacket *pkt);
 
 	void ProcessData(NetworkPacket *pkt);
 
@@ -454,6 +455,16 @@ class Server : public con::PeerHandler, public MapEventReceiver,
 	static bool migrateModStorageDatabase(const GameParams &game_params,
 			const Settings &cmd_args);
 
+	// Generates the area given by --pregenerate without running the server
+	// (implemented in server/pregenerate.cpp)
+	static bool pregenerateMap(const GameParams &game_params,
+			const Settings &cmd_args);
+
+	// Prints the ground level and biomes of the area given by
+	// --mapgen-surface (implemented in server/mapgensurface.cpp)
+	static bool printMapgenSurface(const GameParams &game_params,
+			const Settings &cmd_args);
+
 	static u16 getProtocolVersionMin();
 	static u16 getProtocolVersionMax();
 
@@ -584,14 +595,16 @@ class Server : public con::PeerHandler, public MapEventReceiver,
 
 	// Environment and Connection must be locked when called
 	// `cache` may only be very short lived! (invalidation not handeled)
-	void SendBlockNoLock(session_t peer_id, MapBlock *block, u8 ver,
-		u16 net_proto_version, SerializedBlockCache *cache = nullptr);
+	void SendBlockNoLock(RemoteClient *client, MapBlock *block,
+		SerializedBlockCache *cache = nullptr);
 
 	// Sends blocks to clients (locks env and con on its own)
 	void SendBlocks(float dtime);
 
+	// If the digest of the file is known already, it is not read at all
 	bool addMediaFile(const std::string &filename, const std::string &filepath,
-			std::string *filedata = nullptr, std::string *digest = nullptr);
+			std::string *filedata = nullptr, std::string *digest = nullptr,
+			const std::string &known_digest = "");
 	void fillMediaCache();
 	void sendMediaAnnouncement(session_t peer_id, const std::string &lang_code);
 	void sendRequestedMedia(session_t peer_id,
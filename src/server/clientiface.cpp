@@ -455,6 +455,24 @@ void RemoteClient::SetBlockNotSent(v3s16 p, bool low_priority)
 	}
 }
 
+void RemoteClient::setCachedBlock(v3s16 p, u64 hash)
+{
+	auto it = m_cached_blocks.find(p);
+	if (it != m_cached_blocks.end())
+		it->second = hash;
+	else if (m_cached_blocks.size() < MAX_ADVERTISED_BLOCKS)
+		m_cached_blocks.emplace(p, hash);
+}
+
+bool RemoteClient::useCachedBlock(v3s16 p, u64 hash)
+{
+	auto it = m_cached_blocks.find(p);
+	if (it == m_cached_blocks.end() || it->second != hash)
+		return false;
+	m_cached_blocks.erase(it);
+	return true;
+}
+
 void RemoteClient::SetBlocksNotSent(const std::vector<v3s16> &blocks, bool low_priority)
 {
 	for (v3s16 p : blocks) {
@@ -268,6 +268,16 @@ class RemoteClient
 		return m_blocks_sent.find(p) != m_blocks_sent.end();
 	}
 
+	/*
+		Blocks the client has cached from earlier sessions, see
+		TOSERVER_HAVE_BLOCKS. A cached block is only used once, so that it is
+		sent in full if the client lost it after all.
+	*/
+	void enableBlockCache() { m_block_cache = true; }
+	bool hasBlockCache() const { return m_block_cache; }
+	void setCachedBlock(v3s16 p, u64 hash);
+	bool useCachedBlock(v3s16 p, u64 hash);
+
 	bool markMediaSent(const std::string &name) {
 		auto insert_result = m_media_sent.emplace(name);
 		return insert_result.second; // true = was inserted
@@ -381,6 +391,12 @@ class RemoteClient
 	*/
 	std::unordered_set<std::string> m_media_sent;
 
+	/*
+		Hashes of the data of blocks the client has cached.
+	*/
+	bool m_block_cache = false;
+	std::unordered_map<v3s16, u64> m_cached_blocks;
+
 	/*
 		Blocks that are currently on the line.
 		This is used for throttling the sending of blocks.
@@ -112,6 +112,8 @@ void LuaEntitySAO::addedToEnvironment(u32 dtime_s)
 			luaentity_GetProperties(m_id, this, &m_prop, m_init_name);
 		// Initialize HP from properties
 		m_hp = m_prop.hp_max;
+		m_env->getScriptIface()->
+			luaentity_GetStepSettings(m_id, &m_step_settings);
 		// Activate entity, supplying serialized state
 		m_env->getScriptIface()->
 			luaentity_Activate(m_id, m_init_state, dtime_s);
@@ -138,9 +140,7 @@ void LuaEntitySAO::step(float dtime, bool send_recommended)
 {
 	if (!m_properties_sent) {
 		m_properties_sent = true;
-		std::string str = getPropertyPacket();
-		// create message and add to list
-		m_messages_out.emplace(getId(), true, std::move(str));
+		queuePropertiesCommand(getPropertyPacket());
 	}
 
 	if (!m_texture_modifier_sent) {
@@ -185,6 +185,8 @@ void LuaEntitySAO::step(float dtime, bool send_recommended)
 			setBasePosition(p_pos);
 			m_velocity = p_velocity;
 			m_acceleration = p_acceleration;
+
+			applyNativeMovement(dtime, moveresult);
 		} else {
 			addPos((m_velocity + m_acceleration * 0.5f * dtime) * dtime);
 			m_velocity += dtime * m_acceleration;
@@ -213,8 +215,16 @@ void LuaEntitySAO::step(float dtime, bool send_recommended)
 				m_prop.automatic_rotate);
 	}
 
-	if(m_registered) {
-		m_env->getScriptIface()->luaentity_Step(m_id, dtime, moveresult_p);
+	if (m_registered) {
+		// With a step interval on_step only runs on timer expiry or collision,
+		// the elapsed time is accumulated and passed on as one dtime.
+		m_step_dtime += dtime;
+		bool collided = moveresult_p && moveresult_p->collides &&
+				m_step_settings.on_collision;
+		if (m_step_dtime >= m_step_settings.interval || collided) {
+			m_env->getScriptIface()->luaentity_Step(m_id, m_step_dtime, moveresult_p);
+			m_step_dtime = 0.0f;
+		}
 	}
 
 	if (!send_recommended)
@@ -244,6 +254,39 @@ void LuaEntitySAO::step(float dtime, bool send_recommended)
 	sendOutdatedData();
 }
 
+void LuaEntitySAO::applyNativeMovement(float dtime, const collisionMoveResult &moveresult)
+{
+	if (!moveresult.touching_ground)
+		return;
+
+	if (m_step_settings.ground_friction > 0.0f) {
+		v2f hvel(m_velocity.X, m_velocity.Z);
+		f32 speed = hvel.getLength();
+		f32 decel = m_step_settings.ground_friction * dtime;
+		if (speed <= decel) {
+			m_velocity.X = 0.0f;
+			m_velocity.Z = 0.0f;
+		} else {
+			f32 f = (speed - decel) / speed;
+			m_velocity.X *= f;
+			m_velocity.Z *= f;
+		}
+	}
+
+	if (m_step_settings.jump_on_collide > 0.0f) {
+		for (const auto &info : moveresult.collisions) {
+			if (info.type == COLLISION_NODE && info.axis != COLLISION_AXIS_Y &&
+					info.axis != COLLISION_AXIS_NONE) {
+				// Keep the horizontal intent so the jump clears the obstacle
+				m_velocity.X = info.old_speed.X;
+				m_velocity.Z = info.old_speed.Z;
+				m_velocity.Y = m_step_settings.jump_on_collide;
+				break;
+			}
+		}
+	}
+}
+
 std::string LuaEntitySAO::getClientInitializationData(u16 protocol_version)
 {
 	std::ostringstream os(std::ios::binary);
@@ -258,6 +301,7 @@ std::string LuaEntitySAO::getClientInitializationData(u16 protocol_version)
 	writeU16(os, m_hp);
 
 	std::ostringstream msg_os(std::ios::binary);
+	m_last_properties_cmd.clear();
 	msg_os << serializeString32(getPropertyPacket()); // message 1
 	msg_os << serializeString32(generateUpdateArmorGroupsCommand()); // 2
 	msg_os << serializeString32(generateUpdateAnimationCommand()); // 3
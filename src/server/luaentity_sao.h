@@ -8,6 +8,24 @@
 #include "unit_sao.h"
 #include "util/guid.h"
 
+struct collisionMoveResult;
+
+/*
+	Step and movement behaviour declared in the entity definition.
+	Read once when the entity is activated.
+*/
+struct LuaEntityStepSettings
+{
+	// Minimum time between two on_step calls, 0 = every server step
+	f32 interval = 0.0f;
+	// Call on_step early if the object collided during this step
+	bool on_collision = true;
+	// Horizontal deceleration while touching the ground (BS-scaled)
+	f32 ground_friction = 0.0f;
+	// Vertical speed applied when blocked by a wall on the ground (BS-scaled)
+	f32 jump_on_collide = 0.0f;
+};
+
 class LuaEntitySAO : public UnitSAO
 {
 public:
@@ -76,6 +94,7 @@ class LuaEntitySAO : public UnitSAO
 private:
 	std::string getPropertyPacket();
 	void sendPosition(bool do_interpolate, bool is_movement_end);
+	void applyNativeMovement(float dtime, const collisionMoveResult &moveresult);
 	std::string generateSetTextureModCommand() const;
 	static std::string generateSetSpriteCommand(v2s16 p, u16 num_frames,
 			f32 framelength, bool select_horiz_by_yawpitch);
@@ -86,6 +105,10 @@ class LuaEntitySAO : public UnitSAO
 
 	MyGUID m_guid;
 
+	LuaEntityStepSettings m_step_settings;
+	// Time accumulated since the last on_step call
+	float m_step_dtime = 0.0f;
+
 	v3f m_velocity;
 	v3f m_acceleration;
 
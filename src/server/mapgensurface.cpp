@@ -0,0 +1,116 @@
+// Luanti
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 Minetest Authors
+
+#include "server.h"
+
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include "emerge.h"
+#include "gameparams.h"
+#include "log.h"
+#include "mapgen/mg_biome.h"
+#include "porting.h"
+#include "settings.h"
+
+// Every column is kept in memory until the whole area is done
+constexpr u64 MAPGEN_SURFACE_CLI_MAX_AREA = 4096 * 4096;
+
+namespace {
+	struct SurfaceQuery {
+		std::atomic<bool> done{false};
+		bool ok = false;
+		MapgenSurface surface;
+	};
+
+	// Runs in the mapgen surface thread
+	void surface_callback(const MapgenSurface *surface, void *param)
+	{
+		auto *query = reinterpret_cast<SurfaceQuery *>(param);
+		if (surface) {
+			query->surface = *surface;
+			query->ok = true;
+		}
+		query->done = true;
+	}
+
+	bool parse_area(const std::string &str, v2s16 *minp, v2s16 *maxp)
+	{
+		int c[4];
+		if (std::sscanf(str.c_str(), " ( %d , %d ) ( %d , %d )",
+				&c[0], &c[1], &c[2], &c[3]) != 4)
+			return false;
+		for (int &v : c)
+			v = rangelim(v, -MAX_MAP_GENERATION_LIMIT, MAX_MAP_GENERATION_LIMIT);
+		*minp = v2s16(std::min(c[0], c[2]), std::min(c[1], c[3]));
+		*maxp = v2s16(std::max(c[0], c[2]), std::max(c[1], c[3]));
+		return true;
+	}
+}
+
+bool Server::printMapgenSurface(const GameParams &game_params, const Settings &cmd_args)
+{
+	v2s16 minp, maxp;
+	if (!parse_area(cmd_args.get("mapgen-surface"), &minp, &maxp)) {
+		errorstream << "Invalid area for --mapgen-surface, expected "
+			"\"(x1,z1) (x2,z2)\"" << std::endl;
+		return false;
+	}
+	if ((u64)(maxp.X - minp.X + 1) * (maxp.Y - minp.Y + 1) > MAPGEN_SURFACE_CLI_MAX_AREA) {
+		errorstream << "Area for --mapgen-surface is too large" << std::endl;
+		return false;
+	}
+
+	// Must outlive the server, which cancels (and calls back) pending queries
+	SurfaceQuery query;
+
+	try {
+		Server server(game_params.world_path, game_params.game_spec, false,
+			Address(), true);
+		server.init();
+
+		EmergeManager *emerge = server.m_emerge.get();
+		emerge->startThreads();
+		if (!emerge->enqueueMapgenSurface(minp, maxp, surface_callback, &query)) {
+			emerge->stopThreads();
+			return false;
+		}
+
+		volatile auto &kill = *porting::signal_handler_killstatus();
+		while (!query.done && !kill)
+			sleep_ms(10);
+		emerge->stopThreads();
+
+		if (kill)
+			return false;
+		if (!query.ok) {
+			errorstream << "The mapgen has no heightmap" << std::endl;
+			return false;
+		}
+
+		// One line per column: x, z, ground level and biome name
+		const MapgenSurface &surface = query.surface;
+		const BiomeManager *biomemgr = emerge->getBiomeManager();
+		const u32 width = maxp.X - minp.X + 1;
+		for (s32 z = minp.Y; z <= maxp.Y; z++)
+		for (s32 x = minp.X; x <= maxp.X; x++) {
+			u32 i = (z - minp.Y) * width + (x - minp.X);
+			std::cout << x << " " << z << " " << surface.heights[i];
+			if (!surface.biomes.empty()) {
+				const ObjDef *biome = biomemgr->getRaw(surface.biomes[i]);
+				std::cout << " " << (biome ? biome->name : "");
+			}
+			std::cout << "\n";
+		}
+		std::cout << std::flush;
+	} catch (const ModError &e) {
+		errorstream << "ModError: " << e.what() << std::endl;
+		return false;
+	} catch (const ServerError &e) {
+		errorstream << "ServerError: " << e.what() << std::endl;
+		return false;
+	}
+
+	return true;
+}
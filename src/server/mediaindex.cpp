@@ -0,0 +1,68 @@
+// Luanti
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 Minetest Authors
+
+#include "mediaindex.h"
+
+#include "filesys.h"
+#include "util/hex.h"
+#include <sstream>
+
+void MediaIndex::read(const std::string &path)
+{
+	m_entries.clear();
+	u64 size;
+	if (!fs::GetFileInfo(path, &size, &m_mtime))
+		return;
+
+	auto is = open_ifstream(path.c_str(), false);
+	std::string line;
+	while (std::getline(is, line)) {
+		std::istringstream iss(line);
+		std::string sha1_hex, filepath;
+		Entry entry;
+		iss >> sha1_hex >> entry.size >> entry.mtime;
+		iss.get();
+		std::getline(iss, filepath);
+		if (iss.fail() || sha1_hex.size() != 40)
+			continue;
+		bool ok = true;
+		for (size_t i = 0; i < sha1_hex.size(); i += 2) {
+			unsigned char hi, lo;
+			ok &= hex_digit_decode(sha1_hex[i], hi) && hex_digit_decode(sha1_hex[i + 1], lo);
+			entry.sha1_digest.push_back(ok ? (char)(hi << 4 | lo) : 0);
+		}
+		if (ok)
+			m_entries[filepath] = std::move(entry);
+	}
+}
+
+bool MediaIndex::write(const std::string &path) const
+{
+	std::ostringstream os;
+	for (const auto &[filepath, entry] : m_entries) {
+		os << hex_encode(entry.sha1_digest) << ' ' << entry.size << ' '
+			<< entry.mtime << ' ' << filepath << '\n';
+	}
+	return fs::CreateAllDirs(fs::RemoveLastPathComponent(path)) &&
+		fs::safeWriteToFile(path, os.str());
+}
+
+const std::string *MediaIndex::getDigest(const std::string &filepath, u64 size,
+	u64 mtime) const
+{
+	auto it = m_entries.find(filepath);
+	if (it == m_entries.end() || it->second.size != size || it->second.mtime != mtime)
+		return nullptr;
+	// A file that changed right after it was hashed, but within the same
+	// clock tick, still has the indexed mtime. This can only have happened
+	// if the file is not older than the index.
+	if (mtime >= m_mtime)
+		return nullptr;
+	return &it->second.sha1_digest;
+}
+
+void MediaIndex::set(const std::string &filepath, Entry entry)
+{
+	m_entries[filepath] = std::move(entry);
+}
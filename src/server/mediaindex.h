@@ -0,0 +1,40 @@
+// Luanti
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 Minetest Authors
+
+#pragma once
+
+#include "irrlichttypes.h"
+#include <string>
+#include <unordered_map>
+
+/*
+	Digests of media files by path, so that files that didn't change since
+	the last start don't have to be read and hashed again.
+	One line per file: "<sha1 hex> <size> <mtime> <path>"
+	See fs::GetFileInfo() for size and mtime.
+*/
+class MediaIndex
+{
+public:
+	struct Entry {
+		u64 size, mtime;
+		std::string sha1_digest;
+	};
+
+	// Missing or damaged lines are skipped
+	void read(const std::string &path);
+	bool write(const std::string &path) const;
+
+	// Returns the digest of the file if it is known and unchanged, else nullptr
+	const std::string *getDigest(const std::string &filepath, u64 size,
+		u64 mtime) const;
+	void set(const std::string &filepath, Entry entry);
+
+	size_t size() const { return m_entries.size(); }
+
+private:
+	std::unordered_map<std::string, Entry> m_entries;
+	// Modification time of the file the index was read from
+	u64 m_mtime = 0;
+};
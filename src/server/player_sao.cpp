@@ -109,6 +109,7 @@ std::string PlayerSAO::getClientInitializationData(u16 protocol_version)
 	writeU16(os, getHP());
 
 	std::ostringstream msg_os(std::ios::binary);
+	m_last_properties_cmd.clear();
 	msg_os << serializeString32(getPropertyPacket()); // message 1
 	msg_os << serializeString32(generateUpdateArmorGroupsCommand()); // 2
 	msg_os << serializeString32(generateUpdateAnimationCommand()); // 3
@@ -220,9 +221,7 @@ void PlayerSAO::step(float dtime, bool send_recommended)
 
 	if (!m_properties_sent) {
 		m_properties_sent = true;
-		std::string str = getPropertyPacket();
-		// create message and add to list
-		m_messages_out.emplace(getId(), true, str);
+		queuePropertiesCommand(getPropertyPacket());
 		m_env->getScriptIface()->player_event(this, "properties_changed");
 	}
 
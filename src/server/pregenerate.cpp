@@ -0,0 +1,223 @@
+// Luanti
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 Minetest Authors
+
+#include "server.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include "emerge.h"
+#include "gameparams.h"
+#include "irrlicht_changes/printing.h"
+#include "log.h"
+#include "mapgen/mapgen.h"
+#include "porting.h"
+#include "serverenvironment.h"
+#include "servermap.h"
+#include "settings.h"
+#include "threading/thread.h"
+
+namespace {
+	struct PregenerateState {
+		std::atomic<u32> inflight{0};
+		std::atomic<u32> generated{0};
+		std::atomic<u32> existing{0};
+		std::atomic<u32> failed{0};
+	};
+
+	// Runs in the emerge threads
+	void pregenerate_callback(v3s16 blockpos, EmergeAction action, void *param)
+	{
+		auto *state = reinterpret_cast<PregenerateState *>(param);
+		switch (action) {
+		case EMERGE_GENERATED:
+			state->generated++;
+			break;
+		case EMERGE_FROM_MEMORY:
+		case EMERGE_FROM_DISK:
+			state->existing++;
+			break;
+		default:
+			state->failed++;
+			break;
+		}
+		state->inflight--;
+	}
+
+	bool parse_area(const std::string &str, v3s16 *minp, v3s16 *maxp)
+	{
+		int c[6];
+		if (std::sscanf(str.c_str(), " ( %d , %d , %d ) ( %d , %d , %d )",
+				&c[0], &c[1], &c[2], &c[3], &c[4], &c[5]) != 6)
+			return false;
+		for (int &v : c)
+			v = rangelim(v, -MAX_MAP_GENERATION_LIMIT, MAX_MAP_GENERATION_LIMIT);
+		*minp = v3s16(c[0], c[1], c[2]);
+		*maxp = v3s16(c[3], c[4], c[5]);
+		sortBoxVerticies(*minp, *maxp);
+		return true;
+	}
+}
+
+bool Server::pregenerateMap(const GameParams &game_params, const Settings &cmd_args)
+{
+	v3s16 nodemin, nodemax;
+	if (!parse_area(cmd_args.get("pregenerate"), &nodemin, &nodemax)) {
+		errorstream << "Invalid area for --pregenerate, expected "
+			"\"(x1,y1,z1) (x2,y2,z2)\"" << std::endl;
+		return false;
+	}
+
+	/*
+	 * Most mapgens are limited to one emerge thread because chunks that are
+	 * generated at the same time must not touch each other (see
+	 * EmergeManager::initMapgens). Below, only chunks that are at least one
+	 * chunk apart are ever in flight together, so all cores can be used.
+	 * This only affects this process, dedicated servers never write back
+	 * the configuration.
+	 */
+	if (g_settings->getS16("num_emerge_threads") <= 0) {
+		u32 concurrency = Thread::getNumberOfProcessors();
+		if (u32 memory_mb = porting::getMemorySizeMB())
+			concurrency = std::min<u32>(concurrency, std::max(1.0f, std::roundf(memory_mb / 1024.0f)));
+		g_settings->setS16("num_emerge_threads", std::max<u32>(concurrency, 1));
+	}
+	const u32 num_threads = std::max<s16>(g_settings->getS16("num_emerge_threads"), 1);
+
+	// Must outlive the server, which cancels (and calls back) pending emerges
+	PregenerateState state;
+
+	try {
+		Server server(game_params.world_path, game_params.game_spec, false,
+			Address(), true);
+		server.init();
+
+		EmergeManager *emerge = server.m_emerge.get();
+		ServerMap &map = server.m_env->getServerMap();
+		const v3s16 csize = emerge->mgparams->chunksize;
+
+		auto [edge_min, edge_max] = get_mapgen_edges(emerge->mgparams->mapgen_limit, csize);
+		nodemin = componentwise_max(nodemin, edge_min);
+		nodemax = componentwise_min(nodemax, edge_max);
+		if (nodemin.X > nodemax.X || nodemin.Y > nodemax.Y || nodemin.Z > nodemax.Z) {
+			errorstream << "Area for --pregenerate is outside of the mapgen limits"
+				<< std::endl;
+			return false;
+		}
+
+		const v3s16 chunkmin = EmergeManager::getContainingChunk(
+			getNodeBlockPos(nodemin), csize);
+		const v3s16 chunkmax = EmergeManager::getContainingChunk(
+			getNodeBlockPos(nodemax), csize);
+		const v3s32 count = v3s32(chunkmax.X - chunkmin.X, chunkmax.Y - chunkmin.Y,
+			chunkmax.Z - chunkmin.Z) / v3s32(csize.X, csize.Y, csize.Z) + v3s32(1);
+		const u64 total = (u64)count.X * count.Y * count.Z;
+
+		actionstream << "Pre-generating " << total << " chunks from " << nodemin
+			<< " to " << nodemax << " using " << num_threads << " thread(s)"
+			<< std::endl;
+
+		volatile auto &kill = *porting::signal_handler_killstatus();
+		const u64 start_time = porting::getTimeMs();
+		u64 last_update_time = start_time;
+		u32 last_done = 0;
+		std::map<v3s16, MapBlock *> modified_blocks;
+
+		auto aborted = [&] () {
+			return kill || !server.m_async_fatal_error.get().empty();
+		};
+
+		// Does what the server step would do with the generated blocks.
+		auto update = [&] (bool force) {
+			const u64 now = porting::getTimeMs();
+			if (!force && now - last_update_time < 1000)
+				return;
+
+			Server::EnvAutoLock envlock(&server);
+
+			// Nobody is listening for map edits
+			while (!server.m_unsent_map_edit_queue.empty()) {
+				delete server.m_unsent_map_edit_queue.front();
+				server.m_unsent_map_edit_queue.pop();
+			}
+
+			map.transformLiquids(modified_blocks, server.m_env);
+			modified_blocks.clear();
+
+			// Blocks of chunks in flight are referenced by the mapgen, so this
+			// saves and unloads everything else in a single transaction.
+			map.unloadUnreferencedBlocks();
+
+			const u32 done = state.generated + state.existing + state.failed;
+			const float elapsed = (now - start_time) / 1000.0f;
+			const float rate = (done - last_done) * 1000.0f / std::max<u64>(now - last_update_time, 1);
+			std::cerr << " Pre-generated " << done << " of " << total << " chunks ("
+				<< (100.0f * done / total) << "%), " << rate << " chunks/s, "
+				<< elapsed << "s elapsed\r" << std::flush;
+			last_update_time = now;
+			last_done = done;
+		};
+
+		emerge->startThreads();
+
+		// Eight passes over the area, one for each parity of the chunk
+		// coordinates, so that no two neighbouring chunks are generated at
+		// the same time. Within a pass, the emerge manager hands every chunk
+		// to the least busy thread.
+		const u32 max_inflight = num_threads * 2;
+		for (int pass = 0; pass < 8 && !aborted(); pass++) {
+			for (s32 z = pass >> 2 & 1; z < count.Z; z += 2)
+			for (s32 y = pass >> 1 & 1; y < count.Y; y += 2)
+			for (s32 x = pass & 1; x < count.X; x += 2) {
+				while (state.inflight >= max_inflight && !aborted()) {
+					sleep_ms(1);
+					update(false);
+				}
+				if (aborted())
+					break;
+
+				const v3s16 blockpos = chunkmin + v3s16(x, y, z) * csize;
+				state.inflight++;
+				if (!emerge->enqueueBlockEmergeEx(blockpos, PEER_ID_INEXISTENT,
+						BLOCK_EMERGE_ALLOW_GEN | BLOCK_EMERGE_FORCE_QUEUE,
+						pregenerate_callback, &state)) {
+					state.inflight--;
+					state.failed++;
+				}
+			}
+
+			// Wait for the pass to finish before starting on its neighbours
+			while (state.inflight > 0 && !aborted()) {
+				sleep_ms(1);
+				update(false);
+			}
+		}
+
+		emerge->stopThreads();
+		update(true);
+		std::cerr << std::endl;
+
+		std::string async_err = server.m_async_fatal_error.get();
+		if (!async_err.empty()) {
+			errorstream << "Pre-generation failed: " << async_err << std::endl;
+			return false;
+		}
+		if (kill)
+			return false;
+
+		const float elapsed = (porting::getTimeMs() - start_time) / 1000.0f;
+		actionstream << "Done, generated " << state.generated << " chunks ("
+			<< state.existing << " already existed, " << state.failed
+			<< " failed) in " << elapsed << "s" << std::endl;
+	} catch (const ModError &e) {
+		errorstream << "ModError: " << e.what() << std::endl;
+		return false;
+	} catch (const ServerError &e) {
+		errorstream << "ServerError: " << e.what() << std::endl;
+		return false;
+	}
+
+	return true;
+}
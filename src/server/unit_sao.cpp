@@ -389,6 +389,16 @@ std::string UnitSAO::generateSetPropertiesCommand(const ObjectProperties &prop)
 	return os.str();
 }
 
+void UnitSAO::queuePropertiesCommand(std::string cmd)
+{
+	// Mods often "update" properties with unchanged values, e.g. a nametag
+	// refreshed every step. Don't make every observer re-apply them.
+	if (cmd == m_last_properties_cmd)
+		return;
+	m_last_properties_cmd = cmd;
+	m_messages_out.emplace(getId(), true, std::move(cmd));
+}
+
 std::string UnitSAO::generatePunchCommand(u16 result_hp) const
 {
 	std::ostringstream os(std::ios::binary);
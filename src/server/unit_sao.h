@@ -88,6 +88,8 @@ class UnitSAO : public ServerActiveObject
 			const v3f &velocity, const v3f &acceleration, const v3f &rotation,
 			bool do_interpolate, bool is_movement_end, f32 update_interval);
 	std::string generateSetPropertiesCommand(const ObjectProperties &prop) const;
+	// Queues the properties command unless clients already got an identical one
+	void queuePropertiesCommand(std::string cmd);
 	static std::string generateUpdateBoneOverrideCommand(
 			const std::string &bone, const BoneOverride &props);
 	void sendPunchCommand();
@@ -103,6 +105,9 @@ class UnitSAO : public ServerActiveObject
 	// Object properties
 	bool m_properties_sent = true;
 	ObjectProperties m_prop;
+	// Last properties command sent to clients. Cleared whenever a client
+	// receives the full initialization data, since it may differ from this.
+	std::string m_last_properties_cmd;
 
 	// Stores position and rotation for each bone name
 	std::unordered_map<std::string, BoneOverride> m_bone_override;
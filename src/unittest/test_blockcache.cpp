@@ -0,0 +1,203 @@
+// Luanti
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 Minetest Authors
+
+#include "test.h"
+
+#include "client/blockcache.h"
+#include "filesys.h"
+
+class TestBlockCache : public TestBase
+{
+public:
+	TestBlockCache() { TestManager::registerTestModule(this); }
+	const char *getName() override { return "TestBlockCache"; }
+
+	void runTests(IGameDef *gamedef) override;
+
+	void testStoreLoad();
+	void testReopen();
+	void testRebuildIndex();
+	void testDamagedFile();
+	void testChangedHash();
+	void testStoreDuringLoad();
+	void testSizeLimit();
+
+private:
+	std::string makeDir(const std::string &name);
+	// Loads a block and waits for the result
+	static bool loadNow(ClientBlockCache &cache, v3s16 pos, std::string &data);
+};
+
+static TestBlockCache g_test_instance;
+
+void TestBlockCache::runTests(IGameDef *gamedef)
+{
+	TEST(testStoreLoad);
+	TEST(testReopen);
+	TEST(testRebuildIndex);
+	TEST(testDamagedFile);
+	TEST(testChangedHash);
+	TEST(testStoreDuringLoad);
+	TEST(testSizeLimit);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::string TestBlockCache::makeDir(const std::string &name)
+{
+	std::string dir = getTestTempDirectory() + DIR_DELIM + name;
+	fs::RecursiveDelete(dir);
+	return dir;
+}
+
+bool TestBlockCache::loadNow(ClientBlockCache &cache, v3s16 pos, std::string &data)
+{
+	if (!cache.requestLoad(pos))
+		return false;
+	cache.waitLoads();
+
+	ClientBlockCache::LoadResult result, extra;
+	UASSERT(cache.getNextLoaded(result));
+	UASSERT(result.pos == pos);
+	UASSERT(!cache.getNextLoaded(extra));
+	data = result.data;
+	return result.ok;
+}
+
+void TestBlockCache::testStoreLoad()
+{
+	ClientBlockCache cache(makeDir("store_load"), 1024 * 1024);
+	const std::string data = "block data";
+	std::string loaded;
+
+	UASSERT(!cache.requestLoad(v3s16(1, 2, 3)));
+
+	cache.store(v3s16(1, 2, 3), data);
+	UASSERTEQ(size_t, cache.getIndex().size(), 1);
+	UASSERTEQ(u64, cache.getIndex().at(v3s16(1, 2, 3)).hash,
+		ClientBlockCache::getHash(data));
+	UASSERTEQ(u64, cache.getSize(), data.size());
+
+	UASSERT(loadNow(cache, v3s16(1, 2, 3), loaded));
+	UASSERTEQ(std::string, loaded, data);
+	UASSERT(!cache.hasPendingLoads());
+}
+
+void TestBlockCache::testReopen()
+{
+	const std::string dir = makeDir("reopen");
+	const std::string data = "block data";
+	std::string loaded;
+
+	{
+		ClientBlockCache cache(dir, 1024 * 1024);
+		cache.store(v3s16(-17, 0, 5), data);
+		cache.setLastPos(v3s16(-16, 1, 4));
+	}
+	UASSERT(fs::PathExists(dir + DIR_DELIM "index"));
+
+	ClientBlockCache cache(dir, 1024 * 1024);
+	// Removed until the cache is closed again
+	UASSERT(!fs::PathExists(dir + DIR_DELIM "index"));
+	UASSERT(cache.getLastPos() == v3s16(-16, 1, 4));
+	UASSERTEQ(size_t, cache.getIndex().size(), 1);
+	UASSERT(loadNow(cache, v3s16(-17, 0, 5), loaded));
+	UASSERTEQ(std::string, loaded, data);
+}
+
+void TestBlockCache::testRebuildIndex()
+{
+	const std::string dir = makeDir("rebuild");
+	const std::string data = "block data";
+	std::string loaded;
+
+	{
+		ClientBlockCache cache(dir, 1024 * 1024);
+		cache.store(v3s16(0, 0, 0), data);
+		cache.store(v3s16(100, -100, 20), data + data);
+	}
+	// Like after a crash
+	UASSERT(fs::DeleteSingleFileOrEmptyDirectory(dir + DIR_DELIM "index"));
+
+	ClientBlockCache cache(dir, 1024 * 1024);
+	UASSERTEQ(size_t, cache.getIndex().size(), 2);
+	UASSERTEQ(u64, cache.getSize(), 3 * data.size());
+	UASSERT(loadNow(cache, v3s16(100, -100, 20), loaded));
+	UASSERTEQ(std::string, loaded, data + data);
+}
+
+void TestBlockCache::testDamagedFile()
+{
+	const std::string dir = makeDir("damaged");
+	std::string loaded;
+
+	{
+		ClientBlockCache cache(dir, 1024 * 1024);
+		cache.store(v3s16(0, 0, 0), "block data");
+	}
+	const std::string shard = dir + DIR_DELIM "0_0_0";
+	const auto files = fs::GetDirListing(shard);
+	UASSERTEQ(size_t, files.size(), 1);
+	UASSERT(fs::safeWriteToFile(shard + DIR_DELIM + files[0].name, "block dat4"));
+
+	ClientBlockCache cache(dir, 1024 * 1024);
+	UASSERT(!loadNow(cache, v3s16(0, 0, 0), loaded));
+	UASSERT(cache.getIndex().empty());
+	UASSERTEQ(u64, cache.getSize(), 0);
+}
+
+void TestBlockCache::testChangedHash()
+{
+	const std::string dir = makeDir("changed");
+	std::string loaded;
+
+	{
+		ClientBlockCache cache(dir, 1024 * 1024);
+		cache.store(v3s16(0, 0, 0), "old data");
+		cache.store(v3s16(0, 0, 0), "new data");
+		UASSERTEQ(u64, cache.getIndex().at(v3s16(0, 0, 0)).hash,
+			ClientBlockCache::getHash("new data"));
+		UASSERTEQ(u64, cache.getSize(), 8);
+		UASSERT(loadNow(cache, v3s16(0, 0, 0), loaded));
+		UASSERTEQ(std::string, loaded, "new data");
+	}
+	// The old file is gone
+	UASSERTEQ(size_t, fs::GetDirListing(dir + DIR_DELIM "0_0_0").size(), 1);
+}
+
+void TestBlockCache::testStoreDuringLoad()
+{
+	ClientBlockCache cache(makeDir("store_during_load"), 1024 * 1024);
+	ClientBlockCache::LoadResult result;
+
+	cache.store(v3s16(0, 0, 0), "old data");
+	UASSERT(cache.requestLoad(v3s16(0, 0, 0)));
+	UASSERT(cache.hasPendingLoads());
+	cache.store(v3s16(0, 0, 0), "new data");
+	UASSERT(!cache.hasPendingLoads());
+
+	// The loaded data would be older, so it is dropped
+	cache.waitLoads();
+	UASSERT(!cache.getNextLoaded(result));
+}
+
+void TestBlockCache::testSizeLimit()
+{
+	ClientBlockCache cache(makeDir("size_limit"), 3000);
+	const std::string data(1000, 'x');
+	std::string loaded;
+
+	cache.store(v3s16(0, 0, 0), data);
+	cache.store(v3s16(1, 0, 0), data);
+	cache.store(v3s16(2, 0, 0), data);
+	// Used most recently, so it is kept
+	UASSERT(loadNow(cache, v3s16(0, 0, 0), loaded));
+	cache.store(v3s16(3, 0, 0), data);
+
+	UASSERT(cache.getSize() <= 3000);
+	UASSERTEQ(size_t, cache.getIndex().size(), 2);
+	UASSERT(cache.getIndex().count(v3s16(0, 0, 0)));
+	UASSERT(cache.getIndex().count(v3s16(3, 0, 0)));
+	UASSERT(!cache.requestLoad(v3s16(1, 0, 0)));
+}
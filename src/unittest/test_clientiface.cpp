@@ -0,0 +1,79 @@
+// Luanti
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 Minetest Authors
+
+#include "test.h"
+
+#include "network/networkprotocol.h"
+#include "server/clientiface.h"
+
+class TestClientIface : public TestBase
+{
+public:
+	TestClientIface() { TestManager::registerTestModule(this); }
+	const char *getName() override { return "TestClientIface"; }
+
+	void runTests(IGameDef *gamedef) override;
+
+	void testCachedBlockUsedOnce();
+	void testCachedBlockHash();
+	void testCachedBlockLimit();
+};
+
+static TestClientIface g_test_instance;
+
+void TestClientIface::runTests(IGameDef *gamedef)
+{
+	TEST(testCachedBlockUsedOnce);
+	TEST(testCachedBlockHash);
+	TEST(testCachedBlockLimit);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TestClientIface::testCachedBlockUsedOnce()
+{
+	RemoteClient client;
+	client.setCachedBlock(v3s16(1, 2, 3), 42);
+
+	UASSERT(client.useCachedBlock(v3s16(1, 2, 3), 42));
+	// If the client lost it after all, the block is sent in full next time
+	UASSERT(!client.useCachedBlock(v3s16(1, 2, 3), 42));
+}
+
+void TestClientIface::testCachedBlockHash()
+{
+	RemoteClient client;
+	client.setCachedBlock(v3s16(1, 2, 3), 42);
+
+	UASSERT(!client.useCachedBlock(v3s16(1, 2, 3), 43));
+	UASSERT(!client.useCachedBlock(v3s16(3, 2, 1), 42));
+
+	// Advertised again with new data
+	client.setCachedBlock(v3s16(1, 2, 3), 43);
+	UASSERT(!client.useCachedBlock(v3s16(1, 2, 3), 42));
+	UASSERT(client.useCachedBlock(v3s16(1, 2, 3), 43));
+}
+
+void TestClientIface::testCachedBlockLimit()
+{
+	RemoteClient client;
+	v3s16 p;
+	u32 count = 0;
+	for (p.Z = 0; count < MAX_ADVERTISED_BLOCKS; p.Z++)
+	for (p.X = 0; p.X < 256 && count < MAX_ADVERTISED_BLOCKS; p.X++, count++)
+		client.setCachedBlock(p, 1);
+
+	// Over the limit, new blocks are ignored
+	client.setCachedBlock(v3s16(0, 1, 0), 1);
+	UASSERT(!client.useCachedBlock(v3s16(0, 1, 0), 1));
+
+	// But known ones can still be changed
+	client.setCachedBlock(v3s16(0, 0, 0), 2);
+	UASSERT(client.useCachedBlock(v3s16(0, 0, 0), 2));
+
+	// Using one makes room for another
+	client.setCachedBlock(v3s16(0, 1, 0), 1);
+	UASSERT(client.useCachedBlock(v3s16(0, 1, 0), 1));
+	UASSERT(client.useCachedBlock(v3s16(255, 0, 255), 1));
+}
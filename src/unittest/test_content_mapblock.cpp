@@ -160,8 +160,12 @@ class TestMapblockMeshGenerator : public TestBase {
 	void runTests(IGameDef *gamedef) override;
 	void testSimpleNode();
 	void testSurroundedNode();
+	void testPooledCollector();
 	void testInterliquidSame();
 	void testInterliquidDifferent();
+	void testMergedFaces();
+	void testLodMesh();
+	void testLodMeshBorder();
 };
 
 static TestMapblockMeshGenerator g_test_instance;
@@ -171,8 +175,12 @@ void TestMapblockMeshGenerator::runTests(IGameDef *gamedef)
 	set_light_decode_table();
 	TEST(testSimpleNode);
 	TEST(testSurroundedNode);
+	TEST(testPooledCollector);
 	TEST(testInterliquidSame);
 	TEST(testInterliquidDifferent);
+	TEST(testMergedFaces);
+	TEST(testLodMesh);
+	TEST(testLodMeshBorder);
 }
 
 namespace quad {
@@ -227,6 +235,37 @@ void TestMapblockMeshGenerator::testSurroundedNode()
 	UASSERT(checkMeshEqual(buf.vertices, buf.indices, {quad::xn, quad::yn, quad::yp, quad::zn, quad::zp}));
 }
 
+void TestMapblockMeshGenerator::testPooledCollector()
+{
+	MockGameDef gamedef;
+	content_t stone = gamedef.addSimpleNode("stone", 42);
+	gamedef.finalize();
+
+	MeshMakeData data = gamedef.makeSingleNodeMMD();
+	data.m_vmanip.setNode({0, 0, 0}, {stone, 0, 0});
+
+	PreMeshBufferPool pool;
+	const video::S3DVertex *storage;
+	{
+		MeshCollector col{{}, {}, &pool};
+		MapblockMeshGenerator mg{&data, &col};
+		mg.generate();
+		UASSERTEQ(std::size_t, col.prebuffers[0].size(), 1);
+		storage = col.prebuffers[0][0].vertices.data();
+	}
+
+	// The second mesh is made in the storage of the first one
+	MeshCollector col{{}, {}, &pool};
+	MapblockMeshGenerator mg{&data, &col};
+	mg.generate();
+	UASSERTEQ(std::size_t, col.prebuffers[0].size(), 1);
+
+	auto &&buf = col.prebuffers[0][0];
+	UASSERT(buf.vertices.data() == storage);
+	UASSERTEQ(u32, buf.layer.texture_id, 42);
+	UASSERT(checkMeshEqual(buf.vertices, buf.indices, {quad::xn, quad::xp, quad::yn, quad::yp, quad::zn, quad::zp}));
+}
+
 void TestMapblockMeshGenerator::testInterliquidSame()
 {
 	MockGameDef gamedef;
@@ -270,4 +309,153 @@ void TestMapblockMeshGenerator::testInterliquidDifferent()
 	UASSERT(checkMeshEqual(buf.vertices, buf.indices, {quad::xn, quad::xp, quad::yn, quad::yp, quad::zn, quad::zp}));
 }
 
+void TestMapblockMeshGenerator::testMergedFaces()
+{
+	MockGameDef gamedef;
+	content_t stone = gamedef.addSimpleNode("stone", 42);
+	gamedef.finalize();
+
+	// A row of three stone nodes along X, all of it uniformly dark
+	auto generate = [&] (bool merge_faces) {
+		MeshMakeData data{gamedef.ndef(), 3, MeshGrid{1}};
+		data.m_smooth_lighting = false;
+		data.m_merge_faces = merge_faces;
+		data.m_blockpos = {0, 0, 0};
+		for (s16 x = -1; x <= 3; x++)
+		for (s16 y = -1; y <= 3; y++)
+		for (s16 z = -1; z <= 3; z++)
+			data.m_vmanip.setNode({x, y, z}, {CONTENT_AIR, 0, 0});
+		for (s16 x = 0; x < 3; x++)
+			data.m_vmanip.setNode({x, 0, 0}, {stone, 0, 0});
+
+		MeshCollector col{{}};
+		MapblockMeshGenerator mg{&data, &col};
+		mg.generate();
+		UASSERTEQ(std::size_t, col.prebuffers[0].size(), 1);
+		UASSERTEQ(std::size_t, col.prebuffers[1].size(), 0);
+		return col.prebuffers[0][0];
+	};
+
+	// 4 faces along the row for every node and the 2 ends
+	PreMeshBuffer separate = generate(false);
+	UASSERTEQ(std::size_t, separate.vertices.size(), 14 * 4);
+	UASSERTEQ(std::size_t, separate.indices.size(), 14 * 6);
+
+	// 4 long faces and the 2 ends, covering the same space
+	PreMeshBuffer merged = generate(true);
+	UASSERTEQ(std::size_t, merged.vertices.size(), 6 * 4);
+	UASSERTEQ(std::size_t, merged.indices.size(), 6 * 6);
+	UASSERTEQ(u32, merged.layer.texture_id, 42);
+
+	aabb3f box(merged.vertices[0].Pos);
+	for (const auto &vertex : merged.vertices) {
+		box.addInternalPoint(vertex.Pos);
+		// The texture is repeated along the long faces
+		UASSERT(std::abs(vertex.TCoords.X) <= 3.0f);
+		UASSERT(std::abs(vertex.TCoords.Y) <= 3.0f);
+	}
+	UASSERT(box.MinEdge.equals(v3f(-0.5f * BS)));
+	UASSERT(box.MaxEdge.equals(v3f(2.5f * BS, 0.5f * BS, 0.5f * BS)));
+}
+
+void TestMapblockMeshGenerator::testLodMesh()
+{
+	MockGameDef gamedef;
+	content_t stone = gamedef.addSimpleNode("stone", 42);
+	gamedef.finalize();
+
+	// A 4x2x4 slab of stone at the bottom of a mesh of 4x4x4 nodes
+	auto generate = [&] (u8 lod) {
+		MeshMakeData data{gamedef.ndef(), 4, MeshGrid{1}};
+		data.m_lod = lod;
+		data.m_blockpos = {0, 0, 0};
+		for (s16 x = -1; x <= 4; x++)
+		for (s16 y = -1; y <= 4; y++)
+		for (s16 z = -1; z <= 4; z++)
+			data.m_vmanip.setNode({x, y, z}, {CONTENT_AIR, 0, 0});
+		for (s16 x = 0; x < 4; x++)
+		for (s16 y = 0; y < 2; y++)
+		for (s16 z = 0; z < 4; z++)
+			data.m_vmanip.setNode({x, y, z}, {stone, 0, 0});
+
+		MeshCollector col{{}};
+		MapblockMeshGenerator mg{&data, &col};
+		mg.generate();
+		UASSERTEQ(std::size_t, col.prebuffers[0].size(), 1);
+		UASSERTEQ(std::size_t, col.prebuffers[1].size(), 0);
+		return col.prebuffers[0][0];
+	};
+
+	// 16 faces on top and bottom, 8 on every side
+	PreMeshBuffer full = generate(1);
+	UASSERTEQ(std::size_t, full.vertices.size(), 64 * 4);
+
+	// Cubes of 2x2x2 nodes: 4 faces on top and bottom, 2 on every side
+	PreMeshBuffer lod = generate(2);
+	UASSERTEQ(std::size_t, lod.vertices.size(), 16 * 4);
+	UASSERTEQ(std::size_t, lod.indices.size(), 16 * 6);
+	UASSERTEQ(u32, lod.layer.texture_id, 42);
+
+	aabb3f box(lod.vertices[0].Pos);
+	for (const auto &vertex : lod.vertices)
+		box.addInternalPoint(vertex.Pos);
+	UASSERT(box.MinEdge.equals(v3f(-0.5f * BS)));
+	UASSERT(box.MaxEdge.equals(v3f(3.5f * BS, 1.5f * BS, 3.5f * BS)));
+}
+
+}
+
+void TestMapblockMeshGenerator::testLodMeshBorder()
+{
+	MockGameDef gamedef;
+	content_t stone = gamedef.addSimpleNode("stone", 42);
+	gamedef.finalize();
+
+	// Air in a mesh of 4x4x4 nodes and the layer around it, then stone
+	auto generate = [&] (const std::vector<v3s16> &stone_nodes) {
+		MeshMakeData data{gamedef.ndef(), 4, MeshGrid{1}};
+		data.m_lod = 2;
+		data.m_blockpos = {0, 0, 0};
+		for (s16 x = -1; x <= 4; x++)
+		for (s16 y = -1; y <= 4; y++)
+		for (s16 z = -1; z <= 4; z++)
+			data.m_vmanip.setNode({x, y, z}, {CONTENT_AIR, 0, 0});
+		for (v3s16 p : stone_nodes)
+			data.m_vmanip.setNode(p, {stone, 0, 0});
+
+		MeshCollector col{{}};
+		MapblockMeshGenerator mg{&data, &col};
+		mg.generate();
+		return col.prebuffers[0].empty() ? PreMeshBuffer() : col.prebuffers[0][0];
+	};
+
+	// A 4x2x4 slab of stone at the bottom of the mesh, and nodes next to it
+	std::vector<v3s16> slab;
+	for (s16 x = 0; x < 4; x++)
+	for (s16 y = 0; y < 2; y++)
+	for (s16 z = 0; z < 4; z++)
+		slab.emplace_back(x, y, z);
+
+	// Half of the layer in front of the X+ side is stone. The faces there
+	// stay, the neighboring mesh might not show that stone.
+	std::vector<v3s16> nodes = slab;
+	for (s16 z = 0; z < 4; z++)
+		nodes.emplace_back(4, 0, z);
+	UASSERTEQ(std::size_t, generate(nodes).vertices.size(), 16 * 4);
+
+	// All of it is stone, so the faces are hidden
+	for (s16 z = 0; z < 4; z++)
+		nodes.emplace_back(4, 1, z);
+	UASSERTEQ(std::size_t, generate(nodes).vertices.size(), 14 * 4);
+
+	// One stone node is not enough for a cell. It is on the X+ and Y-
+	// borders, where the neighboring meshes might have culled their faces
+	// against it, so it gets a face on each of them instead.
+	PreMeshBuffer skirt = generate({v3s16(3, 0, 1)});
+	UASSERTEQ(std::size_t, skirt.vertices.size(), 2 * 4);
+	aabb3f box(skirt.vertices[0].Pos);
+	for (const auto &vertex : skirt.vertices)
+		box.addInternalPoint(vertex.Pos);
+	UASSERT(box.MinEdge.equals(v3f(2.5f * BS, -0.5f * BS, 0.5f * BS)));
+	UASSERT(box.MaxEdge.equals(v3f(3.5f * BS, 0.5f * BS, 1.5f * BS)));
 }
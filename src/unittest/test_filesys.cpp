@@ -315,6 +315,9 @@ void TestFileSys::testSafeWriteToFile()
 		std::string contents_actual;
 		UASSERT(fs::ReadFile(dest_path, contents_actual));
 		UASSERTEQ(auto, contents_actual, test_data);
+		uint64_t size, mtime;
+		UASSERT(fs::GetFileInfo(dest_path, &size, &mtime));
+		UASSERTEQ(uint64_t, size, test_data.size());
 	}
 
 	// Writing directly to /tmp could trigger an edge case
@@ -372,6 +375,8 @@ void TestFileSys::testNonExist()
 	UASSERT(!fs::IsFile(path));
 	UASSERT(!fs::IsDir(path));
 	UASSERT(!fs::IsExecutable(path));
+	uint64_t size, mtime;
+	UASSERT(!fs::GetFileInfo(path, &size, &mtime));
 
 	std::string s;
 	UASSERT(!fs::ReadFile(path, s));
@@ -0,0 +1,294 @@
+// Luanti
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 Minetest Authors
+
+#include "client/imagesource.h"
+#include "irr_ptr.h"
+#include "noise.h"
+
+#include "IVideoDriver.h"
+#include "irrlicht.h"
+
+#include "catch.h"
+
+#include <cmath>
+#include <cstring>
+
+// The texture modifiers work on the pixel arrays directly where possible.
+// These are the versions that went through getPixel() and setPixel() for
+// every pixel, the results have to be exactly the same.
+namespace reference {
+
+static void apply_colorize(video::IImage *dst, v2u32 dst_pos, v2u32 size,
+		const video::SColor color, int ratio, bool keep_alpha)
+{
+	u32 alpha = color.getAlpha();
+	video::SColor dst_c;
+	if ((ratio == -1 && alpha == 255) || ratio == 255) {
+		if (keep_alpha) {
+			dst_c = color;
+			for (u32 y = dst_pos.Y; y < dst_pos.Y + size.Y; y++)
+			for (u32 x = dst_pos.X; x < dst_pos.X + size.X; x++) {
+				u32 dst_alpha = dst->getPixel(x, y).getAlpha();
+				if (dst_alpha > 0) {
+					dst_c.setAlpha(dst_alpha * alpha / 255);
+					dst->setPixel(x, y, dst_c);
+				}
+			}
+		} else {
+			for (u32 y = dst_pos.Y; y < dst_pos.Y + size.Y; y++)
+			for (u32 x = dst_pos.X; x < dst_pos.X + size.X; x++)
+				if (dst->getPixel(x, y).getAlpha() > 0)
+					dst->setPixel(x, y, color);
+		}
+	} else {
+		float interp = (ratio == -1 ? color.getAlpha() / 255.0f : ratio / 255.0f);
+		for (u32 y = dst_pos.Y; y < dst_pos.Y + size.Y; y++)
+		for (u32 x = dst_pos.X; x < dst_pos.X + size.X; x++) {
+			dst_c = dst->getPixel(x, y);
+			if (dst_c.getAlpha() > 0) {
+				dst_c = color.getInterpolated(dst_c, interp);
+				dst->setPixel(x, y, dst_c);
+			}
+		}
+	}
+}
+
+static void apply_multiplication(video::IImage *dst, v2u32 dst_pos, v2u32 size,
+		const video::SColor color)
+{
+	video::SColor dst_c;
+
+	for (u32 y = dst_pos.Y; y < dst_pos.Y + size.Y; y++)
+	for (u32 x = dst_pos.X; x < dst_pos.X + size.X; x++) {
+		dst_c = dst->getPixel(x, y);
+		dst_c.set(
+				dst_c.getAlpha(),
+				(dst_c.getRed() * color.getRed()) / 255,
+				(dst_c.getGreen() * color.getGreen()) / 255,
+				(dst_c.getBlue() * color.getBlue()) / 255
+				);
+		dst->setPixel(x, y, dst_c);
+	}
+}
+
+static void apply_screen(video::IImage *dst, v2u32 dst_pos, v2u32 size,
+		const video::SColor color)
+{
+	video::SColor dst_c;
+
+	for (u32 y = dst_pos.Y; y < dst_pos.Y + size.Y; y++)
+	for (u32 x = dst_pos.X; x < dst_pos.X + size.X; x++) {
+		dst_c = dst->getPixel(x, y);
+		dst_c.set(
+			dst_c.getAlpha(),
+			255 - ((255 - dst_c.getRed())   * (255 - color.getRed()))   / 255,
+			255 - ((255 - dst_c.getGreen()) * (255 - color.getGreen())) / 255,
+			255 - ((255 - dst_c.getBlue())  * (255 - color.getBlue()))  / 255
+		);
+		dst->setPixel(x, y, dst_c);
+	}
+}
+
+static void apply_overlay(video::IImage *blend, video::IImage *dst,
+	v2s32 blend_pos, v2s32 dst_pos, v2u32 size, bool hardlight)
+{
+	video::IImage *blend_layer = hardlight ? dst : blend;
+	video::IImage *base_layer  = hardlight ? blend : dst;
+	v2s32 blend_layer_pos = hardlight ? dst_pos : blend_pos;
+	v2s32 base_layer_pos  = hardlight ? blend_pos : dst_pos;
+
+	for (u32 y = 0; y < size.Y; y++)
+	for (u32 x = 0; x < size.X; x++) {
+		s32 base_x = x + base_layer_pos.X;
+		s32 base_y = y + base_layer_pos.Y;
+
+		video::SColor blend_c =
+			blend_layer->getPixel(x + blend_layer_pos.X, y + blend_layer_pos.Y);
+		video::SColor base_c = base_layer->getPixel(base_x, base_y);
+		f32 blend_r = blend_c.getRed()   / 255.0f;
+		f32 blend_g = blend_c.getGreen() / 255.0f;
+		f32 blend_b = blend_c.getBlue()  / 255.0f;
+		f32 base_r = base_c.getRed()   / 255.0f;
+		f32 base_g = base_c.getGreen() / 255.0f;
+		f32 base_b = base_c.getBlue()  / 255.0f;
+
+		base_c.set(
+			base_c.getAlpha(),
+			(u32)((base_r < 0.5f ? 2 * base_r * blend_r : 1 - 2 * (1 - base_r) * (1 - blend_r)) * 255),
+			(u32)((base_g < 0.5f ? 2 * base_g * blend_g : 1 - 2 * (1 - base_g) * (1 - blend_g)) * 255),
+			(u32)((base_b < 0.5f ? 2 * base_b * blend_b : 1 - 2 * (1 - base_b) * (1 - blend_b)) * 255)
+		);
+		dst->setPixel(base_x, base_y, base_c);
+	}
+}
+
+static void apply_brightness_contrast(video::IImage *dst, v2u32 dst_pos, v2u32 size,
+	s32 brightness, s32 contrast)
+{
+	f32 norm_c = core::clamp(contrast,   -127, 127) / 128.0f;
+	f32 norm_b = core::clamp(brightness, -127, 127) / 127.0f;
+	f32 scaled_b = brightness * 127.5f / 127;
+	f32 slope = 1 - std::fabs(norm_b);
+
+	f32 angle = std::atan(slope);
+	angle += norm_c <= 0
+		? norm_c * angle
+		: norm_c * (M_PI_2 - angle);
+	slope = std::tan(angle);
+
+	f32 c = slope <= 1
+		? -slope * 127.5f + 127.5f + scaled_b
+		: -slope * (127.5f - scaled_b) + 127.5f;
+	c += 0.5f;
+
+	video::SColor dst_c;
+	for (u32 y = dst_pos.Y; y < dst_pos.Y + size.Y; y++)
+	for (u32 x = dst_pos.X; x < dst_pos.X + size.X; x++) {
+		dst_c = dst->getPixel(x, y);
+
+		dst_c.set(
+			dst_c.getAlpha(),
+			core::clamp((int)(slope * dst_c.getRed()   + c), 0, 255),
+			core::clamp((int)(slope * dst_c.getGreen() + c), 0, 255),
+			core::clamp((int)(slope * dst_c.getBlue()  + c), 0, 255)
+		);
+		dst->setPixel(x, y, dst_c);
+	}
+}
+
+static void apply_mask(video::IImage *mask, video::IImage *dst,
+		v2s32 mask_pos, v2s32 dst_pos, v2u32 size)
+{
+	for (u32 y0 = 0; y0 < size.Y; y0++) {
+		for (u32 x0 = 0; x0 < size.X; x0++) {
+			s32 mask_x = x0 + mask_pos.X;
+			s32 mask_y = y0 + mask_pos.Y;
+			s32 dst_x = x0 + dst_pos.X;
+			s32 dst_y = y0 + dst_pos.Y;
+			video::SColor mask_c = mask->getPixel(mask_x, mask_y);
+			video::SColor dst_c = dst->getPixel(dst_x, dst_y);
+			dst_c.color &= mask_c.color;
+			dst->setPixel(dst_x, dst_y, dst_c);
+		}
+	}
+}
+
+}  // namespace reference
+
+TEST_CASE("texture modifiers") {
+
+SIrrlichtCreationParameters p;
+p.DriverType = video::EDT_NULL;
+auto *device = createDeviceEx(p);
+REQUIRE(device);
+video::IVideoDriver *driver = device->getVideoDriver();
+
+const core::dimension2du dim(37, 19);
+PcgRandom pr(1234);
+
+// Random pixels, with a fair share of fully transparent and opaque ones
+const auto make_image = [&] () {
+	irr_ptr<video::IImage> img(driver->createImage(video::ECF_A8R8G8B8, dim));
+	for (u32 y = 0; y < dim.Height; y++)
+	for (u32 x = 0; x < dim.Width; x++) {
+		u32 alpha = pr.range(0, 3) == 0 ? 0 : pr.range(0, 1) ? 255 : pr.range(0, 255);
+		img->setPixel(x, y, video::SColor(alpha, pr.range(0, 255),
+			pr.range(0, 255), pr.range(0, 255)));
+	}
+	return img;
+};
+const auto copy_image = [&] (video::IImage *img) {
+	irr_ptr<video::IImage> copy(driver->createImage(img->getColorFormat(), dim));
+	memcpy(copy->getData(), img->getData(), img->getImageDataSizeInBytes());
+	return copy;
+};
+const auto same_pixels = [&] (video::IImage *a, video::IImage *b) {
+	return memcmp(a->getData(), b->getData(), a->getImageDataSizeInBytes()) == 0;
+};
+
+// The whole image, and an area that does not touch its borders. The second
+// image of the two image modifiers gets a different area of the same size.
+const v2u32 areas[][3] = {
+	{v2u32(0, 0), v2u32(dim.Width, dim.Height), v2u32(0, 0)},
+	{v2u32(3, 5), v2u32(20, 9), v2u32(1, 2)},
+};
+const video::SColor colors[] = {
+	video::SColor(255, 255, 0, 0),
+	video::SColor(128, 10, 200, 90),
+	video::SColor(0, 255, 255, 255),
+};
+
+SECTION("colorize") {
+	for (const auto &area : areas)
+	for (video::SColor color : colors)
+	for (int ratio : {-1, 0, 100, 255})
+	for (bool keep_alpha : {false, true}) {
+		auto img = make_image();
+		auto ref = copy_image(img.get());
+		apply_colorize(img.get(), area[0], area[1], color, ratio, keep_alpha);
+		reference::apply_colorize(ref.get(), area[0], area[1], color, ratio, keep_alpha);
+		CHECK(same_pixels(img.get(), ref.get()));
+	}
+}
+
+SECTION("multiply and screen") {
+	for (const auto &area : areas)
+	for (video::SColor color : colors) {
+		auto img = make_image();
+		auto ref = copy_image(img.get());
+		apply_multiplication(img.get(), area[0], area[1], color);
+		reference::apply_multiplication(ref.get(), area[0], area[1], color);
+		CHECK(same_pixels(img.get(), ref.get()));
+
+		apply_screen(img.get(), area[0], area[1], color);
+		reference::apply_screen(ref.get(), area[0], area[1], color);
+		CHECK(same_pixels(img.get(), ref.get()));
+	}
+}
+
+SECTION("brightness and contrast") {
+	for (const auto &area : areas)
+	for (s32 brightness : {-127, -20, 0, 60, 127})
+	for (s32 contrast : {-127, -30, 0, 80, 127}) {
+		auto img = make_image();
+		auto ref = copy_image(img.get());
+		apply_brightness_contrast(img.get(), area[0], area[1], brightness, contrast);
+		reference::apply_brightness_contrast(ref.get(), area[0], area[1],
+			brightness, contrast);
+		CHECK(same_pixels(img.get(), ref.get()));
+	}
+}
+
+SECTION("overlay and hardlight") {
+	for (const auto &area : areas)
+	for (bool hardlight : {false, true}) {
+		auto blend = make_image();
+		auto img = make_image();
+		auto ref = copy_image(img.get());
+		const v2s32 pos = v2s32::from(area[0]);
+		// Hardlight swaps the layers, so both areas have to be the same
+		const v2s32 blend_pos = hardlight ? pos : v2s32::from(area[2]);
+		apply_overlay(blend.get(), img.get(), blend_pos, pos, area[1], hardlight);
+		reference::apply_overlay(blend.get(), ref.get(), blend_pos, pos, area[1],
+			hardlight);
+		CHECK(same_pixels(img.get(), ref.get()));
+	}
+}
+
+SECTION("mask") {
+	for (const auto &area : areas) {
+		auto mask = make_image();
+		auto img = make_image();
+		auto ref = copy_image(img.get());
+		const v2s32 pos = v2s32::from(area[0]);
+		const v2s32 mask_pos = v2s32::from(area[2]);
+		apply_mask(mask.get(), img.get(), mask_pos, pos, area[1]);
+		reference::apply_mask(mask.get(), ref.get(), mask_pos, pos, area[1]);
+		CHECK(same_pixels(img.get(), ref.get()));
+	}
+}
+
+device->closeDevice();
+device->drop();
+}
@@ -19,6 +19,8 @@ class TestMapgen : public TestBase
 	void runTests(IGameDef *gamedef);
 
 	void testBiomeGen(IGameDef *gamedef);
+	void testBiomeNoiseCache(IGameDef *gamedef);
+	void testBiomeMapContents();
 	void testMapgenEdges();
 };
 
@@ -39,6 +41,8 @@ namespace {
 void TestMapgen::runTests(IGameDef *gamedef)
 {
 	TEST(testBiomeGen, gamedef);
+	TEST(testBiomeNoiseCache, gamedef);
+	TEST(testBiomeMapContents);
 	TEST(testMapgenEdges);
 }
 
@@ -126,6 +130,55 @@ void TestMapgen::testBiomeGen(IGameDef *gamedef)
 	}
 }
 
+void TestMapgen::testBiomeNoiseCache(IGameDef *gamedef)
+{
+	MockServer server(getTestTempDirectory());
+	MockBiomeManager bmgr(&server);
+	bmgr.setNodeDefManager(gamedef->getNodeDefManager());
+
+	std::unique_ptr<BiomeParams> params(BiomeManager::createBiomeParams(BIOMEGEN_ORIGINAL));
+	constexpr v3s16 CSIZE(16, 16, 16);
+	constexpr size_t count = CSIZE.X * CSIZE.Z;
+	std::unique_ptr<BiomeGen> bg1(bmgr.createBiomeGen(BIOMEGEN_ORIGINAL, params.get(), CSIZE));
+	std::unique_ptr<BiomeGen> bg2(bg1->clone(&bmgr));
+	std::unique_ptr<BiomeGen> bg3(bmgr.createBiomeGen(BIOMEGEN_ORIGINAL, params.get(), CSIZE));
+	auto *bgo1 = static_cast<BiomeGenOriginal *>(bg1.get());
+	auto *bgo2 = static_cast<BiomeGenOriginal *>(bg2.get());
+	auto *bgo3 = static_cast<BiomeGenOriginal *>(bg3.get());
+
+	bgo1->calcBiomeNoise(v3s16(160, 0, -320));
+	const std::vector<float> heat(bgo1->heatmap, bgo1->heatmap + count);
+	const std::vector<float> humidity(bgo1->humidmap, bgo1->humidmap + count);
+
+	// Cached, from a clone and for a chunk above
+	bgo2->calcBiomeNoise(v3s16(160, 16, -320));
+	UASSERT(std::equal(heat.begin(), heat.end(), bgo2->heatmap));
+	UASSERT(std::equal(humidity.begin(), humidity.end(), bgo2->humidmap));
+
+	// Not cached, must be the same
+	bgo3->calcBiomeNoise(v3s16(160, -16, -320));
+	UASSERT(std::equal(heat.begin(), heat.end(), bgo3->heatmap));
+	UASSERT(std::equal(humidity.begin(), humidity.end(), bgo3->humidmap));
+
+	// A different column
+	bgo2->calcBiomeNoise(v3s16(176, 0, -320));
+	UASSERT(!std::equal(heat.begin(), heat.end(), bgo2->heatmap));
+}
+
+void TestMapgen::testBiomeMapContents()
+{
+	const biome_t biomemap[] = {1, 1, 4, 1, 0, 4};
+	BiomeMapContents contents(biomemap, ARRLEN(biomemap));
+	UASSERT(contents.containsAny({}));
+	UASSERT(contents.containsAny({0}));
+	UASSERT(contents.containsAny({2, 4}));
+	UASSERT(!contents.containsAny({2, 3}));
+	UASSERT(!contents.containsAny({100}));
+
+	BiomeMapContents no_biomes(nullptr, 0);
+	UASSERT(no_biomes.containsAny({100}));
+}
+
 void TestMapgen::testMapgenEdges()
 {
 	v3s16 emin, emax;
@@ -0,0 +1,83 @@
+// Luanti
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 Minetest Authors
+
+#include "test.h"
+
+#include "filesys.h"
+#include "server/mediaindex.h"
+
+class TestMediaIndex : public TestBase
+{
+public:
+	TestMediaIndex() { TestManager::registerTestModule(this); }
+	const char *getName() override { return "TestMediaIndex"; }
+
+	void runTests(IGameDef *gamedef) override;
+
+	void testRoundTrip();
+	void testNewerThanIndex();
+	void testMissingIndex();
+};
+
+static TestMediaIndex g_test_instance;
+
+void TestMediaIndex::runTests(IGameDef *gamedef)
+{
+	TEST(testRoundTrip);
+	TEST(testNewerThanIndex);
+	TEST(testMissingIndex);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static const std::string digest_a(20, '\x01');
+static const std::string digest_b("\xff\x00\x10 0123456789abcdef", 20);
+
+void TestMediaIndex::testRoundTrip()
+{
+	const std::string path = getTestTempDirectory() + DIR_DELIM "media" DIR_DELIM "index.txt";
+
+	MediaIndex index;
+	index.set("/mods/a/textures/a.png", {100, 5, digest_a});
+	index.set("/mods/b/textures/with space.png", {0, 6, digest_b});
+	UASSERT(index.write(path));
+
+	MediaIndex read_index;
+	read_index.read(path);
+	UASSERTEQ(size_t, read_index.size(), 2);
+
+	const std::string *digest = read_index.getDigest("/mods/a/textures/a.png", 100, 5);
+	UASSERT(digest && *digest == digest_a);
+	digest = read_index.getDigest("/mods/b/textures/with space.png", 0, 6);
+	UASSERT(digest && *digest == digest_b);
+
+	// Changed files
+	UASSERT(!read_index.getDigest("/mods/a/textures/a.png", 101, 5));
+	UASSERT(!read_index.getDigest("/mods/a/textures/a.png", 100, 7));
+	UASSERT(!read_index.getDigest("/mods/a/textures/b.png", 100, 5));
+}
+
+void TestMediaIndex::testNewerThanIndex()
+{
+	const std::string path = getTestTempFile();
+
+	MediaIndex index;
+	index.set("/old.png", {1, 0, digest_a});
+	// Could have changed after it was hashed, in the same clock tick
+	index.set("/new.png", {1, U64_MAX, digest_a});
+	UASSERT(index.write(path));
+
+	MediaIndex read_index;
+	read_index.read(path);
+	UASSERT(read_index.getDigest("/old.png", 1, 0));
+	UASSERT(!read_index.getDigest("/new.png", 1, U64_MAX));
+}
+
+void TestMediaIndex::testMissingIndex()
+{
+	MediaIndex index;
+	index.read(getTestTempDirectory() + DIR_DELIM "does_not_exist.txt");
+	UASSERTEQ(size_t, index.size(), 0);
+	UASSERT(!index.getDigest("/a.png", 100, 5));
+}
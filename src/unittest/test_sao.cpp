@@ -28,6 +28,8 @@ class TestSAO : public TestBase
 	void testActivate(ServerEnvironment *env);
 	void testStaticToFalse(ServerEnvironment *env);
 	void testStaticToTrue(ServerEnvironment *env);
+	void testStepInterval(ServerEnvironment *env);
+	void testPropertiesUnchanged(ServerEnvironment *env);
 
 private:
 	// enough for both removeRemovedObjects and deactivateFarObjects to be called
@@ -44,6 +46,18 @@ core.register_entity(":test:non_static", {
 		static_save = false,
 	}
 })
+core.register_entity(":test:step_interval", {
+	initial_properties = {
+		static_save = false,
+	},
+	step_interval = 1.0,
+	on_step = function(self, dtime)
+		self._calls = (self._calls or 0) + 1
+		self.object:set_properties({
+			infotext = string.format("%d %.2f", self._calls, dtime),
+		})
+	end,
+})
 )";
 
 void TestSAO::runTests(IGameDef *gamedef)
@@ -87,6 +101,8 @@ void TestSAO::runTests(IGameDef *gamedef)
 	TEST(testActivate, &env);
 	TEST(testStaticToFalse, &env);
 	TEST(testStaticToTrue, &env);
+	TEST(testStepInterval, &env);
+	TEST(testPropertiesUnchanged, &env);
 
 	env.deactivateBlocksAndObjects();
 }
@@ -300,3 +316,74 @@ void TestSAO::testStaticToTrue(ServerEnvironment *env)
 	UASSERTEQ(size_t, block->m_static_objects.getStoredSize(), 1);
 	UASSERTEQ(size_t, block->m_static_objects.getActiveSize(), 0);
 }
+
+void TestSAO::testStepInterval(ServerEnvironment *env)
+{
+	const v3f testpos(0, 7 * BS, -300 * BS);
+
+	auto obj = add_entity(env, testpos, "test:step_interval");
+	UASSERT(obj);
+	const u16 obj_id = obj->getId();
+
+	// on_step must not run before the interval has passed
+	for (int i = 0; i < 3; i++)
+		obj->step(0.25f, false);
+	UASSERT(obj->accessObjectProperties()->infotext.empty());
+
+	// and then receive the accumulated time in one call
+	obj->step(0.25f, false);
+	UASSERTEQ(std::string, obj->accessObjectProperties()->infotext, "1 1.00");
+
+	obj->step(0.25f, false);
+	UASSERTEQ(std::string, obj->accessObjectProperties()->infotext, "1 1.00");
+
+	obj->markForRemoval();
+	env->step(m_step_interval);
+	UASSERT(!env->getActiveObject(obj_id));
+}
+
+static size_t count_properties_messages(ServerActiveObject *obj)
+{
+	std::queue<ActiveObjectMessage> queue;
+	obj->dumpAOMessagesToQueue(queue);
+	size_t count = 0;
+	for (; !queue.empty(); queue.pop()) {
+		if (queue.front().datastring[0] == AO_CMD_SET_PROPERTIES)
+			count++;
+	}
+	return count;
+}
+
+void TestSAO::testPropertiesUnchanged(ServerEnvironment *env)
+{
+	const v3f testpos(-300 * BS, 7 * BS, 0);
+
+	auto obj = add_entity(env, testpos, "test:non_static");
+	UASSERT(obj);
+	const u16 obj_id = obj->getId();
+
+	obj->notifyObjectPropertiesModified();
+	obj->step(0.1f, false);
+	UASSERTEQ(size_t, count_properties_messages(obj), 1);
+
+	// Nothing changed, nothing to send
+	obj->notifyObjectPropertiesModified();
+	obj->step(0.1f, false);
+	UASSERTEQ(size_t, count_properties_messages(obj), 0);
+
+	obj->accessObjectProperties()->nametag = "changed";
+	obj->notifyObjectPropertiesModified();
+	obj->step(0.1f, false);
+	UASSERTEQ(size_t, count_properties_messages(obj), 1);
+
+	// A client seeing the object for the first time gets full data,
+	// afterwards updates must not be skipped anymore.
+	obj->getClientInitializationData(LATEST_PROTOCOL_VERSION);
+	obj->notifyObjectPropertiesModified();
+	obj->step(0.1f, false);
+	UASSERTEQ(size_t, count_properties_messages(obj), 1);
+
+	obj->markForRemoval();
+	env->step(m_step_interval);
+	UASSERT(!env->getActiveObject(obj_id));
+}
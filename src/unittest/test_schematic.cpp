@@ -5,8 +5,10 @@
 #include "test.h"
 
 #include "mapgen/mg_schematic.h"
+#include "dummymap.h"
 #include "gamedef.h"
 #include "nodedef.h"
+#include "util/numeric.h"
 
 class TestSchematic : public TestBase {
 public:
@@ -18,6 +20,7 @@ class TestSchematic : public TestBase {
 	void testMtsSerializeDeserialize(const NodeDefManager *ndef);
 	void testLuaTableSerialize(const NodeDefManager *ndef);
 	void testFileSerializeDeserialize(const NodeDefManager *ndef);
+	void testBlitToVManip(IGameDef *gamedef);
 
 	static const content_t test_schem1_data[7 * 6 * 4];
 	static const content_t test_schem2_data[3 * 3 * 3];
@@ -37,6 +40,7 @@ void TestSchematic::runTests(IGameDef *gamedef)
 	TEST(testMtsSerializeDeserialize, ndef);
 	TEST(testLuaTableSerialize, ndef);
 	TEST(testFileSerializeDeserialize, ndef);
+	TEST(testBlitToVManip, gamedef);
 
 	ndef->resetNodeResolveState();
 }
@@ -172,6 +176,128 @@ void TestSchematic::testFileSerializeDeserialize(const NodeDefManager *ndef)
 }
 
 
+namespace {
+	// Straightforward per-node placement, as the schematic code used to do it
+	void blit_reference(const Schematic &schem, const NodeDefManager *ndef,
+		MMVManip *vm, v3s16 p, Rotation rot, bool force_place)
+	{
+		int xstride = 1;
+		int ystride = schem.size.X;
+		int zstride = schem.size.X * schem.size.Y;
+		s16 sx = schem.size.X, sy = schem.size.Y, sz = schem.size.Z;
+
+		int i_start, i_step_x, i_step_z;
+		switch (rot) {
+			case ROTATE_90:
+				i_start = sx - 1; i_step_x = zstride; i_step_z = -xstride;
+				std::swap(sx, sz);
+				break;
+			case ROTATE_180:
+				i_start = zstride * (sz - 1) + sx - 1; i_step_x = -xstride; i_step_z = -zstride;
+				break;
+			case ROTATE_270:
+				i_start = zstride * (sz - 1); i_step_x = -zstride; i_step_z = xstride;
+				std::swap(sx, sz);
+				break;
+			default:
+				i_start = 0; i_step_x = xstride; i_step_z = zstride;
+		}
+
+		// Skipped slices don't take up space, the ones above move down
+		s16 y_map = p.Y;
+		for (s16 y = 0; y != sy; y++) {
+			if (schem.slice_probs[y] != MTSCHEM_PROB_ALWAYS &&
+					schem.slice_probs[y] <= myrand_range(1, MTSCHEM_PROB_ALWAYS))
+				continue;
+			for (s16 z = 0; z != sz; z++) {
+				u32 i = z * i_step_z + y * ystride + i_start;
+				for (s16 x = 0; x != sx; x++, i += i_step_x) {
+					v3s16 pos(p.X + x, y_map, p.Z + z);
+					const MapNode &n = schem.schemdata[i];
+					u8 prob = n.param1 & MTSCHEM_PROB_MASK;
+					if (!vm->m_area.contains(pos) || n.getContent() == CONTENT_IGNORE ||
+							prob == MTSCHEM_PROB_NEVER)
+						continue;
+					u32 vi = vm->m_area.index(pos);
+					if (!force_place && !(n.param1 & MTSCHEM_FORCE_PLACE)) {
+						content_t c = vm->m_data[vi].getContent();
+						if (c != CONTENT_AIR && c != CONTENT_IGNORE)
+							continue;
+					}
+					if (prob != MTSCHEM_PROB_ALWAYS &&
+							prob <= myrand_range(1, MTSCHEM_PROB_ALWAYS))
+						continue;
+					vm->m_data[vi] = n;
+					vm->m_data[vi].param1 = 0;
+					if (rot)
+						vm->m_data[vi].rotateAlongYAxis(ndef, rot);
+				}
+			}
+			y_map++;
+		}
+	}
+}
+
+
+void TestSchematic::testBlitToVManip(IGameDef *gamedef)
+{
+	const NodeDefManager *ndef = gamedef->getNodeDefManager();
+	static const v3s16 size(7, 5, 6);
+	static const u32 volume = size.X * size.Y * size.Z;
+	static const u8 probs[] = {
+		MTSCHEM_PROB_ALWAYS, MTSCHEM_PROB_ALWAYS, MTSCHEM_PROB_NEVER, 40, 90,
+	};
+
+	Schematic schem;
+	schem.m_nodenames = {"air", "default:stone", "default:water", "ignore"};
+	schem.m_nnlistsizes.push_back(schem.m_nodenames.size());
+	schem.size        = size;
+	schem.schemdata   = new MapNode[volume];
+	schem.slice_probs = new u8[size.Y];
+	for (u32 i = 0; i != volume; i++) {
+		u8 param1 = probs[i * 3 % 5];
+		if (i % 11 < 3)
+			param1 |= MTSCHEM_FORCE_PLACE;
+		schem.schemdata[i] = MapNode(i * 7 % 13 % 4, param1, i % 4);
+	}
+	for (s16 y = 0; y != size.Y; y++)
+		schem.slice_probs[y] = y % 2 ? 64 : MTSCHEM_PROB_ALWAYS;
+	ndef->pendNodeResolve(&schem);
+	UASSERT(schem.isResolveDone());
+
+	DummyMap map(gamedef, v3s16(-1, -1, -1), v3s16(0, 0, 0));
+	MMVManip vm(&map), vm_ref(&map);
+	vm.initialEmerge(v3s16(-1, -1, -1), v3s16(0, 0, 0));
+	vm_ref.initialEmerge(v3s16(-1, -1, -1), v3s16(0, 0, 0));
+	const u32 vm_volume = vm.m_area.getVolume();
+
+	// Inside, and sticking out of the voxel area on every side
+	const v3s16 positions[] = {
+		v3s16(-8, -8, -8), v3s16(-19, -18, -17), v3s16(12, 13, 11),
+	};
+
+	for (v3s16 p : positions)
+	for (int rot = ROTATE_0; rot <= ROTATE_270; rot++)
+	for (bool force_place : {false, true}) {
+		for (u32 i = 0; i != vm_volume; i++) {
+			vm.m_data[i] = MapNode(i % 3 ? CONTENT_AIR : t_CONTENT_STONE);
+			vm_ref.m_data[i] = vm.m_data[i];
+		}
+
+		mysrand(rot + 4 * force_place);
+		schem.blitToVManip(&vm, p, (Rotation)rot, force_place);
+		int next = myrand();
+
+		mysrand(rot + 4 * force_place);
+		blit_reference(schem, ndef, &vm_ref, p, (Rotation)rot, force_place);
+		UASSERTEQ(int, next, myrand());
+
+		for (u32 i = 0; i != vm_volume; i++)
+			UASSERT(vm.m_data[i] == vm_ref.m_data[i]);
+	}
+}
+
+
 // Should form a cross-shaped-thing...?
 const content_t TestSchematic::test_schem1_data[7 * 6 * 4] = {
 	3, 3, 1, 1, 1, 3, 3, // Y=0, Z=0
@@ -6,6 +6,7 @@
 
 #include <cmath>
 #include "script/cpp_api/s_base.h"
+#include "script/cpp_api/s_security.h"
 #include "script/lua_api/l_util.h"
 #include "script/lua_api/l_settings.h"
 #include "script/common/c_converter.h"
@@ -36,6 +37,7 @@ class TestScriptApi : public TestBase, LuaHelper
 	void testVectorReadMix(MyScriptApi *script);
 	void testVectorReadFloat(MyScriptApi *script);
 	void testReadParamFloat(MyScriptApi *script);
+	void testSafeLoadFileCache(MyScriptApi *script);
 };
 
 static TestScriptApi g_test_instance;
@@ -78,6 +80,7 @@ void TestScriptApi::runTests(IGameDef *gamedef)
 	TEST(testVectorReadMix, &script);
 	TEST(testVectorReadFloat, &script);
 	TEST(testReadParamFloat, &script);
+	TEST(testSafeLoadFileCache, &script);
 }
 
 // Runs Lua code and leaves `nresults` return values on the stack
@@ -252,3 +255,42 @@ void TestScriptApi::testReadParamFloat(MyScriptApi *script)
 		lua_pop(L, 1);
 	}
 }
+
+void TestScriptApi::testSafeLoadFileCache(MyScriptApi *script)
+{
+	lua_State *L = script->getStack();
+	StackUnroller unroller(L);
+
+	const std::string path = getTestTempFile();
+	const auto &write_file = [&] (const char *code) {
+		std::ofstream ofs(path, std::ios::out | std::ios::binary);
+		ofs << code;
+	};
+	const auto &load_and_call = [&] () {
+		UASSERT(ScriptApiSecurity::safeLoadFile(L, path.c_str()));
+		return lua_pcall(L, 0, 1, 0);
+	};
+
+	// second load is served from the cache
+	write_file("return 1 + 2");
+	for (int i = 0; i < 2; i++) {
+		UASSERTEQ(int, load_and_call(), 0);
+		UASSERTEQ(int, lua_tointeger(L, -1), 3);
+		lua_pop(L, 1);
+	}
+
+	// a changed file must not be
+	write_file("return 4 + 5");
+	UASSERTEQ(int, load_and_call(), 0);
+	UASSERTEQ(int, lua_tointeger(L, -1), 9);
+	lua_pop(L, 1);
+
+	// chunk name and line info survive
+	write_file("local x = 1\n\nerror('boom')");
+	for (int i = 0; i < 2; i++) {
+		UASSERT(load_and_call() != 0);
+		std::string msg = readParam<std::string>(L, -1);
+		UASSERT(msg.find(":3: boom") != std::string::npos);
+		lua_pop(L, 1);
+	}
+}
@@ -6,6 +6,7 @@
 
 #include "gamedef.h"
 #include "voxelalgorithms.h"
+#include "util/directiontables.h"
 #include "util/numeric.h"
 #include "dummymap.h"
 #include "nodedef.h"
@@ -19,6 +20,7 @@ class TestVoxelAlgorithms : public TestBase {
 
 	void testVoxelLineIterator();
 	void testLighting(IGameDef *gamedef);
+	void testMapgenLighting(IGameDef *gamedef);
 };
 
 static TestVoxelAlgorithms g_test_instance;
@@ -27,6 +29,7 @@ void TestVoxelAlgorithms::runTests(IGameDef *gamedef)
 {
 	TEST(testVoxelLineIterator);
 	TEST(testLighting, gamedef);
+	TEST(testMapgenLighting, gamedef);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -153,3 +156,101 @@ void TestVoxelAlgorithms::testLighting(IGameDef *gamedef)
 		UASSERTEQ(int, n.getParam1(), 153);
 	}
 }
+
+void TestVoxelAlgorithms::testMapgenLighting(IGameDef *gamedef)
+{
+	const NodeDefManager *ndef = gamedef->ndef();
+	const VoxelArea a(v3s16(-8), v3s16(8));
+
+	for (bool block_is_underground : {false, true}) {
+		VoxelManipulator vm;
+		vm.addArea(VoxelArea(v3s16(-9), v3s16(9)));
+		const VoxelArea &va = vm.m_area;
+		for (u32 i = 0; i < va.getVolume(); i++)
+			vm.m_data[i] = MapNode(CONTENT_AIR, 0);
+
+		// Open sky above one half, unknown above the other
+		for (s16 z = -9; z <= 9; z++)
+		for (s16 x = -9; x <= 9; x++)
+			vm.setNode(v3s16(x, 9, z), x < 0 ? MapNode(CONTENT_AIR, LIGHT_SUN) :
+				MapNode(CONTENT_IGNORE));
+		// A roof with a hole, a closed room with a torch, and some water
+		for (s16 z = -8; z <= 8; z++)
+		for (s16 x = -8; x <= 8; x++)
+			vm.setNode(v3s16(x, 4, z), MapNode(t_CONTENT_STONE));
+		vm.setNode(v3s16(-3, 4, 2), MapNode(CONTENT_AIR));
+		for (s16 z = -8; z <= -2; z++)
+		for (s16 y = -8; y <= -2; y++)
+		for (s16 x = -8; x <= -2; x++) {
+			bool wall = z == -8 || z == -2 || y == -8 || y == -2 || x == -8 || x == -2;
+			vm.setNode(v3s16(x, y, z), MapNode(wall ? t_CONTENT_STONE : CONTENT_AIR));
+		}
+		vm.setNode(v3s16(-5, -5, -5), MapNode(t_CONTENT_TORCH));
+		vm.setNode(v3s16(5, 0, 5), MapNode(t_CONTENT_WATER));
+		vm.setNode(v3s16(6, 0, 5), MapNode(t_CONTENT_TORCH));
+
+		// Expected result, computed the slow way
+		std::vector<u8> expected(va.getVolume());
+		for (u32 i = 0; i < va.getVolume(); i++)
+			expected[i] = vm.m_data[i].param1;
+		for (s16 z = a.MinEdge.Z; z <= a.MaxEdge.Z; z++)
+		for (s16 x = a.MinEdge.X; x <= a.MaxEdge.X; x++) {
+			// Unknown above means lit, unless the block is known to be underground
+			if (vm.getNodeRefUnsafe(v3s16(x, 9, z)).getContent() == CONTENT_IGNORE &&
+					block_is_underground)
+				continue;
+			for (s16 y = a.MaxEdge.Y; y >= a.MinEdge.Y; y--) {
+				MapNode n = vm.getNodeRefUnsafe(v3s16(x, y, z));
+				if (!ndef->getLightingFlags(n).sunlight_propagates)
+					break;
+				expected[va.index(x, y, z)] = LIGHT_SUN;
+			}
+		}
+		for (s16 z = a.MinEdge.Z; z <= a.MaxEdge.Z; z++)
+		for (s16 y = a.MinEdge.Y; y <= a.MaxEdge.Y; y++)
+		for (s16 x = a.MinEdge.X; x <= a.MaxEdge.X; x++) {
+			ContentLightingFlags f = ndef->getLightingFlags(vm.getNodeRefUnsafe(v3s16(x, y, z)));
+			if (f.light_propagates && f.light_source)
+				expected[va.index(x, y, z)] = f.light_source | (f.light_source << 4);
+		}
+		for (bool changed = true; changed;) {
+			changed = false;
+			for (s16 z = a.MinEdge.Z; z <= a.MaxEdge.Z; z++)
+			for (s16 y = a.MinEdge.Y; y <= a.MaxEdge.Y; y++)
+			for (s16 x = a.MinEdge.X; x <= a.MaxEdge.X; x++) {
+				const v3s16 p(x, y, z);
+				if (!ndef->getLightingFlags(vm.getNodeRefUnsafe(p)).light_propagates)
+					continue;
+				u8 &light = expected[va.index(p)];
+				for (const v3s16 &dir : g_6dirs) {
+					if (!a.contains(p + dir))
+						continue;
+					u8 other = expected[va.index(p + dir)];
+					u8 day = std::max(light & 0x0F, std::max(other & 0x0F, 1) - 1);
+					u8 night = std::max(light & 0xF0, std::max(other & 0xF0, 0x10) - 0x10);
+					if ((day | night) != light) {
+						light = day | night;
+						changed = true;
+					}
+				}
+			}
+		}
+
+		voxalgo::propagate_sunlight(&vm, ndef, a, block_is_underground, true);
+		voxalgo::spread_light(&vm, ndef, a);
+
+		for (s16 z = va.MinEdge.Z; z <= va.MaxEdge.Z; z++)
+		for (s16 y = va.MinEdge.Y; y <= va.MaxEdge.Y; y++)
+		for (s16 x = va.MinEdge.X; x <= va.MaxEdge.X; x++) {
+			const v3s16 p(x, y, z);
+			UASSERTEQ(int, vm.getNodeRefUnsafe(p).param1, expected[va.index(p)]);
+		}
+
+		// Sanity check of the setup
+		UASSERTEQ(int, vm.getNodeRefUnsafe(v3s16(-3, 0, 2)).param1, LIGHT_SUN);
+		UASSERTEQ(int, vm.getNodeRefUnsafe(v3s16(-4, 0, 2)).param1 & 0x0F, LIGHT_SUN - 1);
+		UASSERTEQ(int, vm.getNodeRefUnsafe(v3s16(-5, -4, -5)).param1 >> 4, 13 - 1);
+		UASSERTEQ(int, vm.getNodeRefUnsafe(v3s16(-3, -5, -5)).param1 & 0x0F, 0);
+		UASSERTEQ(int, vm.getNodeRefUnsafe(v3s16(-2, -5, -5)).param1, 0);
+	}
+}
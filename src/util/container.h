@@ -268,7 +268,7 @@ class LRUCache
 		m_queue.clear();
 	}
 
-	const V *lookupCache(K key)
+	V *lookupCache(K key)
 	{
 		typename cache_type::iterator it = m_map.find(key);
 		V *ret;
@@ -3,11 +3,13 @@
 // Copyright (C) 2010-2013 celeron55, Perttu Ahola <celeron55@gmail.com>
 
 #include <array>
+#include <queue>
 
 #include "voxelalgorithms.h"
 #include "nodedef.h"
 #include "mapblock.h"
 #include "map.h"
+#include "voxel.h"
 
 namespace voxalgo
 {
@@ -1240,6 +1242,145 @@ void repair_block_light(Map *map, MapBlock *block,
 		modified_blocks);
 }
 
+void propagate_sunlight(VoxelManipulator *vm, const NodeDefManager *ndef,
+	const VoxelArea &a, bool block_is_underground, bool propagate_shadow)
+{
+	if (a.hasEmptyExtent())
+		return;
+
+	const VoxelArea &va = vm->m_area;
+	const s32 width = a.getExtent().X;
+	// Which columns of the current row are still lit by the sun
+	std::vector<u8> lit(width);
+
+	// NOTE: Direct access to the low 4 bits of param1 is okay here because,
+	// by definition, sunlight will never be in the night lightbank.
+
+	// The data is contiguous along X, so walk down whole rows of columns
+	// at once instead of one column after the other.
+	for (s16 z = a.MinEdge.Z; z <= a.MaxEdge.Z; z++) {
+		// see if we can get a light value from the overtop
+		MapNode *above = &vm->m_data[va.index(a.MinEdge.X, a.MaxEdge.Y + 1, z)];
+		bool any_lit = false;
+		for (s32 x = 0; x < width; x++) {
+			if (above[x].getContent() == CONTENT_IGNORE)
+				lit[x] = !block_is_underground;
+			else
+				lit[x] = (above[x].param1 & 0x0F) == LIGHT_SUN || !propagate_shadow;
+			any_lit |= lit[x];
+		}
+
+		for (s16 y = a.MaxEdge.Y; y >= a.MinEdge.Y && any_lit; y--) {
+			MapNode *row = &vm->m_data[va.index(a.MinEdge.X, y, z)];
+			any_lit = false;
+			for (s32 x = 0; x < width; x++) {
+				if (!lit[x])
+					continue;
+				if (!ndef->getLightingFlags(row[x]).sunlight_propagates) {
+					lit[x] = 0;
+					continue;
+				}
+				row[x].param1 = LIGHT_SUN;
+				any_lit = true;
+			}
+		}
+	}
+}
+
+void spread_light(VoxelManipulator *vm, const NodeDefManager *ndef,
+	const VoxelArea &a)
+{
+	struct LightQueueItem {
+		v3s16 p;
+		u32 i; // index in vm
+		u8 light;
+	};
+	std::queue<LightQueueItem> queue;
+
+	MapNode *data = vm->m_data;
+	const v3s32 &em = vm->m_area.getExtent();
+	const s32 ystride = em.X;
+	const s32 zstride = em.X * em.Y;
+
+	// Spreads light to the node p, queues it if it got brighter.
+	// The given light value is diminished once.
+	auto spread_to = [&] (v3s16 p, u32 i, u8 light) {
+		MapNode &n = data[i];
+
+		// Decay light in each of the banks separately
+		u8 light_day = light & 0x0F;
+		if (light_day > 0)
+			light_day -= 0x01;
+
+		u8 light_night = light & 0xF0;
+		if (light_night > 0)
+			light_night -= 0x10;
+
+		// Bail out only if we have no more light from either bank to propogate, or
+		// we hit a solid block that light cannot pass through.
+		if ((light_day  <= (n.param1 & 0x0F) &&
+				light_night <= (n.param1 & 0xF0)) ||
+				!ndef->getLightingFlags(n).light_propagates)
+			return;
+
+		// MYMAX still needed here because we only exit early if both banks have
+		// nothing to propagate anymore.
+		light = MYMAX(light_day, n.param1 & 0x0F) |
+				MYMAX(light_night, n.param1 & 0xF0);
+
+		n.param1 = light;
+		queue.push({p, i, light});
+	};
+
+	// Neighbors are addressed by index offsets, only the coordinate along
+	// the direction of travel needs a bounds check.
+	// Same order as g_6dirs.
+	auto spread_from = [&] (v3s16 p, u32 i, u8 light) {
+		if (light <= 1)
+			return;
+		if (p.Z < a.MaxEdge.Z)
+			spread_to(v3s16(p.X, p.Y, p.Z + 1), i + zstride, light);
+		if (p.Y < a.MaxEdge.Y)
+			spread_to(v3s16(p.X, p.Y + 1, p.Z), i + ystride, light);
+		if (p.X < a.MaxEdge.X)
+			spread_to(v3s16(p.X + 1, p.Y, p.Z), i + 1, light);
+		if (p.Z > a.MinEdge.Z)
+			spread_to(v3s16(p.X, p.Y, p.Z - 1), i - zstride, light);
+		if (p.Y > a.MinEdge.Y)
+			spread_to(v3s16(p.X, p.Y - 1, p.Z), i - ystride, light);
+		if (p.X > a.MinEdge.X)
+			spread_to(v3s16(p.X - 1, p.Y, p.Z), i - 1, light);
+	};
+
+	for (s16 z = a.MinEdge.Z; z <= a.MaxEdge.Z; z++) {
+		for (s16 y = a.MinEdge.Y; y <= a.MaxEdge.Y; y++) {
+			u32 i = vm->m_area.index(a.MinEdge.X, y, z);
+			for (s16 x = a.MinEdge.X; x <= a.MaxEdge.X; x++, i++) {
+				MapNode &n = data[i];
+				if (n.getContent() == CONTENT_IGNORE)
+					continue;
+
+				ContentLightingFlags cf = ndef->getLightingFlags(n);
+				if (!cf.light_propagates)
+					continue;
+
+				u8 light_produced = cf.light_source;
+				if (light_produced)
+					n.param1 = light_produced | (light_produced << 4);
+
+				if (n.param1)
+					spread_from(v3s16(x, y, z), i, n.param1);
+			}
+		}
+	}
+
+	while (!queue.empty()) {
+		const LightQueueItem item = queue.front();
+		queue.pop();
+		spread_from(item.p, item.i, item.light);
+	}
+}
+
 VoxelLineIterator::VoxelLineIterator(const v3f &start_position, const v3f &line_vector) :
 	m_start_position(start_position),
 	m_line_vector(line_vector)
@@ -10,6 +10,9 @@
 class Map;
 class MapBlock;
 class MMVManip;
+class NodeDefManager;
+class VoxelArea;
+class VoxelManipulator;
 
 namespace voxalgo
 {
@@ -63,6 +66,27 @@ void blit_back_with_light(Map *map, MMVManip *vm,
 void repair_block_light(Map *map, MapBlock *block,
 	std::map<v3s16, MapBlock*> *modified_blocks);
 
+/*!
+ * Spreads sunlight downwards in the given area of a voxel manipulator.
+ * Used by the mapgens.
+ *
+ * \param a the area to operate on, the row of nodes above it
+ * is used as the light source and must be inside the manipulator
+ * \param block_is_underground whether columns below ignore stay dark
+ * \param propagate_shadow if false, sunlight is spread even below
+ * nodes that aren't sunlit
+ */
+void propagate_sunlight(VoxelManipulator *vm, const NodeDefManager *ndef,
+	const VoxelArea &a, bool block_is_underground, bool propagate_shadow);
+
+/*!
+ * Spreads light from light sources and already lit nodes
+ * in the given area of a voxel manipulator.
+ * Used by the mapgens.
+ */
+void spread_light(VoxelManipulator *vm, const NodeDefManager *ndef,
+	const VoxelArea &a);
+
 /*!
  * This class iterates trough voxels that intersect with
  * a line. The collision detection does not see nodeboxes,